@@ -3,10 +3,12 @@
 
 #include "lexer/Lexer.h"
 #include "lexer/Token.h"
+#include "lexer/SourceManager.h"
 
 #include "parser/Parser.h"
+#include "parser/ast/CallGraph.h"
 
-#include "type/Type.h"
+#include "context/CompilerContext.h"
 
 #include "diagnostic/Diagnostic.h"
 
@@ -16,43 +18,204 @@
 #include <vipir/Module.h>
 #include <vipir/ABI/SysV.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <deque>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <mutex>
 #include <sstream>
+#include <thread>
 
-int main(int argc, char** argv)
+struct Options
+{
+    std::vector<std::string> searchPaths;
+    bool outputIR = false;
+    bool optimize = false;
+    bool dumpCallGraph = false;
+    bool wholeProgram = false;
+    bool remarks = false;
+};
+
+// One output file, built from one input or from all of them with --whole-program
+struct Job
+{
+    std::vector<std::string> inputFilePaths;
+    std::string outputFilePath;
+};
+
+// vipir keeps its types in process-wide tables and makes no promise that
+// building or emitting IR is thread-safe, so only one job at a time can be
+// inside vipir. Lexing, parsing, type checking, folding and the call graph
+// run in parallel, and so does writing the output
+static std::mutex emitMutex;
+static std::mutex stdoutMutex;
+
+static void Compile(const Options& options, const Job& job)
 {
+    // Each job has its own context, sources and imports, so nothing a job
+    // declares is visible to any other
+    CompilerContext context;
+
     diagnostic::Diagnostics diag;
     diag.setErrorSender("viper");
+    diag.setRemarks(options.remarks);
 
-    std::string inputFilePath;
-    std::string outputFilePath;
-    bool outputIR = false;
-    bool optimize = false;
+    lexing::SourceManager sourceManager;
+    symbol::ImportManager importManager(sourceManager, context);
+    for (auto& searchPath : options.searchPaths)
+    {
+        importManager.addSearchPath(searchPath);
+    }
+
+    // Every input keeps its own diagnostics, so that errors found after
+    // parsing still point into the right file. A deque so they don't move
+    struct Unit
+    {
+        diagnostic::Diagnostics diag;
+        std::vector<parser::ASTNodePtr> ast;
+    };
+    std::deque<Unit> units;
+
+    for (auto& inputFilePath : job.inputFilePaths)
+    {
+        auto text = sourceManager.load(inputFilePath);
+        if (!text)
+        {
+            diag.fatalError(std::format("{}: could not read file", inputFilePath));
+        }
+
+        Unit& unit = units.emplace_back(diag);
+        unit.diag.setFileName(inputFilePath);
+        unit.diag.setText(*text);
+
+        lexing::Lexer lexer(*text, unit.diag);
+        parser::Parser parser(lexer, unit.diag, importManager, context);
+        unit.ast = parser.parse();
+    }
+
+    // Each pass runs over every input before the next starts, so folding
+    // and inlining can see bodies from the other files
+    for (auto& unit : units)
+    {
+        for (auto& node : unit.ast)
+        {
+            node->typeCheck(nullptr, context, unit.diag);
+        }
+    }
+
+    for (auto& unit : units)
+    {
+        for (auto& node : unit.ast)
+        {
+            parser::ASTNode::Fold(node, context, unit.diag);
+        }
+    }
+
+    parser::CallGraph callGraph(options.wholeProgram);
+    for (auto& unit : units)
+    {
+        callGraph.add(unit.ast);
+    }
+    callGraph.removeUnreachable();
+
+    if (options.dumpCallGraph)
+    {
+        std::ostringstream dump;
+        callGraph.print(dump);
+
+        std::lock_guard<std::mutex> lock(stdoutMutex);
+        std::cout << dump.str();
+    }
+
+    std::ostringstream output;
+    {
+        std::lock_guard<std::mutex> lock(emitMutex);
+
+        vipir::IRBuilder builder;
+        vipir::Module module(job.inputFilePaths.front());
+        module.setABI<vipir::abi::SysV>();
+
+        for (auto& unit : units)
+        {
+            for (auto& node : unit.ast)
+            {
+                node->emit(builder, module, nullptr, context, unit.diag);
+            }
+        }
+
+        if (options.optimize)
+        {
+            module.addPass(vipir::Pass::PeepholeOptimization);
+        }
+
+        if (options.outputIR)
+        {
+            module.print(output);
+        }
+        else
+        {
+            module.emit(output, vipir::OutputFormat::ELF);
+        }
+    }
+
+    // Only written once the job has succeeded, so a failed job leaves no half-written output
+    std::ofstream outputFile = std::ofstream(job.outputFilePath, std::ios::binary);
+    outputFile << output.str();
+}
+
+static int Run(int argc, char** argv)
+{
+    diagnostic::Diagnostics diag;
+    diag.setErrorSender("viper");
 
-    symbol::ImportManager importManager;
+    Options options;
+    std::vector<std::string> inputFilePaths;
+    std::string outputFilePath;
+    int jobCount = 1;
 
     for (int i = 1; i < argc; ++i)
     {
         std::string arg = argv[i];
-        if (arg.starts_with('-'))
+        if (arg == "--dump-call-graph")
+        {
+            options.dumpCallGraph = true;
+        }
+        else if (arg == "--whole-program")
+        {
+            options.wholeProgram = true;
+        }
+        else if (arg.starts_with('-'))
         {
             switch(arg[1])
             {
                 case 'I':
                     if (arg.length() == 2)
                     {
-                        importManager.addSearchPath(argv[++i]);
+                        options.searchPaths.push_back(argv[++i]);
                     }
                     else
                     {
-                        importManager.addSearchPath(arg.substr(2));
+                        options.searchPaths.push_back(arg.substr(2));
                     }
                     break;
 
                 case 'i':
-                    outputIR = true;
+                    options.outputIR = true;
+                    break;
+
+                case 'j':
+                    if (arg.length() == 2)
+                        jobCount = std::atoi(argv[++i]);
+                    else
+                        jobCount = std::atoi(arg.c_str() + 2);
+
+                    if (jobCount <= 0)
+                    {
+                        diag.fatalError(std::format("Invalid job count: {}", arg));
+                    }
                     break;
 
                 case 'o':
@@ -63,7 +226,11 @@ int main(int argc, char** argv)
                     break;
 
                 case 'O':
-                    optimize = true;
+                    options.optimize = true;
+                    break;
+
+                case 'r':
+                    options.remarks = true;
                     break;
 
                 default:
@@ -72,69 +239,94 @@ int main(int argc, char** argv)
         }
         else
         {
-            inputFilePath = arg;
+            inputFilePaths.push_back(arg);
         }
     }
 
-    if (inputFilePath.empty())
+    if (inputFilePaths.empty())
     {
         diag.fatalError("no input files");
     }
-    if (!std::filesystem::exists(inputFilePath))
+    for (auto& inputFilePath : inputFilePaths)
     {
-        diag.fatalError(std::format("{}: no such file or directory", inputFilePath));
+        if (!std::filesystem::exists(inputFilePath))
+        {
+            diag.fatalError(std::format("{}: no such file or directory", inputFilePath));
+        }
     }
-    diag.setFileName(inputFilePath);
 
-    if (outputFilePath.empty())
+    // Without --whole-program every input is compiled on its own into an
+    // output named after it
+    std::vector<Job> jobs;
+    if (options.wholeProgram || inputFilePaths.size() == 1)
     {
-        outputFilePath = inputFilePath + (outputIR ? ".i" : ".o");
+        jobs.push_back({inputFilePaths, outputFilePath});
+    }
+    else
+    {
+        if (!outputFilePath.empty())
+        {
+            diag.fatalError("-o can't be used with multiple input files without --whole-program");
+        }
+        for (auto& inputFilePath : inputFilePaths)
+        {
+            jobs.push_back({{inputFilePath}, ""});
+        }
     }
 
-    std::ifstream file = std::ifstream(inputFilePath);
-
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-
-    Type::Init();
-
-    diag.setText(buffer.str());
-    lexing::Lexer lexer(buffer.str(), diag);
-
-    std::vector<lexing::Token> tokens = lexer.lex();
-
-    parser::Parser parser(tokens, diag, importManager);
-    
-    vipir::IRBuilder builder;
-    vipir::Module module(inputFilePath);
-    module.setABI<vipir::abi::SysV>();
-
-    auto ast = parser.parse();
-
-    for (auto& node : ast)
+    for (auto& job : jobs)
     {
-        node->typeCheck(nullptr, diag);
+        if (job.outputFilePath.empty())
+        {
+            job.outputFilePath = job.inputFilePaths.front() + (options.outputIR ? ".i" : ".o");
+        }
     }
-    
-    for (auto& node : ast)
+
+    // Workers take the next job until there are none left. A compile error
+    // only fails its own job: the rest still run, so every input gets its
+    // diagnostics, and every worker is joined before we exit
+    std::atomic<std::size_t> nextJob = 0;
+    std::atomic<bool> failed = false;
+    auto worker = [&]() {
+        for (std::size_t i = nextJob++; i < jobs.size(); i = nextJob++)
+        {
+            try
+            {
+                Compile(options, jobs[i]);
+            }
+            catch (const diagnostic::CompileError&)
+            {
+                // Don't leave the output of an earlier build behind to be linked
+                std::error_code error;
+                std::filesystem::remove(jobs[i].outputFilePath, error);
+                failed = true;
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (std::size_t i = 1; i < std::min<std::size_t>(jobCount, jobs.size()); ++i)
     {
-        node->emit(builder, module, nullptr, diag);
+        workers.emplace_back(worker);
     }
+    worker();
 
-    if (optimize)
+    for (auto& thread : workers)
     {
-        module.addPass(vipir::Pass::PeepholeOptimization);
+        thread.join();
     }
-    
-    std::ofstream outputFile = std::ofstream(outputFilePath);
-    if (outputIR)
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+int main(int argc, char** argv)
+{
+    try
     {
-        module.print(outputFile);
+        return Run(argc, argv);
     }
-    else
+    catch (const diagnostic::CompileError&)
     {
-        module.emit(outputFile, vipir::OutputFormat::ELF);
+        return EXIT_FAILURE;
     }
-
-    return 0;
 }
\ No newline at end of file
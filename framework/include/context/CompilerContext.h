@@ -0,0 +1,92 @@
+// Copyright 2024 solar-mist
+
+#ifndef VIPER_FRAMEWORK_CONTEXT_COMPILER_CONTEXT_H
+#define VIPER_FRAMEWORK_CONTEXT_COMPILER_CONTEXT_H 1
+
+#include "parser/ast/Arena.h"
+
+#include "symbol/Scope.h"
+
+#include "type/ArrayType.h"
+#include "type/FunctionType.h"
+#include "type/PointerType.h"
+#include "type/StructType.h"
+#include "type/Type.h"
+
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// Everything one compilation registers as it goes: its AST nodes, its types,
+// the global symbols it declares and the names they can be looked up by. The parser,
+// the type lookups and every pass are handed the context to work in, so
+// compilations with a context each can run side by side on different
+// threads, or one after another, without seeing each other's declarations
+struct CompilerContext
+{
+    CompilerContext(); // with the builtin types already registered
+    CompilerContext(const CompilerContext&) = delete;
+    CompilerContext& operator=(const CompilerContext&) = delete;
+
+    // Every node parsed, folded or inlined in this compilation is created in
+    // here. Declared first so it is destroyed last, after anything else
+    // that may still hold nodes
+    parser::Arena astArena;
+
+    struct ArrayTypeKeyHash
+    {
+        std::size_t operator()(const std::pair<Type*, int>& key) const
+        {
+            return std::hash<Type*>{}(key.first) * 31 + std::hash<int>{}(key.second);
+        }
+    };
+
+    // Signatures are keyed as the return type followed by the argument types
+    struct SignatureHash
+    {
+        std::size_t operator()(const std::vector<Type*>& signature) const
+        {
+            std::size_t hash = signature.size();
+            for (Type* type : signature)
+            {
+                hash = hash * 31 + std::hash<Type*>{}(type);
+            }
+            return hash;
+        }
+    };
+
+    // Symbols are never erased, so the AST can hold pointers to them once they're resolved
+    std::unordered_map<std::string, FunctionSymbol> functions;
+    std::unordered_map<std::string, GlobalSymbol> globals;
+
+    // Qualified names are keyed by their parts joined with "::", which can't
+    // appear inside an identifier, so two names share a key only if they are
+    // the same sequence of parts. Each key maps to its mangled symbols in the
+    // order they were added
+    std::unordered_map<std::string, std::vector<std::string>, TypeNameHash, std::equal_to<>> identifiers;
+    std::unordered_set<std::string> mangledNames;
+
+    std::set<std::vector<std::string> > namespacePaths; // interned, so scopes can share them
+
+    // Builtins and enums by name, and the aliases that using declarations add
+    std::unordered_map<std::string, std::unique_ptr<Type>, TypeNameHash, std::equal_to<>> types;
+    std::unordered_map<std::string, Type*, TypeNameHash, std::equal_to<>> aliases;
+
+    Type* integerTypes[2][4]; // [isSigned][log2(bits / 8)]
+    Type* voidType;
+    Type* booleanType;
+
+    // Derived types are keyed by what they're built from, so each exists
+    // once and can be compared by address. Struct types are keyed by
+    // mangle ID, which is also how they are found from their names
+    std::unordered_map<Type*, std::unique_ptr<PointerType> > pointerTypes;
+    std::unordered_map<std::pair<Type*, int>, std::unique_ptr<ArrayType>, ArrayTypeKeyHash> arrayTypes;
+    std::unordered_map<std::vector<Type*>, std::unique_ptr<FunctionType>, SignatureHash> functionTypes;
+    std::unordered_map<std::string, std::unique_ptr<StructType>, TypeNameHash, std::equal_to<>> structTypes;
+};
+
+#endif // VIPER_FRAMEWORK_CONTEXT_COMPILER_CONTEXT_H
@@ -3,11 +3,16 @@
 #ifndef VIPER_FRAMEWORK_DIAGNOSTIC_DIAGNOSTIC_H
 #define VIPER_FRAMEWORK_DIAGNOSTIC_DIAGNOSTIC_H 1
 
+#include "lexer/LineTable.h"
+
+#include <exception>
+#include <optional>
 #include <string>
+#include <string_view>
 
 namespace lexing
 {
-    class SourceLocation;
+    struct SourceLocation;
 }
 
 namespace fmt
@@ -20,26 +25,41 @@ namespace fmt
 
 namespace diagnostic
 {
+    // Thrown once a fatal error has been printed. The caller decides how to
+    // stop, so one failing job doesn't take down the others mid-write
+    class CompileError : public std::exception
+    {
+    public:
+        const char* what() const noexcept override { return "compilation failed"; }
+    };
+
     class Diagnostics
     {
     public:
         void setImported(bool imported);
         void setFileName(std::string fileName);
         void setErrorSender(std::string sender);
-        void setText(std::string text);
+        void setText(std::string_view text); // not copied, must outlive the Diagnostics
+        void setRemarks(bool remarks);
 
         [[noreturn]] void fatalError(std::string_view message);
 
         [[noreturn]] void compilerError(lexing::SourceLocation start, lexing::SourceLocation end, std::string_view message);
         void compilerWarning(lexing::SourceLocation start, lexing::SourceLocation end, std::string_view message);
 
+        // Notes on what the compiler decided to do with a piece of code, only printed when remarks are enabled
+        bool remarksEnabled() const;
+        void compilerRemark(lexing::SourceLocation start, std::string_view message);
+
     private:
         std::string mFileName;
         std::string mSender;
-        std::string mText;
+        std::string_view mText;
+        std::optional<lexing::LineTable> mLineTable; // only built once something is reported
         bool mImported{ false };
+        bool mRemarks{ false };
 
-        int getLinePosition(int lineNumber);
+        const lexing::LineTable& getLineTable();
     };
 }
 
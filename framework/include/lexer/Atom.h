@@ -0,0 +1,20 @@
+// Copyright 2024 solar-mist
+
+#ifndef VIPER_FRAMEWORK_LEXER_ATOM_H
+#define VIPER_FRAMEWORK_LEXER_ATOM_H 1
+
+#include <cstdint>
+#include <string_view>
+
+namespace lexing
+{
+    // Interned identifier. Two identifiers with the same spelling always
+    // share an atom, so comparing them is an integer compare
+    using Atom = std::uint32_t;
+    constexpr Atom NoAtom = 0;
+
+    Atom Intern(std::string_view text);
+    std::string_view GetAtomText(Atom atom);
+}
+
+#endif // VIPER_FRAMEWORK_LEXER_ATOM_H
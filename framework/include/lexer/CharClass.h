@@ -0,0 +1,56 @@
+// Copyright 2024 solar-mist
+
+#ifndef VIPER_FRAMEWORK_LEXER_CHAR_CLASS_H
+#define VIPER_FRAMEWORK_LEXER_CHAR_CLASS_H 1
+
+#include <array>
+#include <cstdint>
+
+namespace lexing
+{
+    // Character classification for the lexer. Unlike <cctype> this ignores
+    // the locale and is a single table load per character
+    namespace CharClass
+    {
+        enum : std::uint8_t
+        {
+            IdentifierStart = 1 << 0, // [A-Za-z_]
+            IdentifierPart  = 1 << 1, // [A-Za-z0-9_]
+            Digit           = 1 << 2,
+            HexDigit        = 1 << 3,
+            Space           = 1 << 4,
+            Upper           = 1 << 5,
+        };
+
+        constexpr std::array<std::uint8_t, 256> BuildTable()
+        {
+            std::array<std::uint8_t, 256> table{};
+            for (int c = 'a'; c <= 'z'; ++c)
+                table[c] |= IdentifierStart | IdentifierPart;
+            for (int c = 'A'; c <= 'Z'; ++c)
+                table[c] |= IdentifierStart | IdentifierPart | Upper;
+            table['_'] |= IdentifierStart | IdentifierPart;
+
+            for (int c = '0'; c <= '9'; ++c)
+                table[c] |= IdentifierPart | Digit | HexDigit;
+            for (int c = 'a'; c <= 'f'; ++c)
+                table[c] |= HexDigit;
+            for (int c = 'A'; c <= 'F'; ++c)
+                table[c] |= HexDigit;
+
+            for (char c : { ' ', '\t', '\n', '\v', '\f', '\r' })
+                table[static_cast<unsigned char>(c)] |= Space;
+
+            return table;
+        }
+
+        inline constexpr std::array<std::uint8_t, 256> Table = BuildTable();
+
+        constexpr bool Is(char c, std::uint8_t classes)
+        {
+            return Table[static_cast<unsigned char>(c)] & classes;
+        }
+    }
+}
+
+#endif // VIPER_FRAMEWORK_LEXER_CHAR_CLASS_H
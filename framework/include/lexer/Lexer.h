@@ -5,27 +5,34 @@
 
 #include "diagnostic/Diagnostic.h"
 
+#include <cstdint>
 #include <optional>
-#include <string>
-#include <vector>
+#include <string_view>
 
 namespace lexing
 {
     class Token;
-    class SourceLocation;
+    struct SourceLocation;
+    enum class TokenType : std::uint8_t;
 
     class Lexer
     {
     public:
-        Lexer(const std::string& text, diagnostic::Diagnostics& diag);
+        // text must end in a newline and outlive every token lexed from it,
+        // since tokens refer back into it rather than copying
+        Lexer(std::string_view text, diagnostic::Diagnostics& diag);
 
-        std::vector<Token> lex();
+        // Lexes one more token, returning EndOfFile once the text runs out
+        Token next();
+
+        // Carries on lexing from position, which must be the start of a token
+        void seek(std::uint32_t position);
+
+        std::string_view getText() const;
     private:
-        std::string mText;
+        std::string_view mText;
         diagnostic::Diagnostics& mDiag;
-        int mPosition{ 0 };
-        int mColumn{ 1 };
-        int mLine{ 1 };
+        std::uint32_t mPosition{ 0 };
 
         char current();
         char consume();
@@ -34,6 +41,8 @@ namespace lexing
         SourceLocation location();
 
         std::optional<Token> nextToken();
+        std::string_view textFrom(SourceLocation start);
+        Token token(TokenType tokenType, SourceLocation start);
 
         static inline bool isDigitSep(const char c) { return c == '_'; }
     };
@@ -0,0 +1,32 @@
+// Copyright 2024 solar-mist
+
+#ifndef VIPER_FRAMEWORK_LEXER_LINE_TABLE_H
+#define VIPER_FRAMEWORK_LEXER_LINE_TABLE_H 1
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace lexing
+{
+    // Offsets of the start of every line in a file, so a byte offset can be
+    // turned into a line and column with a binary search. Lines and columns
+    // both start at 1
+    class LineTable
+    {
+    public:
+        explicit LineTable(std::string_view text);
+
+        int getLine(std::uint32_t position) const;
+        int getColumn(std::uint32_t position) const;
+
+        std::uint32_t getLineStart(int line) const;
+        std::uint32_t getLineEnd(int line) const; // offset of the line's '\n'
+
+    private:
+        std::vector<std::uint32_t> mLineStarts;
+        std::uint32_t mSize;
+    };
+}
+
+#endif // VIPER_FRAMEWORK_LEXER_LINE_TABLE_H
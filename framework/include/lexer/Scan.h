@@ -0,0 +1,42 @@
+// Copyright 2024 solar-mist
+
+#ifndef VIPER_FRAMEWORK_LEXER_SCAN_H
+#define VIPER_FRAMEWORK_LEXER_SCAN_H 1
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+namespace lexing
+{
+    // Run scanners for the lexer's hot loops. Each returns the offset of the
+    // first byte at or after position that is not part of the run (or that
+    // matches, for FindByte), or text.size() if there isn't one.
+    // The implementation is picked on first use: AVX2 or SSE2 where the CPU
+    // has them, plain loops otherwise
+    std::size_t SkipWhitespace(std::string_view text, std::size_t position);
+    std::size_t SkipIdentifier(std::string_view text, std::size_t position);
+    std::size_t SkipDigits(std::string_view text, std::size_t position);
+    std::size_t SkipHexDigits(std::string_view text, std::size_t position);
+    std::size_t FindByte(std::string_view text, std::size_t position, char c);
+
+    using SkipFn = std::size_t(*)(std::string_view, std::size_t);
+    using FindFn = std::size_t(*)(std::string_view, std::size_t, char);
+
+    struct ScanKernels
+    {
+        const char* name;
+        SkipFn skipWhitespace;
+        SkipFn skipIdentifier;
+        SkipFn skipDigits;
+        SkipFn skipHexDigits;
+        FindFn findByte;
+    };
+
+    // Every implementation the CPU can run, from plain loops to the widest
+    // vectors. The functions above use the last one. Exposed so they can be
+    // checked against each other
+    std::vector<ScanKernels> GetAvailableKernels();
+}
+
+#endif // VIPER_FRAMEWORK_LEXER_SCAN_H
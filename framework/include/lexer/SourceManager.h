@@ -0,0 +1,40 @@
+// Copyright 2024 solar-mist
+
+#ifndef VIPER_FRAMEWORK_LEXER_SOURCE_MANAGER_H
+#define VIPER_FRAMEWORK_LEXER_SOURCE_MANAGER_H 1
+
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace lexing
+{
+    // Owns every source file read during a compilation. Files are mapped
+    // read-only and never copied; the text handed out is shared by the lexer,
+    // tokens and diagnostics and stays valid until the manager is destroyed
+    class SourceManager
+    {
+    public:
+        SourceManager() = default;
+        SourceManager(const SourceManager&) = delete;
+        SourceManager& operator=(const SourceManager&) = delete;
+        ~SourceManager();
+
+        // Returns the file's text followed by a '\n' sentinel (which the lexer
+        // relies on), or std::nullopt if the file couldn't be opened
+        std::optional<std::string_view> load(const std::filesystem::path& path);
+
+    private:
+        struct Source
+        {
+            char* data;
+            std::size_t mappedSize;
+        };
+
+        std::vector<Source> mSources;
+    };
+}
+
+#endif // VIPER_FRAMEWORK_LEXER_SOURCE_MANAGER_H
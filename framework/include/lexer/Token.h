@@ -3,11 +3,15 @@
 #ifndef VIPER_FRAMEWORK_LEXER_TOKEN_H
 #define VIPER_FRAMEWORK_LEXER_TOKEN_H
 
+#include "lexer/Atom.h"
+
+#include <cstdint>
 #include <string>
+#include <string_view>
 
 namespace lexing
 {
-    enum class TokenType : int
+    enum class TokenType : std::uint8_t
     {
         Error,
 
@@ -55,41 +59,45 @@ namespace lexing
         UsingKeyword,
         SizeofKeyword,
         EnumKeyword,
+
+        EndOfFile,
     };
 
+    // Byte offset into the source text. Line and column are only worked out
+    // from a LineTable when something actually needs them
     struct SourceLocation
     {
-        int column;
-        int line;
-
-        int position; // actual position into the text
+        std::uint32_t position;
     };
 
     class Token
     {
     public:
         Token() = default;
-        Token(const TokenType tokenType, std::string text, SourceLocation start, SourceLocation end);
-        Token(const TokenType tokenType, SourceLocation start, SourceLocation end);
+        Token(const TokenType tokenType, std::string_view text, std::uint32_t offset, Atom atom = NoAtom);
+        Token(const TokenType tokenType); // synthetic, not from any source text
 
         TokenType getTokenType() const;
         std::string getId() const;
-        const std::string& getText() const;
+        std::string_view getText() const;
+        Atom getAtom() const;
 
-        SourceLocation getStart();
-        SourceLocation getEnd();
+        unsigned long long getIntegerValue() const;
+        std::string getStringValue() const;
+
+        SourceLocation getStart() const;
+        SourceLocation getEnd() const;
 
         std::string toString() const;
 
-        bool operator==(Token other);
+        bool operator==(const Token& other) const;
 
     private:
         TokenType mTokenType{ TokenType::Error };
 
-        std::string mText;
-
-        SourceLocation mStart;
-        SourceLocation mEnd;
+        std::string_view mText; // view into the source buffer, which must outlive the token
+        std::uint32_t mOffset{ 0 };
+        Atom mAtom{ NoAtom };
     };
 }
 
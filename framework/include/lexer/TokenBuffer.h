@@ -0,0 +1,56 @@
+// Copyright 2024 solar-mist
+
+#ifndef VIPER_FRAMEWORK_LEXER_TOKEN_BUFFER_H
+#define VIPER_FRAMEWORK_LEXER_TOKEN_BUFFER_H 1
+
+#include "lexer/Token.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace lexing
+{
+    class Lexer;
+
+    // Window of tokens around the parser's current position, pulled from the
+    // lexer as they are needed. Only the tokens that peek() can reach are kept,
+    // plus anything after an active mark() so the parser can rewind to it
+    class TokenBuffer
+    {
+    public:
+        // Largest offsets the parsers pass to peek()
+        static constexpr int Lookahead = 1;
+        static constexpr int Lookbehind = 1;
+
+        TokenBuffer(Lexer& lexer);
+
+        const Token& peek(int offset);
+        Token consume(); // never moves past the EndOfFile token
+
+        void insert(const Token& token); // token becomes the current one
+
+        void mark();
+        void rewind(); // back to the most recent mark, which is released
+        void unmark();
+
+        // Drops everything held and restarts the stream at a source offset
+        void seek(std::uint32_t offset);
+
+    private:
+        Lexer& mLexer;
+
+        std::vector<Token> mRing; // size is always a power of two
+        std::size_t mFirst;       // index in the token stream of the oldest token held
+        std::size_t mCount;
+        std::size_t mPosition;    // index in the token stream of the current token
+
+        std::vector<std::size_t> mMarks;
+
+        Token& at(std::size_t index);
+        void fill(std::size_t index);
+        void makeRoom();
+    };
+}
+
+#endif // VIPER_FRAMEWORK_LEXER_TOKEN_BUFFER_H
@@ -13,6 +13,8 @@
 #include "parser/ast/statement/ConstexprStatement.h"
 
 #include "lexer/Token.h"
+#include "lexer/TokenBuffer.h"
+#include "lexer/Lexer.h"
 
 #include "symbol/Import.h"
 
@@ -27,17 +29,17 @@ namespace parser
     class ImportParser
     {
     public:
-        ImportParser(std::vector<lexing::Token>& tokens, diagnostic::Diagnostics& diag, symbol::ImportManager& importManager, bool hoistingParser = false);
+        ImportParser(lexing::Lexer& lexer, diagnostic::Diagnostics& diag, symbol::ImportManager& importManager, CompilerContext& context);
 
         std::vector<ASTNodePtr> parse();
 
         std::vector<GlobalSymbol> getSymbols();
 
     private:
-        std::vector<lexing::Token>& mTokens;
-        int mPosition;
+        lexing::TokenBuffer mTokens;
 
         symbol::ImportManager& mImportManager;
+        CompilerContext& mContext;
 
         Scope* mScope;
         std::vector<GlobalSymbol> mSymbols;
@@ -47,11 +49,9 @@ namespace parser
 
         std::vector<std::string> mNamespaces;
 
-        bool mHoistingParser;
-
-        lexing::Token current() const;
+        lexing::Token current();
         lexing::Token consume();
-        lexing::Token peek(int offset) const;
+        lexing::Token peek(int offset);
 
         void expectToken(lexing::TokenType tokenType);
         void expectEitherToken(std::vector<lexing::TokenType> tokenTypes);
@@ -61,7 +61,7 @@ namespace parser
         ASTNodePtr parseGlobal(std::vector<ASTNodePtr>& nodes);
         FunctionPtr parseFunction(bool exported, std::vector<GlobalAttribute> attributes);
         NamespacePtr parseNamespace();
-        StructDeclarationPtr parseStructDeclaration(bool exported);
+        StructDeclarationPtr parseStructDeclaration(bool exported, std::vector<GlobalAttribute> attributes);
         GlobalDeclarationPtr parseGlobalDeclaration(bool exported);
         ConstexprStatementPtr parseConstExpr(bool exported);
         std::pair<std::vector<ASTNodePtr>, std::vector<GlobalSymbol>> parseImportStatement(bool exported);
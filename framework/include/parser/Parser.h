@@ -30,11 +30,16 @@
 #include "parser/ast/expression/SizeofExpression.h"
 
 #include "lexer/Token.h"
+#include "lexer/TokenBuffer.h"
+#include "lexer/Lexer.h"
 
 #include "symbol/Import.h"
+#include "symbol/SymbolTable.h"
 
 #include "diagnostic/Diagnostic.h"
 
+#include <cstdint>
+#include <unordered_map>
 #include <vector>
 
 namespace parser
@@ -48,26 +53,53 @@ namespace parser
     class Parser
     {
     public:
-        Parser(std::vector<lexing::Token>& tokens, diagnostic::Diagnostics& diag, symbol::ImportManager& importManager);
+        Parser(lexing::Lexer& lexer, diagnostic::Diagnostics& diag, symbol::ImportManager& importManager, CompilerContext& context);
 
         std::vector<ASTNodePtr> parse();
 
     private:
-        std::vector<lexing::Token>& mTokens;
-        int mPosition;
+        // A function or method body, or a global's initializer, skipped on
+        // the first walk through the file and parsed once every global in it
+        // has been declared
+        struct DeferredBody
+        {
+            std::uint32_t offset;
+            bool expressionBodied;
+            Type* type; // what an expression body or initializer is parsed as: the return type, or the global's type
+            Scope* scope;
+            std::vector<std::string> namespaces;
+            std::vector<ASTNodePtr>* body;
+            std::vector<std::pair<std::string, LocalSymbol*> > parameters; // declared again when the body is parsed
+            ASTNodePtr* initializer = nullptr; // set instead of body for a global or constexpr initializer
+        };
+
+        // A struct named before its definition
+        struct ForwardStruct
+        {
+            StructType* type;
+            lexing::Token token;
+        };
+
+        lexing::TokenBuffer mTokens;
 
         symbol::ImportManager& mImportManager;
+        CompilerContext& mContext;
 
         Scope* mScope;
-        std::vector<GlobalSymbol> mSymbols;
+        symbol::SymbolTable mLocals;
+        std::unordered_map<std::string, GlobalSymbol> mSymbols; // the first declaration of a name wins
 
         diagnostic::Diagnostics& mDiag;
 
         std::vector<std::string> mNamespaces;
 
-        lexing::Token current() const;
+        std::vector<ASTNodePtr> mDeclarations; // emitted ahead of the rest of the file
+        std::vector<DeferredBody> mDeferredBodies;
+        std::vector<ForwardStruct> mForwardStructs;
+
+        lexing::Token current();
         lexing::Token consume();
-        lexing::Token peek(int offset) const;
+        lexing::Token peek(int offset);
 
         void expectToken(lexing::TokenType tokenType);
         void expectEitherToken(std::vector<lexing::TokenType> tokenTypes);
@@ -78,14 +110,17 @@ namespace parser
 
         Type* parseType(bool failable = false);
 
-        ASTNodePtr parseGlobal(std::vector<ASTNodePtr>& nodes);
+        std::uint32_t skipBody(bool expressionBodied);
+        void parseBody(DeferredBody& deferred);
+
+        ASTNodePtr parseGlobal();
         ASTNodePtr parseExpression(Type* preferredType = nullptr, int precedence = 1);
         ASTNodePtr parsePrimary(Type* preferredType = nullptr);
         ASTNodePtr parseParenthesizedExpression(Type* preferredType = nullptr);
 
-        FunctionPtr parseFunction(std::vector<GlobalAttribute> attributes);
+        FunctionPtr parseFunction(bool exported, std::vector<GlobalAttribute> attributes);
         NamespacePtr parseNamespace();
-        StructDeclarationPtr parseStructDeclaration();
+        StructDeclarationPtr parseStructDeclaration(bool exported, std::vector<GlobalAttribute> attributes);
         GlobalDeclarationPtr parseGlobalDeclaration();
         std::pair<std::vector<ASTNodePtr>, std::vector<GlobalSymbol>> parseImportStatement();
         UsingDeclarationPtr parseUsingDeclaration();
@@ -0,0 +1,49 @@
+// Copyright 2024 solar-mist
+
+#ifndef VIPER_FRAMEWORK_PARSER_AST_ARENA_H
+#define VIPER_FRAMEWORK_PARSER_AST_ARENA_H 1
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace parser
+{
+    // Bump allocator for the AST of one compilation. Every ASTNode is carved
+    // out of the arena it was created in, so a tree sits in a few large
+    // blocks and its memory goes away in one step when the arena is
+    // destroyed. Nodes still have their destructors run when their owning
+    // pointers are reset, but deleting one does not free anything; the arena
+    // must outlive every node created in it
+    class Arena
+    {
+    public:
+        Arena();
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+
+        void* allocate(std::size_t size);
+
+        template <class T, class... Args>
+        std::unique_ptr<T> create(Args&&... args)
+        {
+            return std::unique_ptr<T>(new(*this) T(std::forward<Args>(args)...));
+        }
+
+    private:
+        struct Block
+        {
+            std::unique_ptr<std::byte[]> data;
+            std::size_t size;
+        };
+
+        std::vector<Block> mBlocks;
+        std::byte* mCurrent;
+        std::byte* mEnd;
+
+        void newBlock(std::size_t minimumSize);
+    };
+}
+
+#endif // VIPER_FRAMEWORK_PARSER_AST_ARENA_H
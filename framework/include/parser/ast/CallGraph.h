@@ -0,0 +1,61 @@
+// Copyright 2024 solar-mist
+
+#ifndef VIPER_FRAMEWORK_PARSER_AST_CALL_GRAPH_H
+#define VIPER_FRAMEWORK_PARSER_AST_CALL_GRAPH_H 1
+
+#include "parser/ast/Node.h"
+
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+namespace parser
+{
+    // Which functions and methods refer to which, by calling them or by
+    // taking them as a function pointer. The roots are main, anything
+    // exported or [[NoMangle]], methods of exported structs and functions
+    // named in a global initializer. Everything else has to be reachable
+    // from a root to be worth emitting. When the whole program is being
+    // compiled nothing else can call an exported function, so exports
+    // aren't roots
+    class CallGraph
+    {
+    public:
+        CallGraph(bool wholeProgram = false);
+
+        // Adds one file's globals. ast must be type checked, and is best
+        // folded first so that calls in dead code and in constant
+        // initializers are already gone
+        void add(std::vector<ASTNodePtr>& ast);
+
+        // Clears FunctionSymbol::reachable for every function no root can
+        // reach, so neither its body nor its declaration is emitted. Every
+        // file has to be added first
+        void removeUnreachable();
+
+        // One line per function: its name, whether it's a root or
+        // unreachable, and what it refers to
+        void print(std::ostream& stream) const;
+
+    private:
+        struct Vertex
+        {
+            std::vector<FunctionSymbol*> references;
+            bool root = false;
+            bool reachable = false;
+        };
+
+        bool mWholeProgram;
+
+        std::vector<FunctionSymbol*> mFunctions; // in the order they were found, for print
+        std::unordered_map<FunctionSymbol*, Vertex> mVertices;
+
+        Vertex& addFunction(FunctionSymbol* function);
+        void addGlobal(ASTNode* node);
+        void markReachable(FunctionSymbol* function);
+
+        static void CollectReferences(ASTNode* node, std::vector<FunctionSymbol*>& references);
+    };
+}
+
+#endif // VIPER_FRAMEWORK_PARSER_AST_CALL_GRAPH_H
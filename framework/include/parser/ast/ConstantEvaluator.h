@@ -0,0 +1,82 @@
+// Copyright 2024 solar-mist
+
+#ifndef VIPER_FRAMEWORK_PARSER_AST_CONSTANT_EVALUATOR_H
+#define VIPER_FRAMEWORK_PARSER_AST_CONSTANT_EVALUATOR_H 1
+
+#include "parser/ast/Node.h"
+
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+namespace parser
+{
+    // Runs side-effect-free code at compile time by walking the AST. Each
+    // node's evaluate() does its own part and goes back through the
+    // evaluator for its children, so every node visited counts against the
+    // step budget. Anything the evaluator can't model, such as pointers,
+    // globals that aren't constexpr or functions without a body, makes
+    // evaluation fail and the code is left to be emitted as it was
+    class ConstantEvaluator
+    {
+    public:
+        // How control leaves the statement that was evaluated last
+        enum class Flow
+        {
+            Normal,
+            Break,
+            Continue,
+            Return,
+        };
+
+        static constexpr std::size_t StepBudget = 10'000'000;
+        static constexpr std::size_t MaxCallDepth = 256;
+
+        ConstantEvaluator(CompilerContext& context, diagnostic::Diagnostics& diag);
+
+        // Evaluates the initializer of a constexpr or global and returns a
+        // literal to replace it with, or nullptr if it's a literal already
+        // or can't be evaluated. Running out of steps or call depth is an
+        // error, reported at token
+        static ASTNodePtr EvaluateInitializer(ASTNode* node, const lexing::Token& token, CompilerContext& context, diagnostic::Diagnostics& diag);
+
+        CompilerContext& getContext();
+        diagnostic::Diagnostics& getDiagnostics();
+
+        // nullopt if node can't be evaluated
+        std::optional<ConstantValue> evaluate(ASTNode* node);
+
+        // The storage an lvalue refers to, or nullptr if it isn't one the
+        // evaluator can write to
+        ConstantValue* evaluateAddress(ASTNode* node);
+
+        // A call's locals live in a frame indexed by LocalSymbol::slot.
+        // Pushing fails once the call depth limit is reached
+        bool pushFrame(std::size_t size);
+        void popFrame();
+        ConstantValue* getLocal(LocalSymbol* symbol);
+
+        Flow getFlow() const;
+        void setFlow(Flow flow, ConstantValue returnValue = {});
+        ConstantValue takeReturnValue(); // and resumes normal flow
+
+        // Called by a loop after each run of its body. Whether the loop
+        // should stop, consuming a break or continue aimed at it
+        bool leaveLoop();
+
+    private:
+        CompilerContext& mContext;
+        diagnostic::Diagnostics& mDiag;
+
+        std::size_t mSteps;
+        bool mOutOfSteps;
+        bool mOutOfDepth;
+
+        std::vector<std::vector<ConstantValue>> mFrames;
+
+        Flow mFlow;
+        ConstantValue mReturnValue;
+    };
+}
+
+#endif // VIPER_FRAMEWORK_PARSER_AST_CONSTANT_EVALUATOR_H
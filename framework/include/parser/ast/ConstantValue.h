@@ -0,0 +1,38 @@
+// Copyright 2024 solar-mist
+
+#ifndef VIPER_FRAMEWORK_PARSER_AST_CONSTANT_VALUE_H
+#define VIPER_FRAMEWORK_PARSER_AST_CONSTANT_VALUE_H 1
+
+#include "type/Type.h"
+
+#include "lexer/Token.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace parser
+{
+    class ASTNode;
+
+    // A value worked out at compile time. Integers and bools are held in
+    // integer, already wrapped to their type, and arrays and structs hold
+    // one element per array element or struct field in declaration order.
+    // A value with no type is what a statement or a void call evaluates to
+    struct ConstantValue
+    {
+        Type* type = nullptr;
+        std::intmax_t integer = 0;
+        std::vector<ConstantValue> elements;
+
+        // The zero value of type, or nullopt if type has a part that can't
+        // be represented, such as a pointer
+        static std::optional<ConstantValue> Zero(Type* type);
+
+        // A literal or initializer that emits this value
+        std::unique_ptr<ASTNode> toNode(CompilerContext& context, const lexing::Token& token) const;
+    };
+}
+
+#endif // VIPER_FRAMEWORK_PARSER_AST_CONSTANT_VALUE_H
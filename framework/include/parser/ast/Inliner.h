@@ -0,0 +1,45 @@
+// Copyright 2024 solar-mist
+
+#ifndef VIPER_FRAMEWORK_PARSER_AST_INLINER_H
+#define VIPER_FRAMEWORK_PARSER_AST_INLINER_H 1
+
+#include "parser/ast/Node.h"
+
+#include "parser/ast/global/GlobalAttribute.h"
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace parser
+{
+    // Replaces calls to small functions and methods with a copy of the
+    // callee's body. This happens at emit time: the parameters get fresh
+    // allocas in the caller's entry block, the body is emitted there with
+    // its returns turned into a store and a branch past it (see
+    // Scope::returnTo), and the result is loaded back. The callee is still
+    // emitted on its own
+    class Inliner
+    {
+    public:
+        // Bodies of at most this many nodes are inlined unless marked [[NoInline]]
+        static constexpr std::size_t SizeLimit = 24;
+
+        // Whether a call to the function with this body, return type,
+        // attributes and function scope should be inlined. [[Inline]] skips
+        // the size check, but a function is never inlined while its own body
+        // is being emitted, nor when it returns a value and its body doesn't
+        // end in a return, as there'd be nothing to give the call
+        static bool ShouldInline(std::vector<ASTNodePtr>& body, Type* returnType, const std::vector<GlobalAttribute>& attributes, Scope* scope);
+
+        // Emits body in place of a call made from caller, which must be
+        // inside a function being emitted, binding each parameter to the
+        // argument value given for it. diag is the callee's, so errors point
+        // into its file. Returns the value the call evaluates to, or nullptr
+        // for a void function
+        static vipir::Value* EmitBody(vipir::IRBuilder& builder, vipir::Module& module, CompilerContext& context, diagnostic::Diagnostics& diag,
+            std::vector<ASTNodePtr>& body, Type* returnType, Scope* scope, Scope* caller, const std::vector<std::pair<LocalSymbol*, vipir::Value*> >& arguments);
+    };
+}
+
+#endif // VIPER_FRAMEWORK_PARSER_AST_INLINER_H
@@ -3,6 +3,9 @@
 #ifndef VIPER_FRAMEWORK_PARSER_AST_AST_NODE_H
 #define VIPER_FRAMEWORK_PARSER_AST_AST_NODE_H 1
 
+#include "parser/ast/Arena.h"
+#include "parser/ast/ConstantValue.h"
+
 #include "symbol/Scope.h"
 
 #include "type/Type.h"
@@ -13,28 +16,70 @@
 
 #include <vipir/IR/IRBuilder.h>
 
+#include <cstddef>
+#include <functional>
 #include <memory>
 
 namespace parser
 {
+    class ASTNode;
+    using ASTNodePtr = std::unique_ptr<ASTNode>;
+
+    class ConstantEvaluator;
+
     class ASTNode
     {
     public:
         ASTNode() { }
         virtual ~ASTNode() { }
 
+        // Nodes only live in an Arena, so they are created with Arena::create
+        // and deleting one just runs its destructor (see parser/ast/Arena.h)
+        static void* operator new(std::size_t size) = delete;
+        static void* operator new(std::size_t size, Arena& arena);
+        static void operator delete(void* pointer);
+        static void operator delete(void* pointer, Arena& arena);
+
         Type* getType() const { return mType; }
         lexing::Token& getDebugToken() { return mPreferredDebugToken; }
 
-        virtual void typeCheck(Scope* scope, diagnostic::Diagnostics& diag) = 0;
-        virtual vipir::Value* emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag) = 0;
-    
+        virtual void typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag) = 0;
+        virtual vipir::Value* emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag) = 0;
+
+        // Runs between typeCheck and emit. Folds any constant subexpressions
+        // of this node, then returns a simpler node to use in its place, or
+        // nullptr to keep it
+        virtual ASTNodePtr fold(CompilerContext& context, diagnostic::Diagnostics& diag) { return nullptr; }
+
+        // Folds node and replaces it with the result
+        static void Fold(ASTNodePtr& node, CompilerContext& context, diagnostic::Diagnostics& diag)
+        {
+            if (!node) return;
+
+            if (ASTNodePtr folded = node->fold(context, diag))
+            {
+                node = std::move(folded);
+            }
+        }
+
+        // Whether control never gets past this statement because it always
+        // returns, breaks or continues, so anything after it in a block is dead
+        virtual bool leavesBlock() const { return false; }
+
+        // Runs this node at compile time (see parser/ast/ConstantEvaluator.h).
+        // Nodes that can't be evaluated keep these defaults
+        virtual std::optional<ConstantValue> evaluate(ConstantEvaluator& evaluator) { return std::nullopt; }
+        virtual ConstantValue* evaluateAddress(ConstantEvaluator& evaluator) { return nullptr; }
+
+        // Calls callback on each node directly beneath this one, in the
+        // order they appear in the source. Leaves have no children
+        virtual void forEachChild(const std::function<void(ASTNode*)>& callback) { }
+
     protected:
         Type* mType;
 
         lexing::Token mPreferredDebugToken;
     };
-    using ASTNodePtr = std::unique_ptr<ASTNode>;
 }
 
 #endif // VIPER_FRAMEWORK_PARSER_AST_AST_NODE_H
\ No newline at end of file
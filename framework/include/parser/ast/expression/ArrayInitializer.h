@@ -12,10 +12,13 @@ namespace parser
     class ArrayInitializer : public ASTNode
     {
     public:
-        ArrayInitializer(std::vector<ASTNodePtr>&& body, lexing::Token token);
+        ArrayInitializer(CompilerContext& context, std::vector<ASTNodePtr>&& body, lexing::Token token);
 
-        void typeCheck(Scope* scope, diagnostic::Diagnostics& diag) override;
-        vipir::Value* emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag) override;
+        void typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag) override;
+        vipir::Value* emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag) override;
+        ASTNodePtr fold(CompilerContext& context, diagnostic::Diagnostics& diag) override;
+        std::optional<ConstantValue> evaluate(ConstantEvaluator& evaluator) override;
+        void forEachChild(const std::function<void(ASTNode*)>& callback) override;
 
     private:
         std::vector<ASTNodePtr> mBody;
@@ -30,10 +30,14 @@ namespace parser
             ArrayAccess,
         };
 
-        BinaryExpression(ASTNodePtr left, lexing::Token operatorToken, ASTNodePtr right);
+        BinaryExpression(CompilerContext& context, ASTNodePtr left, lexing::Token operatorToken, ASTNodePtr right);
 
-        void typeCheck(Scope* scope, diagnostic::Diagnostics& diag) override;
-        vipir::Value* emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag) override;
+        void typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag) override;
+        vipir::Value* emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag) override;
+        ASTNodePtr fold(CompilerContext& context, diagnostic::Diagnostics& diag) override;
+        std::optional<ConstantValue> evaluate(ConstantEvaluator& evaluator) override;
+        ConstantValue* evaluateAddress(ConstantEvaluator& evaluator) override;
+        void forEachChild(const std::function<void(ASTNode*)>& callback) override;
 
     private:
         ASTNodePtr mLeft;
@@ -42,6 +46,13 @@ namespace parser
         ASTNodePtr mRight;
 
         void checkAssignmentLvalue(vipir::Value* pointer, diagnostic::Diagnostics& diag);
+        void checkAssignmentTarget(diagnostic::Diagnostics& diag);
+        bool isUnsignedCompare() const;
+        void flipSignBits(vipir::IRBuilder& builder, vipir::Module& module, vipir::Value*& left, vipir::Value*& right);
+
+        ASTNodePtr foldConstants(CompilerContext& context, diagnostic::Diagnostics& diag);
+        std::optional<std::intmax_t> applyOperator(Operator op, std::intmax_t lhsValue, std::intmax_t rhsValue) const; // mLeft must be an integer
+        ASTNodePtr simplify(CompilerContext& context);
     };
 
     using BinaryExpressionPtr = std::unique_ptr<BinaryExpression>;
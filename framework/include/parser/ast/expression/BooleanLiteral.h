@@ -10,12 +10,13 @@ namespace parser
     class BooleanLiteral : public ASTNode
     {
     public:
-        BooleanLiteral(bool value, lexing::Token token);
+        BooleanLiteral(CompilerContext& context, bool value, lexing::Token token);
 
         bool getValue() const;
 
-        void typeCheck(Scope* scope, diagnostic::Diagnostics& diag) override;
-        vipir::Value* emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag) override;
+        void typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag) override;
+        vipir::Value* emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag) override;
+        std::optional<ConstantValue> evaluate(ConstantEvaluator& evaluator) override;
 
     private:
         bool mValue;
@@ -11,16 +11,22 @@ namespace parser
     class CallExpression : public ASTNode
     {
     public:
-        CallExpression(ASTNodePtr function, std::vector<ASTNodePtr> parameters, lexing::Token token);
+        CallExpression(CompilerContext& context, ASTNodePtr function, std::vector<ASTNodePtr> parameters, lexing::Token token);
 
-        void typeCheck(Scope* scope, diagnostic::Diagnostics& diag) override;
-        vipir::Value* emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag) override;
+        FunctionSymbol* getCallee() const;
+
+        void typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag) override;
+        vipir::Value* emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag) override;
+        ASTNodePtr fold(CompilerContext& context, diagnostic::Diagnostics& diag) override;
+        std::optional<ConstantValue> evaluate(ConstantEvaluator& evaluator) override;
+        void forEachChild(const std::function<void(ASTNode*)>& callback) override;
 
     private:
         ASTNodePtr mFunction;
         std::vector<ASTNodePtr> mParameters;
 
         FunctionType* mFunctionType;
+        FunctionSymbol* mCallee; // bound by typeCheck unless the callee is an arbitrary expression
     };
 
     using CallExpressionPtr = std::unique_ptr<CallExpression>;
@@ -12,18 +12,26 @@ namespace parser
 {
     class MemberAccess : public ASTNode
     {
+    friend class BinaryExpression;
     friend class CallExpression;
     public:
         MemberAccess(ASTNodePtr struc, std::string field, bool pointer, lexing::Token fieldToken);
 
-        void typeCheck(Scope* scope, diagnostic::Diagnostics& diag) override;
-        vipir::Value* emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag) override;
+        void typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag) override;
+        vipir::Value* emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag) override;
+        ASTNodePtr fold(CompilerContext& context, diagnostic::Diagnostics& diag) override;
+        std::optional<ConstantValue> evaluate(ConstantEvaluator& evaluator) override;
+        ConstantValue* evaluateAddress(ConstantEvaluator& evaluator) override;
+        void forEachChild(const std::function<void(ASTNode*)>& callback) override;
 
     private:
         ASTNodePtr mStruct;
         std::string mField;
         bool mPointer;
         lexing::Token mFieldToken;
+
+        StructType* mStructType;
+        int mFieldIndex; // bound by typeCheck
     };
 
     using MemberAccessPtr = std::unique_ptr<MemberAccess>;
@@ -13,17 +13,22 @@ namespace parser
     class ScopeResolution : public ASTNode
     {
     public:
-        ScopeResolution(ASTNodePtr left, lexing::Token token, ASTNodePtr right);
+        ScopeResolution(CompilerContext& context, ASTNodePtr left, lexing::Token token, ASTNodePtr right);
 
         std::vector<std::string> getNames();
 
-        void typeCheck(Scope* scope, diagnostic::Diagnostics& diag) override;
-        vipir::Value* emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag) override;
+        void typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag) override;
+        vipir::Value* emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag) override;
+        ASTNodePtr fold(CompilerContext& context, diagnostic::Diagnostics& diag) override;
+        std::optional<ConstantValue> evaluate(ConstantEvaluator& evaluator) override;
+        void forEachChild(const std::function<void(ASTNode*)>& callback) override;
 
     private:
         ASTNodePtr mLeft;
         lexing::Token mToken;
         ASTNodePtr mRight;
+
+        GlobalSymbol* mGlobal; // bound by typeCheck
     };
 
     using ScopeResolutionPtr = std::unique_ptr<ScopeResolution>;
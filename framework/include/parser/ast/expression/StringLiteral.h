@@ -10,10 +10,10 @@ namespace parser
     class StringLiteral : public ASTNode
     {
     public:
-        StringLiteral(std::string value, lexing::Token token);
+        StringLiteral(CompilerContext& context, std::string value, lexing::Token token);
 
-        void typeCheck(Scope* scope, diagnostic::Diagnostics& diag) override;
-        vipir::Value* emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag) override;
+        void typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag) override;
+        vipir::Value* emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag) override;
 
     private:
         std::string mValue;
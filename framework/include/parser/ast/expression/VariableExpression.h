@@ -13,16 +13,40 @@ namespace parser
     {
     friend class CallExpression;
     public:
-        VariableExpression(std::string&& name, Type* type, lexing::Token token);
+        VariableExpression(std::string&& name, Type* type, lexing::Token token, LocalSymbol* local = nullptr);
+        VariableExpression(std::string&& name, Type* type, lexing::Token token, LocalSymbol* self, int fieldIndex); // field of this
         
         std::string getName();
+        FunctionSymbol* getFunction() const; // set if this names a function, once type checked
 
-        void typeCheck(Scope* scope, diagnostic::Diagnostics& diag) override;
-        vipir::Value* emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag) override;
+        void typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag) override;
+        vipir::Value* emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag) override;
+        ASTNodePtr fold(CompilerContext& context, diagnostic::Diagnostics& diag) override;
+        std::optional<ConstantValue> evaluate(ConstantEvaluator& evaluator) override;
+        ConstantValue* evaluateAddress(ConstantEvaluator& evaluator) override;
+
+        // Whether both expressions read the same storage, once bound
+        bool isSameVariable(const VariableExpression* other) const;
+
+        // Whether this names a constexpr, once type checked
+        bool isConstexpr() const;
+
+        // Called by typeCheck on an expression that is written to or has
+        // its address taken. If it names a local, the local needs a stack slot
+        static void RequireSlot(ASTNode* node);
 
     private:
         std::string mName;
         lexing::Token mToken;
+
+        // What the name refers to: at most one of a local or a field of the
+        // enclosing struct, bound by the parser, or a function or a global,
+        // bound by typeCheck
+        LocalSymbol* mLocal;
+        LocalSymbol* mSelf;
+        int mFieldIndex;
+        FunctionSymbol* mFunction;
+        GlobalSymbol* mGlobal;
     };
     using VariableExpressionPtr = std::unique_ptr<VariableExpression>;
 }
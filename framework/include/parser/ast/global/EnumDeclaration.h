@@ -17,10 +17,10 @@ namespace parser
     class EnumDeclaration : public ASTNode
     {
     public:
-        EnumDeclaration(std::vector<GlobalAttribute> attributes, std::vector<std::string> names, std::vector<EnumField> fields);
+        EnumDeclaration(CompilerContext& context, std::vector<GlobalAttribute> attributes, std::vector<std::string> names, std::vector<EnumField> fields);
 
-        void typeCheck(Scope* scope, diagnostic::Diagnostics& diag) override;
-        vipir::Value* emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag) override;
+        void typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag) override;
+        vipir::Value* emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag) override;
 
     private:
         std::vector<GlobalAttribute> mAttributes;
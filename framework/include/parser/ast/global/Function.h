@@ -13,17 +13,36 @@ namespace parser
     {
         std::string name;
         Type* type;
+        LocalSymbol* symbol = nullptr;
     };
 
     class Function : public ASTNode
     {
     public:
-        Function(std::vector<GlobalAttribute> attributes, Type* type, std::vector<FunctionArgument> arguments, std::string_view name, std::vector<ASTNodePtr>&& body, Scope* scope);
+        Function(std::vector<GlobalAttribute> attributes, Type* type, std::vector<FunctionArgument> arguments, std::string_view name, std::vector<ASTNodePtr>&& body, Scope* scope, bool exported = false);
+
+        // The symbol for the function with these qualified names, type and
+        // attributes, created the first time it's asked for. mangledName is
+        // set to the name the symbol is kept under
+        static FunctionSymbol* Declare(CompilerContext& context, std::vector<std::string> names, Type* type, const std::vector<GlobalAttribute>& attributes, std::string& mangledName);
 
         Type* getReturnType() const;
+        std::vector<ASTNodePtr>& getBody();
+        const std::vector<GlobalAttribute>& getAttributes() const;
+        FunctionSymbol* getSymbol() const; // bound by typeCheck
+        bool isExported() const;
+
+        void typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag) override;
+        vipir::Value* emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag) override;
+        ASTNodePtr fold(CompilerContext& context, diagnostic::Diagnostics& diag) override;
+        void forEachChild(const std::function<void(ASTNode*)>& callback) override;
 
-        void typeCheck(Scope* scope, diagnostic::Diagnostics& diag) override;
-        vipir::Value* emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag) override;
+        // Runs a call to this function at compile time
+        std::optional<ConstantValue> evaluateCall(ConstantEvaluator& evaluator, std::vector<ConstantValue> arguments);
+
+        // See parser/ast/Inliner.h
+        bool shouldInline();
+        vipir::Value* emitInline(vipir::IRBuilder& builder, vipir::Module& module, Scope* caller, std::vector<vipir::Value*> arguments, CompilerContext& context);
 
     private:
         std::vector<GlobalAttribute> mAttributes;
@@ -33,6 +52,11 @@ namespace parser
         std::string mName;
         std::vector<ASTNodePtr> mBody;
         ScopePtr mScope;
+        bool mExported;
+
+        std::string mMangledName;
+        FunctionSymbol* mSymbol;
+        diagnostic::Diagnostics* mDiag; // of the file the body is in, set by typeCheck for when it's inlined elsewhere
     };
     using FunctionPtr = std::unique_ptr<Function>;
 }
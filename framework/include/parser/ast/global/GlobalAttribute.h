@@ -3,23 +3,58 @@
 #ifndef VIPER_FRAMEWORK_PARSER_AST_GLOBAL_GLOBAL_ATTRIBUTE_H
 #define VIPER_FRAMEWORK_PARSER_AST_GLOBAL_GLOBAL_ATTRIBUTE_H 1
 
+#include <vector>
+
+namespace lexing
+{
+    class Token;
+}
+
+namespace diagnostic
+{
+    class Diagnostics;
+}
+
 namespace parser
 {
     enum class GlobalAttributeType
     {
         NoMangle,
-        GenerateNames
+        GenerateNames,
+        Align,
+        Reorder,
+        Inline,
+        NoInline
     };
 
     class GlobalAttribute
     {
     public:
-        GlobalAttribute(GlobalAttributeType type);
+        // Largest N accepted by Align(N), in bytes. A page is more than any
+        // cache line, and keeps the alignment in bits well inside an int
+        static constexpr unsigned long long MaxAlignment = 4096;
+
+        // Largest alignment, in bytes, that objects of a type actually get.
+        // Align(N) pads the type's size and layout, but vipir places stack
+        // slots and globals at no more than their natural alignment, and
+        // nothing in viper is naturally aligned past 8 bytes. A struct
+        // declared with more is warned about where it's defined
+        static constexpr unsigned long long GuaranteedAlignment = 8;
+
+        GlobalAttribute(GlobalAttributeType type, unsigned long long value = 0);
 
         GlobalAttributeType getType() const;
+        unsigned long long getValue() const; // the N in Align(N)
+
+        // Reports the N of an Align(N), read from token, if it isn't a power of two up to MaxAlignment
+        static void CheckAlignment(unsigned long long alignment, const lexing::Token& token, diagnostic::Diagnostics& diag);
+
+        // Align and Reorder describe a struct's layout, so anything else given them is an error
+        static void RejectLayoutAttributes(const std::vector<GlobalAttribute>& attributes, const lexing::Token& token, diagnostic::Diagnostics& diag);
 
     private:
         GlobalAttributeType mType;
+        unsigned long long mValue;
     };
 }
 
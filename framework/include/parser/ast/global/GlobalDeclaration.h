@@ -10,14 +10,20 @@ namespace parser
     class GlobalDeclaration : public ASTNode
     {
     public:
-        GlobalDeclaration(std::vector<std::string> names, Type* type, ASTNodePtr initVal);
+        GlobalDeclaration(CompilerContext& context, std::vector<std::string> names, Type* type, ASTNodePtr initVal);
 
-        void typeCheck(Scope* scope, diagnostic::Diagnostics& diag) override;
-        vipir::Value* emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag) override;
+        ASTNodePtr& getInitializer(); // filled in by the parser once the rest of the file is declared
+
+        void typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag) override;
+        vipir::Value* emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag) override;
+        ASTNodePtr fold(CompilerContext& context, diagnostic::Diagnostics& diag) override;
+        void forEachChild(const std::function<void(ASTNode*)>& callback) override;
 
     private:
         std::vector<std::string> mNames;
         ASTNodePtr mInitVal;
+
+        GlobalSymbol* mSymbol;
     };
     using GlobalDeclarationPtr = std::unique_ptr<GlobalDeclaration>;
 }
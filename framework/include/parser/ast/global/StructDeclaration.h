@@ -23,24 +23,36 @@ namespace parser
         std::vector<FunctionArgument> arguments;
         std::vector<ASTNodePtr> body;
         ScopePtr scope;
+
+        std::string mangledName;
+        FunctionSymbol* symbol = nullptr;
+        LocalSymbol* self = nullptr;
+
+        std::vector<GlobalAttribute> attributes;
+
+        diagnostic::Diagnostics* diag = nullptr; // of the file the body is in, set by typeCheck for when it's inlined elsewhere
     };
 
     class StructDeclaration : public ASTNode
     {
     public:
-        StructDeclaration(std::vector<std::string> names, std::vector<StructField> fields, std::vector<StructMethod> methods, Type* type);
+        StructDeclaration(CompilerContext& context, std::vector<std::string> names, std::vector<StructField> fields, std::vector<StructMethod> methods, Type* type, bool exported = false);
 
-        void typeCheck(Scope* scope, diagnostic::Diagnostics& diag) override;
-        vipir::Value* emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag) override;
+        void typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag) override;
+        vipir::Value* emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag) override;
+        ASTNodePtr fold(CompilerContext& context, diagnostic::Diagnostics& diag) override;
+        void forEachChild(const std::function<void(ASTNode*)>& callback) override;
 
         std::vector<std::string>& getNames();
         std::vector<StructField>& getFields();
         std::vector<StructMethod>& getMethods();
+        bool isExported() const;
 
     private:
         std::vector<std::string> mNames;
         std::vector<StructField> mFields;
         std::vector<StructMethod> mMethods;
+        bool mExported;
     };
     using StructDeclarationPtr = std::unique_ptr<StructDeclaration>;
 }
@@ -10,10 +10,10 @@ namespace parser
     class UsingDeclaration : public ASTNode
     {
     public:
-        UsingDeclaration(std::vector<std::string> names, Type* type);
+        UsingDeclaration(CompilerContext& context, std::vector<std::string> names, Type* type);
 
-        void typeCheck(Scope* scope, diagnostic::Diagnostics& diag) override;
-        vipir::Value* emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag) override;
+        void typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag) override;
+        vipir::Value* emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag) override;
 
     private:
         std::vector<std::string> mNames;
@@ -12,8 +12,19 @@ namespace parser
     public:
         CompoundStatement(std::vector<ASTNodePtr>&& body, Scope* scope);
 
-        void typeCheck(Scope* scope, diagnostic::Diagnostics& diag) override;
-        vipir::Value* emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag) override;
+        std::vector<ASTNodePtr>& getBody();
+
+        void typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag) override;
+        vipir::Value* emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag) override;
+        ASTNodePtr fold(CompilerContext& context, diagnostic::Diagnostics& diag) override;
+        std::optional<ConstantValue> evaluate(ConstantEvaluator& evaluator) override;
+        bool leavesBlock() const override;
+        void forEachChild(const std::function<void(ASTNode*)>& callback) override;
+
+        // Folds each statement of a block in order. Blocks nested directly
+        // in it are spliced in, since a block's scope is only needed while
+        // parsing, and anything after a statement that leaves the block is dropped
+        static void FoldBody(std::vector<ASTNodePtr>& body, CompilerContext& context, diagnostic::Diagnostics& diag);
 
     private:
         std::vector<ASTNodePtr> mBody;
@@ -1,27 +1,45 @@
-#ifndef VIPER_FRAMEWORK_PARSER_AST_STATEMENT_CONSTEXPR_STATEMENT_H
-#define VIPER_FRAMEWORK_PARSER_AST_STATEMENT_CONSTEXPR_STATEMENT_H
-
-#include "lexer/Token.h"
-#include "parser/ast/Node.h"
-
-namespace parser
-{
-    class ConstexprStatement : public ASTNode
-    {
-    public:
-        ConstexprStatement(Type* type, std::vector<std::string> names, ASTNodePtr&& value, lexing::Token token, bool global);
-
-        void typeCheck(Scope* scope, diagnostic::Diagnostics& diag) override;
-        vipir::Value* emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag) override;
-
-    private:
-        std::vector<std::string> mNames;
-        ASTNodePtr mValue;
-        lexing::Token mToken;
-        bool mGlobal;
-    };
-
-    using ConstexprStatementPtr = std::unique_ptr<ConstexprStatement>;
-}
-
+#ifndef VIPER_FRAMEWORK_PARSER_AST_STATEMENT_CONSTEXPR_STATEMENT_H
+#define VIPER_FRAMEWORK_PARSER_AST_STATEMENT_CONSTEXPR_STATEMENT_H
+
+#include "lexer/Token.h"
+#include "parser/ast/Node.h"
+
+namespace parser
+{
+    class ConstexprStatement : public ASTNode
+    {
+    public:
+        ConstexprStatement(CompilerContext& context, Type* type, std::vector<std::string> names, ASTNodePtr&& value, lexing::Token token, bool global, LocalSymbol* localSymbol);
+
+        ASTNodePtr& getValue(); // for a global, filled in by the parser once the rest of the file is declared
+
+        void typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag) override;
+        vipir::Value* emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag) override;
+        ASTNodePtr fold(CompilerContext& context, diagnostic::Diagnostics& diag) override;
+        std::optional<ConstantValue> evaluate(ConstantEvaluator& evaluator) override;
+        void forEachChild(const std::function<void(ASTNode*)>& callback) override;
+
+        // A literal to replace a use of the constexpr with, or nullptr if its
+        // value doesn't fold to one. The value is folded on first use, since a
+        // global constexpr can be used before its declaration is reached
+        ASTNodePtr foldUse(const lexing::Token& token, CompilerContext& context, diagnostic::Diagnostics& diag);
+
+        // The value of a use of the constexpr during compile-time evaluation
+        std::optional<ConstantValue> evaluateUse(ConstantEvaluator& evaluator);
+
+    private:
+        std::vector<std::string> mNames;
+        ASTNodePtr mValue;
+        lexing::Token mToken;
+        bool mGlobal;
+
+        GlobalSymbol* mGlobalSymbol;
+        LocalSymbol* mLocalSymbol;
+
+        bool mFolded;
+    };
+
+    using ConstexprStatementPtr = std::unique_ptr<ConstexprStatement>;
+}
+
 #endif //VIPER_FRAMEWORK_PARSER_AST_STATEMENT_CONSTEXPR_STATEMENT_H
\ No newline at end of file
@@ -14,14 +14,18 @@ namespace parser
     class SwitchStatement : public ASTNode
     {
     public:
-        SwitchStatement(ASTNodePtr&& value, std::vector<SwitchSection>&& cases);
+        SwitchStatement(ASTNodePtr&& value, std::vector<SwitchSection>&& cases, Scope* scope, lexing::Token token);
 
-        void typeCheck(Scope* scope, diagnostic::Diagnostics& diag) override;
-        vipir::Value* emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag) override;
+        void typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag) override;
+        vipir::Value* emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag) override;
+        ASTNodePtr fold(CompilerContext& context, diagnostic::Diagnostics& diag) override;
+        std::optional<ConstantValue> evaluate(ConstantEvaluator& evaluator) override;
+        void forEachChild(const std::function<void(ASTNode*)>& callback) override;
 
     private:
         ASTNodePtr mValue;
         std::vector<SwitchSection> mSections;
+        ScopePtr mScope;
     };
 
     using SwitchStatementPtr = std::unique_ptr<SwitchStatement>;
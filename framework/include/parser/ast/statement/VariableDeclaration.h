@@ -10,14 +10,21 @@ namespace parser
     class VariableDeclaration : public ASTNode
     {
     public:
-        VariableDeclaration(Type* type, std::string&& name, ASTNodePtr&& initialValue);
+        VariableDeclaration(Type* type, std::string&& name, ASTNodePtr&& initialValue, LocalSymbol* symbol);
 
-        void typeCheck(Scope* scope, diagnostic::Diagnostics& diag) override;
-        vipir::Value* emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag) override;
+        LocalSymbol* getSymbol() const;
+
+        void typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag) override;
+        vipir::Value* emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag) override;
+        ASTNodePtr fold(CompilerContext& context, diagnostic::Diagnostics& diag) override;
+        std::optional<ConstantValue> evaluate(ConstantEvaluator& evaluator) override;
+        void forEachChild(const std::function<void(ASTNode*)>& callback) override;
 
     private:
         std::string mName;
         ASTNodePtr mInitialValue;
+
+        LocalSymbol* mSymbol;
     };
     using VariableDeclarationPtr = std::unique_ptr<VariableDeclaration>;
 }
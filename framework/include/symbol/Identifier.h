@@ -9,9 +9,12 @@
 
 namespace symbol
 {
-    void AddIdentifier(std::string mangledName, std::vector<std::string> names);
+    void AddIdentifier(CompilerContext& context, std::string mangledName, std::vector<std::string> names);
 
-    std::vector<std::string> GetSymbol(std::vector<std::string> givenNames, std::vector<std::string> activeNames);
+    // Mangled names of every symbol that givenNames can refer to from inside
+    // the namespaces in activeNames. Matches for the name as given come
+    // first, then those found through each namespace from the innermost out
+    std::vector<std::string> GetSymbol(CompilerContext& context, const std::vector<std::string>& givenNames, const std::vector<std::string>& activeNames);
 }
 
 #endif //VIPER_FRAMEWORK_SYMBOL_IDENTIFIER_H
\ No newline at end of file
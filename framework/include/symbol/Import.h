@@ -5,6 +5,8 @@
 
 #include "parser/ast/Node.h"
 
+#include "lexer/SourceManager.h"
+
 #include "diagnostic/Diagnostic.h"
 
 #include <filesystem>
@@ -20,13 +22,15 @@ namespace symbol
     class ImportManager
     {
     public:
-        ImportManager();
+        ImportManager(lexing::SourceManager& sourceManager, CompilerContext& context);
 
         void addSearchPath(std::string path);
         std::pair<std::vector<parser::ASTNodePtr>, std::vector<parser::GlobalSymbol>> ImportSymbols(std::filesystem::path path, diagnostic::Diagnostics& diag);
 
     private:
         std::vector<std::string> mSearchPaths;
+        lexing::SourceManager& mSourceManager;
+        CompilerContext& mContext;
     };
 
 }
@@ -7,20 +7,40 @@
 #include "type/StructType.h"
 #include "type/FunctionType.h"
 
+#include <vipir/IR/IRBuilder.h>
 #include <vipir/IR/Instruction/AllocaInst.h>
 #include <vipir/IR/Function.h>
 #include <vipir/IR/GlobalVar.h>
 
+#include <cstdint>
+#include <deque>
 #include <optional>
+#include <string_view>
 #include <unordered_map>
 
+namespace parser
+{
+    class ConstexprStatement;
+    class Function;
+    struct StructMethod;
+}
+
 struct LocalSymbol
 {
     LocalSymbol() = default;
     LocalSymbol(vipir::AllocaInst* alloca, Type* type);
 
-    vipir::Value* alloca;
+    vipir::Value* alloca; // its stack slot, or its value if it's kept in a register
     Type* type;
+    std::uint32_t slot; // index in its function's frame
+
+    parser::ConstexprStatement* constexprDefinition = nullptr; // set if this names a constexpr
+
+    bool needsSlot = false; // set by typeCheck if it's written after its declaration or its address is taken
+
+    // A scalar that is only ever set by its declaration or as a parameter
+    // is emitted as the SSA value it's set to, without a stack slot
+    bool inRegister() const;
 };
 
 struct FunctionSymbol
@@ -34,7 +54,12 @@ struct FunctionSymbol
     bool mangle;
     FunctionType* type;
 
-    static void Create(vipir::Function* function, std::string mangledName, std::vector<std::string> names, Type* type, bool priv, bool mangle = true);
+    parser::Function* definition = nullptr; // set once a body for the function is checked
+    parser::StructMethod* method = nullptr; // likewise for a method
+
+    bool reachable = true; // cleared by parser::CallGraph if nothing can call it, so it isn't emitted
+
+    static FunctionSymbol* Create(CompilerContext& context, vipir::Function* function, std::string mangledName, std::vector<std::string> names, Type* type, bool priv, bool mangle = true);
 };
 struct GlobalSymbol
 {
@@ -43,29 +68,63 @@ struct GlobalSymbol
 
     vipir::Value* global;
     Type* type;
+
+    parser::ConstexprStatement* constexprDefinition = nullptr; // set if this names a constexpr
 };
-extern std::unordered_map<std::string, FunctionSymbol> GlobalFunctions;
-extern std::unordered_map<std::string, GlobalSymbol> GlobalVariables;
-FunctionSymbol* FindFunction(std::vector<std::string> givenNames, std::vector<std::string> activeNames, std::vector<Type*> arguments);
+// The global symbol tables are CompilerContext::functions and globals
+FunctionSymbol* FindFunction(CompilerContext& context, std::vector<std::string> givenNames, std::vector<std::string> activeNames, std::vector<Type*> arguments);
 
+// Everything a lookup needs from the enclosing scopes is worked out when a
+// scope is created, so none of the queries below walk the parent chain.
+// Locals are resolved by name through a symbol::SymbolTable while parsing
 struct Scope
 {
-    Scope(Scope* parent, StructType* owner);
+    enum class Kind
+    {
+        Block,
+        Function,
+        Loop,   // target of both break and continue
+        Switch, // target of break only
+    };
+
+    Scope(Scope* parent, StructType* owner, Kind kind = Kind::Block);
+    Scope(CompilerContext& context, Scope* parent, std::string_view namespaceName);
 
-    std::unordered_map<std::string, LocalSymbol> locals;
+    // Gives a new local the next slot in the frame of the enclosing function
+    LocalSymbol* addLocal(Type* type);
+
+    // Creates a stack slot in the entry block of the function being emitted,
+    // so that a slot declared inside a loop isn't allocated on every iteration
+    vipir::AllocaInst* createAlloca(vipir::IRBuilder& builder, vipir::Type* type);
 
-    LocalSymbol* findVariable(const std::string& name);
     vipir::BasicBlock* findBreakBB();
     vipir::BasicBlock* findContinueBB();
+    vipir::BasicBlock* findReturnBB();
     StructType* findOwner();
-    std::vector<std::string> getNamespaces();
+    Type* findReturnType();
+    const std::vector<std::string>& getNamespaces();
+
+    // Namespaces enclosing scope, which is null at global scope
+    static const std::vector<std::string>& GetNamespaces(Scope* scope);
 
     Scope* parent;
     StructType* owner;
     Type* currentReturnType;
     vipir::BasicBlock* breakTo;
     vipir::BasicBlock* continueTo;
-    std::string namespaceName;
+
+    // Only used in function scopes
+    std::deque<LocalSymbol> frame;
+    bool emitting; // the body is being emitted, either on its own or inlined into a caller
+    vipir::BasicBlock* returnTo; // set while inlined. A return stores its value to returnSlot and branches here
+    vipir::Value* returnSlot;
+    vipir::BasicBlock* allocaBlock; // set while emitting. The caller's entry block while inlined
+
+    // Nearest enclosing scope of each kind, possibly this one
+    Scope* function;
+    Scope* breakScope;
+    Scope* continueScope;
+    const std::vector<std::string>* namespaces; // interned, shared by every scope in a namespace
 };
 using ScopePtr = std::unique_ptr<Scope>;
 
@@ -0,0 +1,53 @@
+// Copyright 2024 solar-mist
+
+#ifndef VIPER_FRAMEWORK_SYMBOL_SYMBOL_TABLE_H
+#define VIPER_FRAMEWORK_SYMBOL_SYMBOL_TABLE_H 1
+
+#include "symbol/Scope.h"
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace symbol
+{
+    // The locals visible at the current point of the parse, in one flat map
+    // from name to the innermost local with that name. Declaring a local
+    // shadows any outer one until its scope is left, when the undo log puts
+    // the outer one back, so a lookup costs a single hash probe however
+    // deeply the scopes are nested
+    class SymbolTable
+    {
+    public:
+        void enterScope();
+        void exitScope();
+
+        void declare(std::string_view name, LocalSymbol* local);
+        LocalSymbol* find(std::string_view name) const;
+
+    private:
+        struct NameHash
+        {
+            using is_transparent = void;
+
+            std::size_t operator()(std::string_view name) const
+            {
+                return std::hash<std::string_view>{}(name);
+            }
+        };
+
+        struct Undo
+        {
+            LocalSymbol** binding;
+            LocalSymbol* previous;
+        };
+
+        // Names stay in the map once seen, bound to nullptr while out of scope
+        std::unordered_map<std::string, LocalSymbol*, NameHash, std::equal_to<>> mBindings;
+        std::vector<Undo> mUndoLog;
+        std::vector<std::size_t> mScopeStarts;
+    };
+}
+
+#endif // VIPER_FRAMEWORK_SYMBOL_SYMBOL_TABLE_H
@@ -11,14 +11,18 @@ public:
     ArrayType(Type* base, int count);
 
     Type* getBaseType() const;
-
-    int getSize() const override;
-    vipir::Type* getVipirType() const override;
-    std::string getMangleID() const override;
+    int getCount() const;
 
     bool isArrayType() const override;
+    bool hasFinalLayout() const override;
+
+    static ArrayType* Create(CompilerContext& context, Type* base, int count);
 
-    static ArrayType* Create(Type* base, int count);
+protected:
+    int computeSize() const override;
+    int computeAlignment() const override;
+    vipir::Type* computeVipirType() const override;
+    std::string computeMangleID() const override;
 
 private:
     Type* mBase;
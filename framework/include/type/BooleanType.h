@@ -10,11 +10,12 @@ class BooleanType : public Type
 public:
     BooleanType();
 
-    int getSize() const override;
-    vipir::Type* getVipirType() const override;
-    std::string getMangleID() const override;
-
     bool isBooleanType() const override;
+
+protected:
+    int computeSize() const override;
+    vipir::Type* computeVipirType() const override;
+    std::string computeMangleID() const override;
 };
 
 #endif // VIPER_FRAMEWORK_TYPE_BOOLEAN_TYPE_H
\ No newline at end of file
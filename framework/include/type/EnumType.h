@@ -12,12 +12,14 @@ public:
 
     bool hsGeneratedNames() const;
 
-    int getSize() const override;
-    vipir::Type* getVipirType() const override;
-    std::string getMangleID() const override;
     bool isEnumType() const override;
 
-    static EnumType* Create(std::vector<std::string> names, bool generatedNames);
+    static EnumType* Create(CompilerContext& context, std::vector<std::string> names, bool generatedNames);
+
+protected:
+    int computeSize() const override;
+    vipir::Type* computeVipirType() const override;
+    std::string computeMangleID() const override;
 
 private:
     std::vector<std::string> mNames;
@@ -13,13 +13,15 @@ public:
     Type* getReturnType() const;
     const std::vector<Type*>& getArgumentTypes() const;
 
-    int getSize() const override;
-    vipir::Type* getVipirType() const override;
-    std::string getMangleID() const override;
-
     bool isFunctionType() const override;
+    bool hasFinalLayout() const override;
+
+    static FunctionType* Create(CompilerContext& context, Type* returnType, std::vector<Type*> arguments);
 
-    static FunctionType* Create(Type* returnType, std::vector<Type*> arguments);
+protected:
+    int computeSize() const override;
+    vipir::Type* computeVipirType() const override;
+    std::string computeMangleID() const override;
 
 private:
     Type* mReturnType;
@@ -5,19 +5,26 @@
 
 #include "type/Type.h"
 
+#include <cstdint>
+
 class IntegerType : public Type
 {
 public:
     IntegerType(int bits, bool isSigned);
 
-    int getSize() const override;
-    vipir::Type* getVipirType() const override;
-    std::string getMangleID() const override;
-
     bool isIntegerType() const override;
 
     bool isSigned() const;
 
+    // Truncates value to this type's width and sign or zero extends it back,
+    // which is how arithmetic on this type wraps around
+    std::intmax_t wrap(std::uintmax_t value) const;
+
+protected:
+    int computeSize() const override;
+    vipir::Type* computeVipirType() const override;
+    std::string computeMangleID() const override;
+
 private:
     int mBits;
     bool mSigned;
@@ -12,13 +12,15 @@ public:
 
     Type* getBaseType() const;
 
-    int getSize() const override;
-    vipir::Type* getVipirType() const override;
-    std::string getMangleID() const override;
-
     bool isPointerType() const override;
+    bool hasFinalLayout() const override;
+
+    static PointerType* Create(CompilerContext& context, Type* base);
 
-    static PointerType* Create(Type* base);
+protected:
+    int computeSize() const override;
+    vipir::Type* computeVipirType() const override;
+    std::string computeMangleID() const override;
 
 private:
     Type* mBase;
@@ -17,29 +17,74 @@ public:
         Type* type;
     };
 
+    // Where everything sits in memory, following the SysV rules: each field
+    // is placed at the next multiple of its alignment and the struct is
+    // padded out to a multiple of its own. Padding is spelled out as i8
+    // arrays in the vipir type so the backend can't lay it out differently
+    struct Layout
+    {
+        struct Element
+        {
+            int field;   // index into getFields(), or -1 for padding
+            int padding; // in bytes, for padding elements
+        };
+
+        std::vector<Element> elements; // in memory order
+        std::vector<int> offsets;      // in bits, per field in declaration order
+        std::vector<int> elementIndices; // per field in declaration order
+        int size;
+        int alignment;
+    };
+
     StructType(std::vector<std::string> names, std::vector<Field> fields);
 
     std::string_view getName() const;
     std::vector<std::string> getNames() const;
 
-    std::vector<Field>& getFields();
+    const std::vector<Field>& getFields() const;
+    void addField(Field field);
+
+    // Called once its definition has been parsed. Until then fields can still
+    // be added, so nothing built on it caches its layout
+    void complete();
+    bool isComplete() const;
     bool hasField(std::string_view fieldName);
     Field* getField(std::string_view fieldName);
-    int getFieldOffset(std::string fieldName);
+    int getFieldIndex(std::string_view fieldName) const;
 
-    int getSize() const override;
-    vipir::Type* getVipirType() const override;
-    std::string getMangleID() const override;
+    const Layout& getLayout() const;
+    int getFieldOffset(int index) const; // in bits
+    int getFieldElement(int index) const; // index to use with a struct GEP
+
+    // Minimum alignment in bits, from [[Align(N)]]
+    void setAlignment(int alignment);
+
+    // Lay fields out by decreasing alignment rather than declaration order
+    // to cut down on padding, from [[Reorder]]
+    void setReordered(bool reordered);
 
     bool isStructType() const override;
+    bool hasFinalLayout() const override;
 
-    static StructType* Get(std::string names);
-    static StructType* Create(std::vector<std::string> names, std::vector<Field> fields);
-    static void Erase(Type* type);
+    static StructType* Get(CompilerContext& context, std::string_view mangleID);
+    static StructType* Create(CompilerContext& context, std::vector<std::string> names, std::vector<Field> fields);
+    static void Erase(CompilerContext& context, Type* type);
+
+protected:
+    int computeSize() const override;
+    int computeAlignment() const override;
+    vipir::Type* computeVipirType() const override;
+    std::string computeMangleID() const override;
 
 private:
     std::vector<std::string> mNames;
     std::vector<Field> mFields;
+    int mExplicitAlignment;
+    bool mReordered;
+    bool mComplete;
+    mutable bool mCheckingLayout; // set while hasFinalLayout() walks the fields, which can lead back here
+
+    mutable Layout mLayout; // filled in by computeSize(), so refreshed along with the size
 };
 
 #endif // VIPER_FRAMEWORK_TYPE_STRUCT_TYPE_H
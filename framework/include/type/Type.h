@@ -6,6 +6,18 @@
 #include <vipir/Type/Type.h>
 
 #include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct CompilerContext;
+
+// Lets the type tables be searched with a string_view (e.g. token text) without building a std::string
+struct TypeNameHash
+{
+    using is_transparent = void;
+    std::size_t operator()(std::string_view name) const { return std::hash<std::string_view>{}(name); }
+};
 
 class Type
 {
@@ -13,9 +25,16 @@ public:
     Type(std::string name) : mName(std::move(name)) { }
     virtual ~Type() {}
 
-    virtual int getSize() const = 0;
-    virtual vipir::Type* getVipirType() const = 0;
-    virtual std::string getMangleID() const = 0;
+    // Worked out on first use and cached once the layout is final. Sizes
+    // and alignments are in bits
+    int getSize() const;
+    int getAlignment() const;
+    vipir::Type* getVipirType() const;
+    const std::string& getMangleID() const;
+
+    // Whether every struct this type is built from is complete, so its size
+    // and vipir type can't change any more. Builtins are always final
+    virtual bool hasFinalLayout() const { return true; }
 
     virtual bool isIntegerType()  const { return false; }
     virtual bool isVoidType()     const { return false; }
@@ -26,15 +45,30 @@ public:
     virtual bool isEnumType()     const { return false; }
     virtual bool isFunctionType() const { return false; }
 
-    static void Init();
-    static bool Exists(const std::string& name);
-    static void AddAlias(std::vector<std::string> names, Type* type);
-    static Type* Get(const std::string& name);
+    static bool Exists(CompilerContext& context, std::string_view name);
+    static void AddAlias(CompilerContext& context, std::vector<std::string> names, Type* type);
+    static Type* Get(CompilerContext& context, std::string_view name);
+
+    // Builtin types, without going through a name lookup
+    static Type* GetIntegerType(CompilerContext& context, int bits, bool isSigned);
+    static Type* GetVoidType(CompilerContext& context);
+    static Type* GetBooleanType(CompilerContext& context);
 
     std::string_view getName() { return mName; }
 
 protected:
+    virtual int computeSize() const = 0;
+    virtual int computeAlignment() const; // scalars are aligned to their own size
+    virtual vipir::Type* computeVipirType() const = 0;
+    virtual std::string computeMangleID() const = 0;
+
     std::string mName;
+
+private:
+    mutable int mSize = -1;
+    mutable int mAlignment = -1;
+    mutable vipir::Type* mVipirType = nullptr;
+    mutable std::string mMangleID; // depends only on names, so it never goes stale
 };
 
 #endif // VIPER_FRAMEWORK_TYPE_TYPE_H
\ No newline at end of file
@@ -10,11 +10,12 @@ class VoidType : public Type
 public:
     VoidType();
 
-    int getSize() const override;
-    vipir::Type* getVipirType() const override;
-    std::string getMangleID() const override;
-
     bool isVoidType() const override;
+
+protected:
+    int computeSize() const override;
+    vipir::Type* computeVipirType() const override;
+    std::string computeMangleID() const override;
 };
 
 #endif // VIPER_FRAMEWORK_TYPE_VOID_TYPE_H
@@ -0,0 +1,29 @@
+// Copyright 2024 solar-mist
+
+
+#include "context/CompilerContext.h"
+
+#include "type/BooleanType.h"
+#include "type/IntegerType.h"
+#include "type/VoidType.h"
+
+CompilerContext::CompilerContext()
+{
+    auto addBuiltin = [this](std::string name, std::unique_ptr<Type> type) {
+        Type* builtin = type.get();
+        types[std::move(name)] = std::move(type);
+        return builtin;
+    };
+
+    integerTypes[1][0] = addBuiltin("i8",  std::make_unique<IntegerType>(8, true));
+    integerTypes[1][1] = addBuiltin("i16", std::make_unique<IntegerType>(16, true));
+    integerTypes[1][2] = addBuiltin("i32", std::make_unique<IntegerType>(32, true));
+    integerTypes[1][3] = addBuiltin("i64", std::make_unique<IntegerType>(64, true));
+    integerTypes[0][0] = addBuiltin("u8",  std::make_unique<IntegerType>(8, false));
+    integerTypes[0][1] = addBuiltin("u16", std::make_unique<IntegerType>(16, false));
+    integerTypes[0][2] = addBuiltin("u32", std::make_unique<IntegerType>(32, false));
+    integerTypes[0][3] = addBuiltin("u64", std::make_unique<IntegerType>(64, false));
+
+    voidType = addBuiltin("void", std::make_unique<VoidType>());
+    booleanType = addBuiltin("bool", std::make_unique<BooleanType>());
+}
@@ -7,10 +7,20 @@
 
 #include <format>
 #include <iostream>
+#include <mutex>
 #include <sstream>
 
 namespace diagnostic
 {
+    // Jobs report from several threads, so each diagnostic is written in one go
+    static std::mutex outputMutex;
+
+    static void Print(std::string_view text)
+    {
+        std::lock_guard<std::mutex> lock(outputMutex);
+        std::cerr << text;
+    }
+
     void Diagnostics::setImported(bool imported)
     {
         mImported = imported;
@@ -24,71 +34,98 @@ namespace diagnostic
     {
         mSender = sender;
     }
-    void Diagnostics::setText(std::string text)
+    void Diagnostics::setText(std::string_view text)
     {
         mText = text;
+        mLineTable.reset();
+    }
+    void Diagnostics::setRemarks(bool remarks)
+    {
+        mRemarks = remarks;
     }
 
 
     void Diagnostics::fatalError(std::string_view message)
     {
-        std::cerr << std::format("{}{}: {}fatal error: {}{}\n", fmt::bold, mSender, fmt::red, fmt::defaults, message);
+        Print(std::format("{}{}: {}fatal error: {}{}\n", fmt::bold, mSender, fmt::red, fmt::defaults, message));
 
-        std::exit(EXIT_FAILURE);
+        throw CompileError();
     }
 
     void Diagnostics::compilerError(lexing::SourceLocation start, lexing::SourceLocation end, std::string_view message)
     {
-        int lineStart = getLinePosition(start.line-1);
-        int lineEnd = getLinePosition(end.line)-1;
+        const lexing::LineTable& lineTable = getLineTable();
+        int line = lineTable.getLine(start.position);
+        int column = lineTable.getColumn(start.position);
+        int lineStart = lineTable.getLineStart(line);
+        int lineEnd = lineTable.getLineEnd(lineTable.getLine(end.position));
 
         end.position += 1;
-        std::string before = mText.substr(lineStart, start.position - lineStart);
-        std::string error = mText.substr(start.position, end.position - start.position);
-        std::string after = mText.substr(end.position, lineEnd - end.position);
-        std::string spacesBefore = std::string(std::to_string(start.line).length(), ' ');
+        std::string_view before = mText.substr(lineStart, start.position - lineStart);
+        std::string_view error = mText.substr(start.position, end.position - start.position);
+        std::string_view after = mText.substr(end.position, lineEnd - end.position);
+        std::string spacesBefore = std::string(std::to_string(line).length(), ' ');
         std::string spacesAfter = std::string(before.length(), ' ');
 
         std::string imported = mImported ? " in imported file" : "";
 
-        std::cerr << std::format("{}{}:{}:{} {}error{}: {}{}\n", fmt::bold, mFileName, start.line, start.column, fmt::red, imported, fmt::defaults, message);
-        std::cerr << std::format("    {} | {}{}{}{}{}{}\n", start.line, before, fmt::bold, fmt::red, error, fmt::defaults, after);
-        std::cerr << std::format("    {} | {}{}{}^{}{}\n", spacesBefore, spacesAfter, fmt::bold, fmt::red, std::string(error.length()-1, '~'), fmt::defaults);
+        Print(std::format("{}{}:{}:{} {}error{}: {}{}\n", fmt::bold, mFileName, line, column, fmt::red, imported, fmt::defaults, message)
+            + std::format("    {} | {}{}{}{}{}{}\n", line, before, fmt::bold, fmt::red, error, fmt::defaults, after)
+            + std::format("    {} | {}{}{}^{}{}\n", spacesBefore, spacesAfter, fmt::bold, fmt::red, std::string(error.length()-1, '~'), fmt::defaults));
 
-        std::exit(EXIT_FAILURE);
+        throw CompileError();
     }
 
     void Diagnostics::compilerWarning(lexing::SourceLocation start, lexing::SourceLocation end, std::string_view message)
     {
-        int lineStart = getLinePosition(start.line-1);
-        int lineEnd = getLinePosition(end.line)-1;
+        const lexing::LineTable& lineTable = getLineTable();
+        int line = lineTable.getLine(start.position);
+        int column = lineTable.getColumn(start.position);
+        int lineStart = lineTable.getLineStart(line);
+        int lineEnd = lineTable.getLineEnd(lineTable.getLine(end.position));
 
         end.position += 1;
-        std::string before = mText.substr(lineStart, start.position - lineStart);
-        std::string error = mText.substr(start.position, end.position - start.position);
-        std::string after = mText.substr(end.position, lineEnd - end.position);
-        std::string spacesBefore = std::string(std::to_string(start.line).length(), ' ');
+        std::string_view before = mText.substr(lineStart, start.position - lineStart);
+        std::string_view error = mText.substr(start.position, end.position - start.position);
+        std::string_view after = mText.substr(end.position, lineEnd - end.position);
+        std::string spacesBefore = std::string(std::to_string(line).length(), ' ');
         std::string spacesAfter = std::string(before.length(), ' ');
 
         std::string imported = mImported ? " in imported file" : "";
 
-        std::cerr << std::format("{}{}:{}:{} {}warning{}: {}{}\n", fmt::bold, mFileName, start.line, start.column, fmt::yellow, imported, fmt::defaults, message);
-        std::cerr << std::format("    {} | {}{}{}{}{}{}\n", start.line, before, fmt::bold, fmt::yellow, error, fmt::defaults, after);
-        std::cerr << std::format("    {} | {}{}{}^{}{}\n", spacesBefore, spacesAfter, fmt::bold, fmt::yellow, std::string(error.length()-1, '~'), fmt::defaults);
+        Print(std::format("{}{}:{}:{} {}warning{}: {}{}\n", fmt::bold, mFileName, line, column, fmt::yellow, imported, fmt::defaults, message)
+            + std::format("    {} | {}{}{}{}{}{}\n", line, before, fmt::bold, fmt::yellow, error, fmt::defaults, after)
+            + std::format("    {} | {}{}{}^{}{}\n", spacesBefore, spacesAfter, fmt::bold, fmt::yellow, std::string(error.length()-1, '~'), fmt::defaults));
+    }
+
+    bool Diagnostics::remarksEnabled() const
+    {
+        return mRemarks;
+    }
+
+    void Diagnostics::compilerRemark(lexing::SourceLocation start, std::string_view message)
+    {
+        if (!mRemarks)
+        {
+            return;
+        }
+
+        const lexing::LineTable& lineTable = getLineTable();
+        int line = lineTable.getLine(start.position);
+        int column = lineTable.getColumn(start.position);
+
+        std::string imported = mImported ? " in imported file" : "";
+
+        Print(std::format("{}{}:{}:{} remark{}: {}{}\n", fmt::bold, mFileName, line, column, imported, fmt::defaults, message));
     }
 
 
-    int Diagnostics::getLinePosition(int lineNumber)
+    const lexing::LineTable& Diagnostics::getLineTable()
     {
-        int line = 0;
-        for (int i = 0; i < lineNumber; ++i)
+        if (!mLineTable)
         {
-            while(mText[line] != '\n')
-            {
-                ++line;
-            }
-            ++line;
+            mLineTable.emplace(mText);
         }
-        return line;
+        return *mLineTable;
     }
 }
\ No newline at end of file
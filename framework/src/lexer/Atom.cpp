@@ -0,0 +1,56 @@
+// Copyright 2024 solar-mist
+
+
+#include "lexer/Atom.h"
+
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lexing
+{
+    // Atoms own a copy of their spelling so they outlive the source buffer they were first seen in
+    static std::deque<std::string> atomStorage;
+    static std::vector<std::string_view> atomTexts = { std::string_view() };
+    static std::unordered_map<std::string_view, Atom> atoms;
+
+    // Spellings mean the same thing in every compilation, so the table is
+    // shared between them rather than kept in the CompilerContext. Lexers on
+    // different threads only contend when they see a new spelling
+    static std::shared_mutex atomMutex;
+
+    Atom Intern(std::string_view text)
+    {
+        {
+            std::shared_lock lock(atomMutex);
+            auto it = atoms.find(text);
+            if (it != atoms.end())
+            {
+                return it->second;
+            }
+        }
+
+        std::unique_lock lock(atomMutex);
+        auto it = atoms.find(text); // another thread may have added it in the meantime
+        if (it != atoms.end())
+        {
+            return it->second;
+        }
+
+        std::string_view stored = atomStorage.emplace_back(text);
+        Atom atom = static_cast<Atom>(atomTexts.size());
+        atomTexts.push_back(stored);
+        atoms.emplace(stored, atom);
+
+        return atom;
+    }
+
+    std::string_view GetAtomText(Atom atom)
+    {
+        std::shared_lock lock(atomMutex);
+        return atomTexts[atom];
+    }
+}
@@ -2,23 +2,32 @@
 
 #include "lexer/Lexer.h"
 #include "lexer/Token.h"
+#include "lexer/CharClass.h"
+#include "lexer/Scan.h"
 
-#include "type/Type.h"
-
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <format>
-#include <unordered_map>
 
 namespace lexing
 {
-    Lexer::Lexer(const std::string& text, diagnostic::Diagnostics& diag)
+    Lexer::Lexer(std::string_view text, diagnostic::Diagnostics& diag)
         : mText(text)
         , mDiag(diag)
         , mPosition(0)
     {
-        mText += '\n'; // Fixes peeking crash at EOF
     }
 
-    const std::unordered_map<std::string_view, TokenType> keywords = {
+    struct Keyword
+    {
+        std::string_view text;
+        TokenType tokenType;
+    };
+
+    // Builtin type names are matched here too, so the lexer never has to
+    // consult the type table to classify an identifier
+    constexpr Keyword keywords[] = {
         { "func",       TokenType::FuncKeyword },
         { "return",     TokenType::ReturnKeyword },
         { "let",        TokenType::LetKeyword },
@@ -44,21 +53,104 @@ namespace lexing
         { "using",      TokenType::UsingKeyword },
         { "sizeof",     TokenType::SizeofKeyword },
         { "enum",       TokenType::EnumKeyword },
+        { "i8",         TokenType::Type },
+        { "i16",        TokenType::Type },
+        { "i32",        TokenType::Type },
+        { "i64",        TokenType::Type },
+        { "u8",         TokenType::Type },
+        { "u16",        TokenType::Type },
+        { "u32",        TokenType::Type },
+        { "u64",        TokenType::Type },
+        { "void",       TokenType::Type },
+        { "bool",       TokenType::Type },
     };
 
-    std::vector<Token> Lexer::lex()
+    // Perfect hash over the keywords, built at compile time. The hash only
+    // looks at the length and three characters; the seed is searched for
+    // until every keyword lands in its own slot
+    constexpr std::size_t KeywordTableSize = 128;
+    constexpr std::size_t MaxKeywordLength = 9;
+
+    constexpr std::uint32_t KeywordHash(std::string_view text, std::uint32_t seed)
+    {
+        std::uint32_t hash = static_cast<std::uint32_t>(text.size()) * seed;
+        hash = (hash ^ static_cast<unsigned char>(text.front())) * 0x01000193;
+        hash = (hash ^ static_cast<unsigned char>(text.back())) * 0x01000193;
+        hash = (hash ^ static_cast<unsigned char>(text[text.size() / 2])) * 0x01000193;
+        return (hash >> 16) % KeywordTableSize;
+    }
+
+    constexpr std::uint32_t FindKeywordSeed()
     {
-        std::vector<Token> tokens;
+        for (std::uint32_t seed = 1;; ++seed)
+        {
+            std::array<bool, KeywordTableSize> used{};
+            bool collision = false;
+            for (const Keyword& keyword : keywords)
+            {
+                std::uint32_t hash = KeywordHash(keyword.text, seed);
+                if (used[hash])
+                {
+                    collision = true;
+                    break;
+                }
+                used[hash] = true;
+            }
+            if (!collision) return seed;
+        }
+    }
+
+    constexpr std::uint32_t KeywordSeed = FindKeywordSeed();
 
+    constexpr std::array<std::int8_t, KeywordTableSize> BuildKeywordTable()
+    {
+        std::array<std::int8_t, KeywordTableSize> table{};
+        table.fill(-1);
+        for (std::size_t i = 0; i < std::size(keywords); ++i)
+        {
+            table[KeywordHash(keywords[i].text, KeywordSeed)] = static_cast<std::int8_t>(i);
+        }
+        return table;
+    }
+
+    constexpr std::array<std::int8_t, KeywordTableSize> keywordTable = BuildKeywordTable();
+
+    constexpr const Keyword* FindKeyword(std::string_view text)
+    {
+        if (text.size() > MaxKeywordLength) return nullptr;
+
+        std::int8_t index = keywordTable[KeywordHash(text, KeywordSeed)];
+        if (index == -1 || keywords[index].text != text) return nullptr;
+
+        return &keywords[index];
+    }
+
+    static_assert(FindKeyword("constexpr")->tokenType == TokenType::ConstexprKeyword);
+    static_assert(FindKeyword("u64")->tokenType == TokenType::Type);
+    static_assert(FindKeyword("main") == nullptr);
+
+    Token Lexer::next()
+    {
         while (mPosition < mText.length())
         {
             std::optional<Token> token = nextToken();
-            if(token.has_value())
-                tokens.push_back(*token);
             consume();
+            if (token.has_value())
+                return *token;
         }
 
-        return tokens;
+        // Sits on the trailing newline so diagnostics have something to point at
+        return Token(TokenType::EndOfFile, std::string_view(), static_cast<std::uint32_t>(mText.size() - 1));
+    }
+
+    void Lexer::seek(std::uint32_t position)
+    {
+        mPosition = position;
+    }
+
+    std::string_view Lexer::getText() const
+    {
+        return mText;
     }
 
     char Lexer::current()
@@ -68,12 +160,6 @@ namespace lexing
 
     char Lexer::consume()
     {
-        mColumn++;
-        if (mText[mPosition + 1] == '\n')
-        {
-            mColumn = 0;
-            mLine++;
-        }
         return mText[mPosition++];
     }
 
@@ -84,56 +170,57 @@ namespace lexing
 
     SourceLocation Lexer::location()
     {
-        return {mColumn, mLine, mPosition};
+        return { mPosition };
+    }
+
+    std::string_view Lexer::textFrom(SourceLocation start)
+    {
+        return mText.substr(start.position, mPosition - start.position + 1);
+    }
+
+    Token Lexer::token(TokenType tokenType, SourceLocation start)
+    {
+        return Token(tokenType, textFrom(start), start.position);
     }
 
     std::optional<Token> Lexer::nextToken()
     {
         SourceLocation start = location();
 
-        if (std::isalpha(current()) || current() == '_') // Identifier
+        if (CharClass::Is(current(), CharClass::IdentifierStart)) // Identifier
         {
-            std::string text = std::string(1, current());
-
-            while (std::isalnum(peek(1)) || peek(1) == '_')
-            {
-                consume();
-                text += current();
-            }
+            mPosition = SkipIdentifier(mText, mPosition + 1) - 1;
+            std::string_view text = textFrom(start);
 
-            if (keywords.find(text) != keywords.end())
+            if (const Keyword* keyword = FindKeyword(text))
             {
-                return Token(keywords.at(text), start, location());
-            }
-
-            if (Type::Exists(text))
-            {
-                return Token(TokenType::Type, std::move(text), start, location());
+                if (keyword->tokenType == TokenType::Type)
+                {
+                    return Token(TokenType::Type, text, start.position, Intern(text));
+                }
+                return token(keyword->tokenType, start);
             }
 
-            if (text.length() >= 2 && text[0] == '_' && std::isupper(text[1]))
+            if (text.length() >= 2 && text[0] == '_' && CharClass::Is(text[1], CharClass::Upper))
             {
                 mDiag.compilerError(start, location(), std::format("Identifier '{}{}{}' contains a reserved sequence '{}{}{}'",
                     fmt::bold, text, fmt::defaults, fmt::bold, text.substr(0,2), fmt::defaults));
             }
 
-            return Token(TokenType::Identifier, std::move(text), start, location());
+            return Token(TokenType::Identifier, text, start.position, Intern(text));
         }
 
-        if (std::isdigit(current()))
+        if (CharClass::Is(current(), CharClass::Digit))
         {
-            std::string text = std::string(1, current());
             if (current() == '0')
             {
                 if (peek(1) == 'x') // hex
                 {
                     consume();
-                    text += current();
 
-                    while (std::isxdigit(peek(1)))
+                    while (CharClass::Is(peek(1), CharClass::HexDigit))
                     {
-                        consume();
-                        text += current();
+                        mPosition = SkipHexDigits(mText, mPosition + 1) - 1;
                         if (isDigitSep(peek(1)))
                             consume();
                     }
@@ -141,12 +228,10 @@ namespace lexing
                 else if (peek(1) == 'b') // binary
                 {
                     consume();
-                    text += current();
 
                     while (peek(1) == '0' || peek(1) == '1')
                     {
                         consume();
-                        text += current();
                         if (isDigitSep(peek(1)))
                             consume();
                     }
@@ -156,7 +241,6 @@ namespace lexing
                     while (peek(1) >= '0' && peek(1) <= '7')
                     {
                         consume();
-                        text += current();
                         if (isDigitSep(peek(1)))
                             consume();
                     }
@@ -166,109 +250,109 @@ namespace lexing
             {
                 if (isDigitSep(peek(1)))
                     consume();
-                while (std::isdigit(peek(1)))
+                while (CharClass::Is(peek(1), CharClass::Digit))
                 {
-                    consume();
-                    text += current();
+                    mPosition = SkipDigits(mText, mPosition + 1) - 1;
                     if (isDigitSep(peek(1)))
                         consume();
                 }
             }
-            return Token(TokenType::IntegerLiteral, std::move(text), start, location());
+            return token(TokenType::IntegerLiteral, start); // digit separators are skipped by getIntegerValue
         }
         
-        if (std::isspace(current())) // Newline, tab, space etc
+        if (CharClass::Is(current(), CharClass::Space)) // Newline, tab, space etc
         {
+            mPosition = SkipWhitespace(mText, mPosition + 1) - 1;
             return std::nullopt;
         }
 
         switch(current())
         {
             case '(':
-                return Token(TokenType::LeftParen, start, location());
+                return token(TokenType::LeftParen, start);
             case ')':
-                return Token(TokenType::RightParen, start, location());
+                return token(TokenType::RightParen, start);
 
             case '{':
-                return Token(TokenType::LeftBracket, start, location());
+                return token(TokenType::LeftBracket, start);
             case '}':
-                return Token(TokenType::RightBracket, start, location());
+                return token(TokenType::RightBracket, start);
 
             case '[':
                 if (peek(1) == '[')
                 {
                     consume();
-                    return Token(TokenType::DoubleLeftSquareBracket, start, location());
+                    return token(TokenType::DoubleLeftSquareBracket, start);
                 }
-                return Token(TokenType::LeftSquareBracket, start, location());
+                return token(TokenType::LeftSquareBracket, start);
             case ']':
                 if (peek(1) == ']')
                 {
                     consume();
-                    return Token(TokenType::DoubleRightSquareBracket, start, location());
+                    return token(TokenType::DoubleRightSquareBracket, start);
                 }
-                return Token(TokenType::RightSquareBracket, start, location());
+                return token(TokenType::RightSquareBracket, start);
 
             case ';':
-                return Token(TokenType::Semicolon, start, location());
+                return token(TokenType::Semicolon, start);
             case ':':
                 if (peek(1) == ':')
                 {
                     consume();
-                    return Token(TokenType::DoubleColon, start, location());
+                    return token(TokenType::DoubleColon, start);
                 }
-                return Token(TokenType::Colon, start, location());
+                return token(TokenType::Colon, start);
             case ',':
-                return Token(TokenType::Comma, start, location());
+                return token(TokenType::Comma, start);
             case '.':
-                return Token(TokenType::Dot, start, location());
+                return token(TokenType::Dot, start);
 
             case '@':
-                return Token(TokenType::Asperand, start, location());
+                return token(TokenType::Asperand, start);
 
             case '=':
                 if (peek(1) == '=')
                 {
                     consume();
-                    return Token(TokenType::DoubleEquals, start, location());
+                    return token(TokenType::DoubleEquals, start);
                 }
-                return Token(TokenType::Equals, start, location());
+                return token(TokenType::Equals, start);
             
             case '+':
                 if (peek(1) == '=')
                 {
                     consume();
-                    return Token(TokenType::PlusEquals, start, location());
+                    return token(TokenType::PlusEquals, start);
                 }
                 else if (peek(1) == '+')
                 {
                     consume();
-                    return Token(TokenType::DoublePlus, start, location());
+                    return token(TokenType::DoublePlus, start);
                 }
-                return Token(TokenType::Plus, start, location());
+                return token(TokenType::Plus, start);
             case '-':
                 if (peek(1) == '>')
                 {
                     consume();
-                    return Token(TokenType::RightArrow, start, location());
+                    return token(TokenType::RightArrow, start);
                 }
                 else if (peek(1) == '=')
                 {
                     consume();
-                    return Token(TokenType::MinusEquals, start, location());
+                    return token(TokenType::MinusEquals, start);
                 }
                 else if (peek(1) == '-')
                 {
                     consume();
-                    return Token(TokenType::DoubleMinus, start, location());
+                    return token(TokenType::DoubleMinus, start);
                 }
-                return Token(TokenType::Minus, start, location());
+                return token(TokenType::Minus, start);
 
             case '!':
                 if (peek(1) == '=')
                 {
                     consume();
-                    return Token(TokenType::BangEquals, start, location());
+                    return token(TokenType::BangEquals, start);
                 }
                 break;
 
@@ -276,91 +360,77 @@ namespace lexing
                 if (peek(1) == '=')
                 {
                     consume();
-                    return Token(TokenType::LessEqual, start, location());
+                    return token(TokenType::LessEqual, start);
                 }
-                return Token(TokenType::LessThan, start, location());
+                return token(TokenType::LessThan, start);
             case '>':
                 if (peek(1) == '=')
                 {
                     consume();
-                    return Token(TokenType::GreaterEqual, start, location());
+                    return token(TokenType::GreaterEqual, start);
                 }
-                return Token(TokenType::GreaterThan, start, location());
+                return token(TokenType::GreaterThan, start);
 
             case '|':
-                return Token(TokenType::Pipe, start, location());
+                return token(TokenType::Pipe, start);
             case '&':
-                return Token(TokenType::Ampersand, start, location());
+                return token(TokenType::Ampersand, start);
             case '^':
-                return Token(TokenType::Caret, start, location());
+                return token(TokenType::Caret, start);
             case '~':
-                return Token(TokenType::Tilde, start, location());
+                return token(TokenType::Tilde, start);
             case '*':
-                return Token(TokenType::Star, start, location());
+                return token(TokenType::Star, start);
             case '/':
                 if (peek(1) == '/')
                 {
-                    while (current() != '\n')
-                        consume();
+                    mPosition = FindByte(mText, mPosition, '\n');
                     return std::nullopt;
                 }
                 else if (peek(1) == '*')
                 {
-                    consume();
-                    consume();
-                    while (current() != '*' && peek(1) != '/')
-                        consume();
-                    consume();
+                    // Stop on the closing '/', or the last character if the comment is never closed
+                    std::size_t end = mPosition + 2;
+                    do
+                    {
+                        end = FindByte(mText, end, '*') + 1;
+                    } while (end < mText.size() && mText[end] != '/');
+                    mPosition = std::min<std::size_t>(end, mText.size() - 1);
                     return std::nullopt;
                 }
 
-                return Token(lexing::TokenType::Slash, start, location());
+                return token(TokenType::Slash, start);
 
             case '"':
             {
+                // Escapes are only validated here and decoded by Token::getStringValue
                 consume();
-                std::string value;
                 while(current() != '"')
                 {
-                    switch(current())
+                    if (current() == '\\')
                     {
-                        case '\\':
+                        consume();
+                        switch(current())
                         {
-                            consume();
-                            switch(current())
+                            case 'n':
+                            case '\'':
+                            case '\"':
+                            case '\\':
+                            case '0':
+                                break;
+                            default:
                             {
-                                case 'n':
-                                    value += '\n';
-                                    break;
-                                case '\'':
-                                    value += '\'';
-                                    break;
-                                case '\"':
-                                    value += '\"';
-                                    break;
-                                case '\\':
-                                    value += '\\';
-                                    break;
-                                case '0':
-                                    value += '\0';
-                                    break;
-                                default:
-                                {
-                                    mDiag.compilerError(start, location(), std::format("Unknown escape sequence '{}\\{}{}' in string",
-                                        fmt::bold, current(), fmt::defaults));
-                                }
+                                mDiag.compilerError(start, location(), std::format("Unknown escape sequence '{}\\{}{}' in string",
+                                    fmt::bold, current(), fmt::defaults));
                             }
-                            break;
                         }
-                        default:
-                            value += current();
                     }
                     consume();
                 }
-                return Token(TokenType::StringLiteral, value, start, location());
+                return token(TokenType::StringLiteral, start);
             }
         }
 
-        return Token(TokenType::Error, std::string(1, current()), start, location()); // Unknown character
+        return token(TokenType::Error, start); // Unknown character
     }
 }
\ No newline at end of file
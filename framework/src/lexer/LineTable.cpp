@@ -0,0 +1,46 @@
+// Copyright 2024 solar-mist
+
+
+#include "lexer/LineTable.h"
+
+#include <algorithm>
+
+namespace lexing
+{
+    LineTable::LineTable(std::string_view text)
+        : mLineStarts{0}
+        , mSize(static_cast<std::uint32_t>(text.size()))
+    {
+        for (std::uint32_t i = 0; i < mSize; ++i)
+        {
+            if (text[i] == '\n')
+            {
+                mLineStarts.push_back(i + 1);
+            }
+        }
+    }
+
+    int LineTable::getLine(std::uint32_t position) const
+    {
+        return std::upper_bound(mLineStarts.begin(), mLineStarts.end(), position) - mLineStarts.begin();
+    }
+
+    int LineTable::getColumn(std::uint32_t position) const
+    {
+        return position - getLineStart(getLine(position)) + 1;
+    }
+
+    std::uint32_t LineTable::getLineStart(int line) const
+    {
+        return mLineStarts[line - 1];
+    }
+
+    std::uint32_t LineTable::getLineEnd(int line) const
+    {
+        if (line < static_cast<int>(mLineStarts.size()))
+        {
+            return mLineStarts[line] - 1;
+        }
+        return mSize;
+    }
+}
@@ -0,0 +1,229 @@
+// Copyright 2024 solar-mist
+
+
+#include "lexer/Scan.h"
+#include "lexer/CharClass.h"
+
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define VIPER_LEXER_SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+namespace lexing
+{
+    template <std::uint8_t Classes>
+    static std::size_t SkipScalar(std::string_view text, std::size_t position)
+    {
+        while (position < text.size() && CharClass::Is(text[position], Classes))
+        {
+            ++position;
+        }
+        return position;
+    }
+
+    static std::size_t FindByteScalar(std::string_view text, std::size_t position, char c)
+    {
+        std::size_t found = text.find(c, position);
+        return found == std::string_view::npos ? text.size() : found;
+    }
+
+#ifdef VIPER_LEXER_SCAN_X86
+    // Each Match function sets every byte of the result that belongs to the
+    // class to 0xFF. Comparisons are signed, so bytes >= 0x80 never match,
+    // which is also what the CharClass table says
+
+    static inline __m128i InRange128(__m128i chars, char low, char high)
+    {
+        return _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8(low - 1)), _mm_cmpgt_epi8(_mm_set1_epi8(high + 1), chars));
+    }
+
+    static inline __m128i MatchWhitespace128(__m128i chars)
+    {
+        return _mm_or_si128(_mm_cmpeq_epi8(chars, _mm_set1_epi8(' ')), InRange128(chars, '\t', '\r'));
+    }
+
+    static inline __m128i MatchDigit128(__m128i chars)
+    {
+        return InRange128(chars, '0', '9');
+    }
+
+    static inline __m128i MatchHexDigit128(__m128i chars)
+    {
+        __m128i lower = _mm_or_si128(chars, _mm_set1_epi8(0x20));
+        return _mm_or_si128(InRange128(chars, '0', '9'), InRange128(lower, 'a', 'f'));
+    }
+
+    static inline __m128i MatchIdentifier128(__m128i chars)
+    {
+        __m128i lower = _mm_or_si128(chars, _mm_set1_epi8(0x20));
+        __m128i alpha = InRange128(lower, 'a', 'z');
+        __m128i underscore = _mm_cmpeq_epi8(chars, _mm_set1_epi8('_'));
+        return _mm_or_si128(_mm_or_si128(alpha, underscore), InRange128(chars, '0', '9'));
+    }
+
+    template <__m128i(*Match)(__m128i), std::uint8_t Classes>
+    static std::size_t SkipSSE2(std::string_view text, std::size_t position)
+    {
+        while (position + 16 <= text.size())
+        {
+            __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + position));
+            unsigned int mismatches = ~static_cast<unsigned int>(_mm_movemask_epi8(Match(chars))) & 0xFFFF;
+            if (mismatches)
+            {
+                return position + __builtin_ctz(mismatches);
+            }
+            position += 16;
+        }
+        return SkipScalar<Classes>(text, position);
+    }
+
+    static std::size_t FindByteSSE2(std::string_view text, std::size_t position, char c)
+    {
+        __m128i needle = _mm_set1_epi8(c);
+        while (position + 16 <= text.size())
+        {
+            __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + position));
+            unsigned int matches = _mm_movemask_epi8(_mm_cmpeq_epi8(chars, needle));
+            if (matches)
+            {
+                return position + __builtin_ctz(matches);
+            }
+            position += 16;
+        }
+        return FindByteScalar(text, position, c);
+    }
+
+
+    __attribute__((target("avx2"))) static inline __m256i InRange256(__m256i chars, char low, char high)
+    {
+        return _mm256_and_si256(_mm256_cmpgt_epi8(chars, _mm256_set1_epi8(low - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8(high + 1), chars));
+    }
+
+    __attribute__((target("avx2"))) static inline __m256i MatchWhitespace256(__m256i chars)
+    {
+        return _mm256_or_si256(_mm256_cmpeq_epi8(chars, _mm256_set1_epi8(' ')), InRange256(chars, '\t', '\r'));
+    }
+
+    __attribute__((target("avx2"))) static inline __m256i MatchDigit256(__m256i chars)
+    {
+        return InRange256(chars, '0', '9');
+    }
+
+    __attribute__((target("avx2"))) static inline __m256i MatchHexDigit256(__m256i chars)
+    {
+        __m256i lower = _mm256_or_si256(chars, _mm256_set1_epi8(0x20));
+        return _mm256_or_si256(InRange256(chars, '0', '9'), InRange256(lower, 'a', 'f'));
+    }
+
+    __attribute__((target("avx2"))) static inline __m256i MatchIdentifier256(__m256i chars)
+    {
+        __m256i lower = _mm256_or_si256(chars, _mm256_set1_epi8(0x20));
+        __m256i alpha = InRange256(lower, 'a', 'z');
+        __m256i underscore = _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('_'));
+        return _mm256_or_si256(_mm256_or_si256(alpha, underscore), InRange256(chars, '0', '9'));
+    }
+
+    template <__m256i(*Match)(__m256i), std::uint8_t Classes>
+    __attribute__((target("avx2"))) static std::size_t SkipAVX2(std::string_view text, std::size_t position)
+    {
+        while (position + 32 <= text.size())
+        {
+            __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text.data() + position));
+            unsigned int mismatches = ~static_cast<unsigned int>(_mm256_movemask_epi8(Match(chars)));
+            if (mismatches)
+            {
+                return position + __builtin_ctz(mismatches);
+            }
+            position += 32;
+        }
+        return SkipScalar<Classes>(text, position);
+    }
+
+    __attribute__((target("avx2"))) static std::size_t FindByteAVX2(std::string_view text, std::size_t position, char c)
+    {
+        __m256i needle = _mm256_set1_epi8(c);
+        while (position + 32 <= text.size())
+        {
+            __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text.data() + position));
+            unsigned int matches = _mm256_movemask_epi8(_mm256_cmpeq_epi8(chars, needle));
+            if (matches)
+            {
+                return position + __builtin_ctz(matches);
+            }
+            position += 32;
+        }
+        return FindByteScalar(text, position, c);
+    }
+#endif
+
+    std::vector<ScanKernels> GetAvailableKernels()
+    {
+        std::vector<ScanKernels> kernels;
+        kernels.push_back({
+            "scalar",
+            SkipScalar<CharClass::Space>,
+            SkipScalar<CharClass::IdentifierPart>,
+            SkipScalar<CharClass::Digit>,
+            SkipScalar<CharClass::HexDigit>,
+            FindByteScalar,
+        });
+#ifdef VIPER_LEXER_SCAN_X86
+        if (__builtin_cpu_supports("sse2"))
+        {
+            kernels.push_back({
+                "SSE2",
+                SkipSSE2<MatchWhitespace128, CharClass::Space>,
+                SkipSSE2<MatchIdentifier128, CharClass::IdentifierPart>,
+                SkipSSE2<MatchDigit128, CharClass::Digit>,
+                SkipSSE2<MatchHexDigit128, CharClass::HexDigit>,
+                FindByteSSE2,
+            });
+        }
+        if (__builtin_cpu_supports("avx2"))
+        {
+            kernels.push_back({
+                "AVX2",
+                SkipAVX2<MatchWhitespace256, CharClass::Space>,
+                SkipAVX2<MatchIdentifier256, CharClass::IdentifierPart>,
+                SkipAVX2<MatchDigit256, CharClass::Digit>,
+                SkipAVX2<MatchHexDigit256, CharClass::HexDigit>,
+                FindByteAVX2,
+            });
+        }
+#endif
+        return kernels;
+    }
+
+    static const ScanKernels& GetKernels()
+    {
+        static const ScanKernels kernels = GetAvailableKernels().back();
+        return kernels;
+    }
+
+    std::size_t SkipWhitespace(std::string_view text, std::size_t position)
+    {
+        return GetKernels().skipWhitespace(text, position);
+    }
+
+    std::size_t SkipIdentifier(std::string_view text, std::size_t position)
+    {
+        return GetKernels().skipIdentifier(text, position);
+    }
+
+    std::size_t SkipDigits(std::string_view text, std::size_t position)
+    {
+        return GetKernels().skipDigits(text, position);
+    }
+
+    std::size_t SkipHexDigits(std::string_view text, std::size_t position)
+    {
+        return GetKernels().skipHexDigits(text, position);
+    }
+
+    std::size_t FindByte(std::string_view text, std::size_t position, char c)
+    {
+        return GetKernels().findByte(text, position, c);
+    }
+}
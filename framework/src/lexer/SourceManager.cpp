@@ -0,0 +1,63 @@
+// Copyright 2024 solar-mist
+
+
+#include "lexer/SourceManager.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace lexing
+{
+    SourceManager::~SourceManager()
+    {
+        for (auto& source : mSources)
+        {
+            munmap(source.data, source.mappedSize);
+        }
+    }
+
+    std::optional<std::string_view> SourceManager::load(const std::filesystem::path& path)
+    {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd == -1) return std::nullopt;
+
+        struct stat st;
+        if (fstat(fd, &st) == -1 || !S_ISREG(st.st_mode))
+        {
+            close(fd);
+            return std::nullopt;
+        }
+        std::size_t size = st.st_size;
+
+        // Reserve zeroed memory one byte larger than the file (plus a trailing
+        // NUL for the lexer's one-past-the-end peek) and map the file over the
+        // front of it. The sentinel then lands either in the anonymous tail or
+        // in the private copy of the file's last page, so the text is never copied
+        std::size_t mappedSize = size + 2;
+        void* memory = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED)
+        {
+            close(fd);
+            return std::nullopt;
+        }
+
+        if (size != 0 && mmap(memory, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED)
+        {
+            munmap(memory, mappedSize);
+            close(fd);
+            return std::nullopt;
+        }
+        close(fd);
+
+        char* data = static_cast<char*>(memory);
+        data[size] = '\n';
+        data[size + 1] = '\0';
+        mprotect(memory, mappedSize, PROT_READ);
+
+        mSources.push_back({data, mappedSize});
+
+        return std::string_view(data, size + 1);
+    }
+}
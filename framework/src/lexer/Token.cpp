@@ -7,19 +7,16 @@
 
 namespace lexing
 {
-    Token::Token(const TokenType tokenType, std::string text, SourceLocation start, SourceLocation end)
+    Token::Token(const TokenType tokenType, std::string_view text, std::uint32_t offset, Atom atom)
         : mTokenType(tokenType)
-        , mText(std::move(text))
-        , mStart(start)
-        , mEnd(end)
+        , mText(text)
+        , mOffset(offset)
+        , mAtom(atom)
     {
     }
 
-    Token::Token(const TokenType tokenType, SourceLocation start, SourceLocation end)
+    Token::Token(const TokenType tokenType)
         : mTokenType(tokenType)
-        , mText("")
-        , mStart(start)
-        , mEnd(end)
     {
     }
 
@@ -158,23 +155,102 @@ namespace lexing
                 return "sizeof";
             case TokenType::EnumKeyword:
                 return "enum";
+            case TokenType::EndOfFile:
+                return "end of file";
             case TokenType::Error:
-                return mText;
+                return std::string(mText);
         }
     }
 
-    const std::string& Token::getText() const
+    std::string_view Token::getText() const
     {
         return mText;
     }
 
-    SourceLocation Token::getStart()
+    Atom Token::getAtom() const
     {
-        return mStart;
+        return mAtom;
     }
-    SourceLocation Token::getEnd()
+
+    unsigned long long Token::getIntegerValue() const
     {
-        return mEnd;
+        unsigned long long base = 10;
+        std::string_view digits = mText;
+        if (digits.size() > 1 && digits[0] == '0')
+        {
+            if (digits[1] == 'x')
+            {
+                base = 16;
+                digits.remove_prefix(2);
+            }
+            else if (digits[1] == 'b')
+            {
+                base = 2;
+                digits.remove_prefix(2);
+            }
+            else
+            {
+                base = 8;
+                digits.remove_prefix(1);
+            }
+        }
+
+        unsigned long long value = 0;
+        for (char c : digits)
+        {
+            if (c == '_') // digit separator
+                continue;
+
+            unsigned long long digit;
+            if (c >= '0' && c <= '9')
+                digit = c - '0';
+            else if (c >= 'a' && c <= 'f')
+                digit = c - 'a' + 10;
+            else
+                digit = c - 'A' + 10;
+
+            value = value * base + digit;
+        }
+        return value;
+    }
+
+    std::string Token::getStringValue() const
+    {
+        // Escape sequences have already been validated by the lexer
+        std::string_view text = mText.substr(1, mText.size() - 2); // strip the quotes
+        std::string value;
+        value.reserve(text.size());
+        for (std::size_t i = 0; i < text.size(); ++i)
+        {
+            if (text[i] != '\\')
+            {
+                value += text[i];
+                continue;
+            }
+
+            switch (text[++i])
+            {
+                case 'n':
+                    value += '\n';
+                    break;
+                case '0':
+                    value += '\0';
+                    break;
+                default: // \' \" and \\ stand for themselves
+                    value += text[i];
+                    break;
+            }
+        }
+        return value;
+    }
+
+    SourceLocation Token::getStart() const
+    {
+        return { mOffset };
+    }
+    SourceLocation Token::getEnd() const
+    {
+        return { mText.empty() ? mOffset : mOffset + static_cast<std::uint32_t>(mText.size()) - 1 };
     }
 
     static inline const char* TypeToString(TokenType tokenType)
@@ -183,6 +259,8 @@ namespace lexing
         {
             case TokenType::Error:
                 return "Error";
+            case TokenType::EndOfFile:
+                return "EndOfFile";
 
             case TokenType::Identifier:
                 return "Identifier";
@@ -259,8 +337,14 @@ namespace lexing
         return std::format("{}({})", TypeToString(mTokenType), mText);
     }
 
-    bool Token::operator==(Token other)
+    bool Token::operator==(const Token& other) const
     {
-        return ((mText == other.mText) && (mTokenType == other.mTokenType));
+        if (mTokenType != other.mTokenType)
+            return false;
+
+        if (mAtom != NoAtom || other.mAtom != NoAtom)
+            return mAtom == other.mAtom;
+
+        return mText == other.mText;
     }
 }
\ No newline at end of file
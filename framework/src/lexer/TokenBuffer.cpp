@@ -0,0 +1,125 @@
+// Copyright 2024 solar-mist
+
+
+#include "lexer/TokenBuffer.h"
+#include "lexer/Lexer.h"
+
+#include <stdexcept>
+
+namespace lexing
+{
+    TokenBuffer::TokenBuffer(Lexer& lexer)
+        : mLexer(lexer)
+        , mRing(4)
+        , mFirst(0)
+        , mCount(0)
+        , mPosition(0)
+    {
+    }
+
+    const Token& TokenBuffer::peek(int offset)
+    {
+        if (offset < 0 && static_cast<std::size_t>(-offset) > mPosition)
+        {
+            throw std::out_of_range("TokenBuffer::peek");
+        }
+
+        std::size_t index = mPosition + offset;
+        fill(index);
+        return at(index);
+    }
+
+    Token TokenBuffer::consume()
+    {
+        Token token = peek(0);
+        if (token.getTokenType() != TokenType::EndOfFile)
+        {
+            ++mPosition;
+        }
+        return token;
+    }
+
+    void TokenBuffer::insert(const Token& token)
+    {
+        fill(mPosition);
+        makeRoom();
+
+        for (std::size_t index = mFirst + mCount; index > mPosition; --index)
+        {
+            at(index) = at(index - 1);
+        }
+        at(mPosition) = token;
+        ++mCount;
+    }
+
+    void TokenBuffer::mark()
+    {
+        mMarks.push_back(mPosition);
+    }
+
+    void TokenBuffer::rewind()
+    {
+        mPosition = mMarks.back();
+        mMarks.pop_back();
+    }
+
+    void TokenBuffer::unmark()
+    {
+        mMarks.pop_back();
+    }
+
+    void TokenBuffer::seek(std::uint32_t offset)
+    {
+        mLexer.seek(offset);
+        mFirst = 0;
+        mCount = 0;
+        mPosition = 0;
+        mMarks.clear();
+    }
+
+
+    Token& TokenBuffer::at(std::size_t index)
+    {
+        return mRing[index & (mRing.size() - 1)];
+    }
+
+    void TokenBuffer::fill(std::size_t index)
+    {
+        while (mFirst + mCount <= index)
+        {
+            makeRoom();
+            at(mFirst + mCount) = mLexer.next();
+            ++mCount;
+        }
+    }
+
+    // Make space for one more token, either by dropping the oldest one if
+    // peek() and the marks can no longer reach it or by doubling the ring
+    void TokenBuffer::makeRoom()
+    {
+        if (mCount < mRing.size())
+        {
+            return;
+        }
+
+        std::size_t keepFrom = mPosition < Lookbehind ? 0 : mPosition - Lookbehind;
+        if (!mMarks.empty() && mMarks.front() < keepFrom)
+        {
+            keepFrom = mMarks.front();
+        }
+
+        if (mFirst < keepFrom)
+        {
+            ++mFirst;
+            --mCount;
+            return;
+        }
+
+        std::vector<Token> ring(mRing.size() * 2);
+        for (std::size_t index = mFirst; index < mFirst + mCount; ++index)
+        {
+            ring[index & (ring.size() - 1)] = at(index);
+        }
+        mRing = std::move(ring);
+    }
+}
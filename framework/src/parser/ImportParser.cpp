@@ -4,6 +4,8 @@
 #include "parser/ImportParser.h"
 #include "parser/Parser.h"
 
+#include "context/CompilerContext.h"
+
 #include "lexer/Token.h"
 
 #include "symbol/Identifier.h"
@@ -19,36 +21,39 @@
 
 namespace parser
 {
-    ImportParser::ImportParser(std::vector<lexing::Token>& tokens, diagnostic::Diagnostics& diag, symbol::ImportManager& importManager, bool hoistingParser)
-        : mTokens(tokens)
+    ImportParser::ImportParser(lexing::Lexer& lexer, diagnostic::Diagnostics& diag, symbol::ImportManager& importManager, CompilerContext& context)
+        : mTokens(lexer)
         , mImportManager(importManager)
-        , mPosition(0)
+        , mContext(context)
         , mScope(nullptr)
         , mDiag(diag)
-        , mHoistingParser(hoistingParser)
     {
     }
 
-    lexing::Token ImportParser::current() const
+    lexing::Token ImportParser::current()
     {
-        return mTokens.at(mPosition);
+        return mTokens.peek(0);
     }
 
     lexing::Token ImportParser::consume()
     {
-        return mTokens.at(mPosition++);
+        if (current().getTokenType() == lexing::TokenType::EndOfFile)
+        {
+            mDiag.compilerError(current().getStart(), current().getEnd(), "unexpected end of file");
+        }
+        return mTokens.consume();
     }
 
-    lexing::Token ImportParser::peek(int offset) const
+    lexing::Token ImportParser::peek(int offset)
     {
-        return mTokens.at(mPosition + offset);
+        return mTokens.peek(offset);
     }
 
     void ImportParser::expectToken(lexing::TokenType tokenType)
     {
         if (current().getTokenType() != tokenType)
         {
-            lexing::Token temp(tokenType, {0, 0}, {0, 0});
+            lexing::Token temp(tokenType);
             mDiag.compilerError(current().getStart(), current().getEnd(), std::format("expected '{}{}{}' before '{}{}{}' token",
                 fmt::bold, temp.getId(), fmt::defaults, fmt::bold, current().getId(), fmt::defaults));
         }
@@ -62,7 +67,7 @@ namespace parser
             if (current().getTokenType() == tokenType)
                 return;
 
-            lexing::Token temp(tokenType, {0, 0}, {0, 0});
+            lexing::Token temp(tokenType);
             tokensString += std::format("'{}{}{}', ", fmt::bold, temp.getId(), fmt::defaults);
         }
 
@@ -76,7 +81,7 @@ namespace parser
     {
         std::vector<ASTNodePtr> result;
 
-        while (mPosition < mTokens.size())
+        while (current().getTokenType() != lexing::TokenType::EndOfFile)
         {
             auto node = parseGlobal(result);
             if (node)
@@ -86,7 +91,7 @@ namespace parser
         }
         for (auto type : mStructTypesToRemove)
         {
-            StructType::Erase(type);
+            StructType::Erase(mContext, type);
         }
 
         return result;
@@ -100,24 +105,32 @@ namespace parser
     ASTNodePtr ImportParser::parseGlobal(std::vector<ASTNodePtr>& nodes)
     {
         std::vector<GlobalAttribute> attributes;
+        lexing::Token attributesToken = current();
         if (current().getTokenType() == lexing::TokenType::DoubleLeftSquareBracket)
         {
             parseAttributes(attributes);
         }
 
-        bool exported = mHoistingParser;
+        bool exported = false;
         if (current().getTokenType() == lexing::TokenType::ExportKeyword)
         {
             exported = true;
             consume();
         }
 
+        bool isStruct = current().getTokenType() == lexing::TokenType::StructKeyword
+            || (current().getTokenType() == lexing::TokenType::UsingKeyword && peek(1).getTokenType() == lexing::TokenType::StructKeyword);
+        if (!isStruct)
+        {
+            GlobalAttribute::RejectLayoutAttributes(attributes, attributesToken, mDiag);
+        }
+
         switch (current().getTokenType())
         {
             case lexing::TokenType::FuncKeyword:
                 return parseFunction(exported, attributes);
             case lexing::TokenType::StructKeyword:
-                return parseStructDeclaration(exported);
+                return parseStructDeclaration(exported, attributes);
             case lexing::TokenType::GlobalKeyword:
                 return parseGlobalDeclaration(exported);
             case lexing::TokenType::ConstexprKeyword:
@@ -135,9 +148,9 @@ namespace parser
                 if (peek(1).getTokenType() == lexing::TokenType::StructKeyword)
                 {
                     consume();
-                    StructDeclarationPtr structDecl = parseStructDeclaration(exported);
+                    StructDeclarationPtr structDecl = parseStructDeclaration(exported, attributes);
                     if (exported)
-                        Type::AddAlias(structDecl->getNames(), structDecl->getType());
+                        Type::AddAlias(mContext, structDecl->getNames(), structDecl->getType());
                     return structDecl;
                 }
                 return parseUsingDeclaration(exported);
@@ -159,17 +172,17 @@ namespace parser
             expectToken(lexing::TokenType::Identifier);
             while (current().getTokenType() == lexing::TokenType::Identifier)
             {
-                names.push_back(consume().getText());
+                names.emplace_back(consume().getText());
                 if (peek(1).getTokenType() == lexing::TokenType::Identifier)
                 {
                     expectToken(lexing::TokenType::DoubleColon);
                     consume();
                 }
             }
-            std::vector<std::string> types = symbol::GetSymbol(names, mNamespaces);
+            std::vector<std::string> types = symbol::GetSymbol(mContext, names, mNamespaces);
             for (auto& name : types)
             {
-                type = StructType::Get(name);
+                type = StructType::Get(mContext, name);
                 if (type) break;
             }
             if (!type)
@@ -182,13 +195,13 @@ namespace parser
             std::vector<std::string> names;
             if (current().getTokenType() == lexing::TokenType::Type)
             {
-                names.push_back(consume().getText());
+                names.emplace_back(consume().getText());
             }
             else
             {
                 while (current().getTokenType() == lexing::TokenType::Identifier)
                 {
-                    names.push_back(consume().getText());
+                    names.emplace_back(consume().getText());
                     if (peek(1).getTokenType() == lexing::TokenType::Identifier)
                     {
                         expectToken(lexing::TokenType::DoubleColon);
@@ -197,17 +210,17 @@ namespace parser
                 }
             }
 
-            std::vector<std::string> types = symbol::GetSymbol(names, mNamespaces);
+            std::vector<std::string> types = symbol::GetSymbol(mContext, names, mNamespaces);
 
             lexing::Token token = peek(-1);
             for (auto& name : types)
             {
-                type = Type::Get(name);
+                type = Type::Get(mContext, name);
                 if (type) break;
             }
             if (!type)
             {
-                type = Type::Get(names.front());
+                type = Type::Get(mContext, names.front());
 
                 if (!type)
                     mDiag.compilerError(token.getStart(), token.getEnd(), std::format("unknown type name '{}{}{}'", fmt::bold, token.getText(), fmt::defaults));
@@ -219,16 +232,16 @@ namespace parser
             if (current().getTokenType() == lexing::TokenType::Star)
             {
                 consume();
-                type = PointerType::Create(type);
+                type = PointerType::Create(mContext, type);
             }
             else
             {
                 consume();
                 expectToken(lexing::TokenType::IntegerLiteral);
-                int count = std::stoi(consume().getText(), 0, 0);
+                int count = consume().getIntegerValue();
                 expectToken(lexing::TokenType::RightSquareBracket);
                 consume();
-                type = ArrayType::Create(type, count);
+                type = ArrayType::Create(mContext, type, count);
             }
         }
 
@@ -243,7 +256,7 @@ namespace parser
         consume();
 
         expectToken(lexing::TokenType::Identifier);
-        std::string name = consume().getText();
+        std::string name(consume().getText());
 
         expectToken(lexing::TokenType::LeftParen);
         consume();
@@ -253,7 +266,7 @@ namespace parser
         while (current().getTokenType() != lexing::TokenType::RightParen)
         {
             expectToken(lexing::TokenType::Identifier);
-            std::string name = consume().getText();
+            std::string name(consume().getText());
 
             expectToken(lexing::TokenType::Colon);
             consume();
@@ -269,7 +282,7 @@ namespace parser
         }
         consume();
 
-        Type* returnType = Type::Get("void");
+        Type* returnType = Type::GetVoidType(mContext);
         if (current().getTokenType() == lexing::TokenType::RightArrow)
         {
             consume();
@@ -281,13 +294,13 @@ namespace parser
         {
             argumentTypes.push_back(argument.type);
         }
-        Type* type = FunctionType::Create(returnType, std::move(argumentTypes));
+        Type* type = FunctionType::Create(mContext, returnType, std::move(argumentTypes));
 
         if (current().getTokenType() == lexing::TokenType::Semicolon) // Extern function declaration
         {
             consume();
             if (exported)
-                return std::make_unique<Function>(std::move(attributes), type, std::move(arguments), std::move(name), std::vector<ASTNodePtr>(), nullptr);
+                return mContext.astArena.create<Function>(std::move(attributes), type, std::move(arguments), std::move(name), std::vector<ASTNodePtr>(), nullptr);
             return nullptr;
         }
 
@@ -318,7 +331,7 @@ namespace parser
         if (exported)
         {
             mSymbols.push_back({name, type});
-            return std::make_unique<Function>(std::move(attributes), type, std::move(arguments), std::move(name), std::vector<ASTNodePtr>(), nullptr);
+            return mContext.astArena.create<Function>(std::move(attributes), type, std::move(arguments), std::move(name), std::vector<ASTNodePtr>(), nullptr);
         }
         return nullptr;
     }
@@ -328,13 +341,13 @@ namespace parser
         consume(); // namespace
 
         expectToken(lexing::TokenType::Identifier);
-        std::string name = consume().getText();
+        std::string name(consume().getText());
         mNamespaces.push_back(name);
 
         expectToken(lexing::TokenType::LeftBracket);
         consume();
 
-        Scope* scope = new Scope(mScope, nullptr);
+        Scope* scope = new Scope(mContext, mScope, name);
         mScope = scope;
         
         std::vector<ASTNodePtr> body;
@@ -352,28 +365,51 @@ namespace parser
         mNamespaces.pop_back();
 
         mSymbols.push_back({name, nullptr});
-        return std::make_unique<Namespace>(std::move(name), std::move(body), scope);
+        return mContext.astArena.create<Namespace>(std::move(name), std::move(body), scope);
     }
 
-    StructDeclarationPtr ImportParser::parseStructDeclaration(bool exported)
+    StructDeclarationPtr ImportParser::parseStructDeclaration(bool exported, std::vector<GlobalAttribute> attributes)
     {
         consume(); // struct
 
         expectToken(lexing::TokenType::Identifier);
-        std::string name = consume().getText();
+        std::string name(consume().getText());
         std::vector<std::string> names = mNamespaces;
         names.push_back(name);
 
         expectToken(lexing::TokenType::LeftBracket);
         consume();
 
-        StructType* structType = StructType::Create(names, {});
+        StructType* structType = StructType::Create(mContext, names, {});
+        // In a whole-program build a file can be imported by another input
+        // before it's parsed itself, in which case the fields are there already
+        bool defined = structType->isComplete();
+
+        for (auto& attribute : attributes)
+        {
+            if (attribute.getType() == GlobalAttributeType::Align)
+            {
+                structType->setAlignment(static_cast<int>(attribute.getValue()) * 8);
+            }
+            else if (attribute.getType() == GlobalAttributeType::Reorder)
+            {
+                structType->setReordered(true);
+            }
+        }
 
-        std::vector<StructType::Field>& fieldTypes = structType->getFields();
         std::vector<StructField> fields;
         std::vector<StructMethod> methods;
         while (current().getTokenType() != lexing::TokenType::RightBracket)
         {
+            std::vector<GlobalAttribute> methodAttributes;
+            if (current().getTokenType() == lexing::TokenType::DoubleLeftSquareBracket)
+            {
+                lexing::Token attributesToken = current();
+                parseAttributes(methodAttributes);
+                GlobalAttribute::RejectLayoutAttributes(methodAttributes, attributesToken, mDiag);
+                expectEitherToken({ lexing::TokenType::PrivateKeyword, lexing::TokenType::FuncKeyword });
+            }
+
             bool priv = false;
             if (current().getTokenType() == lexing::TokenType::PrivateKeyword)
             {
@@ -388,7 +424,7 @@ namespace parser
                 consume();
 
                 expectToken(lexing::TokenType::Identifier);
-                std::string name = consume().getText();
+                std::string name(consume().getText());
 
                 expectToken(lexing::TokenType::LeftParen);
                 consume();
@@ -397,7 +433,7 @@ namespace parser
                 while (current().getTokenType() != lexing::TokenType::RightParen)
                 {
                     expectToken(lexing::TokenType::Identifier);
-                    std::string name = consume().getText();
+                    std::string name(consume().getText());
 
                     expectToken(lexing::TokenType::Colon);
                     consume();
@@ -413,19 +449,19 @@ namespace parser
                 }
                 consume();
 
-                Type* returnType = Type::Get("void");
+                Type* returnType = Type::GetVoidType(mContext);
                 if (current().getTokenType() == lexing::TokenType::RightArrow)
                 {
                     consume();
                     returnType = parseType();
                 }
 
-                std::vector<Type*> argumentTypes { PointerType::Create(structType) };
+                std::vector<Type*> argumentTypes { PointerType::Create(mContext, structType) };
                 for (auto& argument : arguments)
                 {
                     argumentTypes.push_back(argument.type);
                 }
-                Type* type = FunctionType::Create(returnType, std::move(argumentTypes));
+                Type* type = FunctionType::Create(mContext, returnType, std::move(argumentTypes));
 
                 if (current().getTokenType() == lexing::TokenType::Semicolon)
                 {
@@ -463,14 +499,17 @@ namespace parser
             else
             {
                 expectToken(lexing::TokenType::Identifier);
-                std::string name = consume().getText();
+                std::string name(consume().getText());
 
                 expectToken(lexing::TokenType::Colon);
                 consume();
 
                 Type* type = parseType();
 
-                fieldTypes.push_back({priv, name, type});
+                if (!defined)
+                {
+                    structType->addField({priv, name, type});
+                }
                 fields.push_back({priv, std::move(name), type});
 
                 expectToken(lexing::TokenType::Semicolon);
@@ -478,8 +517,9 @@ namespace parser
             }
         }
         consume();
+        structType->complete();
 
-        auto decl = std::make_unique<StructDeclaration>(std::move(names), std::move(fields), std::move(methods), structType);
+        auto decl = mContext.astArena.create<StructDeclaration>(mContext, std::move(names), std::move(fields), std::move(methods), structType);
         if (!exported)
             mStructTypesToRemove.push_back(decl->getType());
         return std::move(decl);
@@ -491,7 +531,7 @@ namespace parser
 
         expectToken(lexing::TokenType::Identifier);
         std::vector<std::string> names = mNamespaces;
-        names.push_back(consume().getText());
+        names.emplace_back(consume().getText());
 
         expectToken(lexing::TokenType::Colon);
         consume();
@@ -510,7 +550,7 @@ namespace parser
         if (exported)
         {
             mSymbols.push_back({names.back(), type});
-            return std::make_unique<GlobalDeclaration>(std::move(names), type, nullptr); // TODO: Extern
+            return mContext.astArena.create<GlobalDeclaration>(mContext, std::move(names), type, nullptr); // TODO: Extern
         }
         return nullptr;
     }
@@ -522,7 +562,7 @@ namespace parser
         expectToken(lexing::TokenType::Identifier);
         lexing::Token token = current();
         std::vector<std::string> names = mNamespaces;
-        names.push_back(consume().getText());
+        names.emplace_back(consume().getText());
 
         expectToken(lexing::TokenType::Colon);
         consume();
@@ -541,7 +581,7 @@ namespace parser
         if (exported)
         {
             mSymbols.push_back({names.back(), type});
-            return std::make_unique<ConstexprStatement>(type, std::move(names), nullptr, token, true);
+            return mContext.astArena.create<ConstexprStatement>(mContext, type, std::move(names), nullptr, token, true, nullptr);
         }
         return nullptr;
     }
@@ -576,7 +616,7 @@ namespace parser
         consume(); // using
 
         std::vector<std::string> names = mNamespaces;
-        names.push_back(consume().getText());
+        names.emplace_back(consume().getText());
 
         expectToken(lexing::TokenType::Equals);
         consume();
@@ -587,7 +627,7 @@ namespace parser
         consume();
 
         if (exported)
-            return std::make_unique<UsingDeclaration>(std::move(names), type);
+            return mContext.astArena.create<UsingDeclaration>(mContext, std::move(names), type);
 
         return nullptr;
     }
@@ -599,7 +639,7 @@ namespace parser
         consume(); // enum
 
         std::vector<std::string> names = mNamespaces;
-        names.push_back(consume().getText());
+        names.emplace_back(consume().getText());
 
         expectToken(lexing::TokenType::LeftBracket);
         consume();
@@ -609,13 +649,13 @@ namespace parser
         while (current().getTokenType() != lexing::TokenType::RightBracket)
         {
             expectToken(lexing::TokenType::Identifier);
-            std::string name = consume().getText();
+            std::string name(consume().getText());
 
             if (current().getTokenType() == lexing::TokenType::Equals)
             {
                 consume();
                 expectToken(lexing::TokenType::IntegerLiteral);
-                currentValue = std::stoi(consume().getText(), 0, 0);
+                currentValue = consume().getIntegerValue();
             }
 
             fields.push_back({std::move(name), currentValue++});
@@ -635,7 +675,7 @@ namespace parser
             {
                 mSymbols.push_back({field.name, nullptr});
             }
-            return std::make_unique<EnumDeclaration>(std::move(attributes), std::move(names), std::move(fields));
+            return mContext.astArena.create<EnumDeclaration>(mContext, std::move(attributes), std::move(names), std::move(fields));
         }
         return nullptr;
     }
@@ -656,6 +696,33 @@ namespace parser
             {
                 attributes.push_back(GlobalAttribute(GlobalAttributeType::GenerateNames));
             }
+            else if (token.getText() == "Align")
+            {
+                expectToken(lexing::TokenType::LeftParen);
+                consume();
+
+                expectToken(lexing::TokenType::IntegerLiteral);
+                lexing::Token valueToken = consume();
+                unsigned long long alignment = valueToken.getIntegerValue();
+                GlobalAttribute::CheckAlignment(alignment, valueToken, mDiag);
+
+                expectToken(lexing::TokenType::RightParen);
+                consume();
+
+                attributes.push_back(GlobalAttribute(GlobalAttributeType::Align, alignment));
+            }
+            else if (token.getText() == "Reorder")
+            {
+                attributes.push_back(GlobalAttribute(GlobalAttributeType::Reorder));
+            }
+            else if (token.getText() == "Inline")
+            {
+                attributes.push_back(GlobalAttribute(GlobalAttributeType::Inline));
+            }
+            else if (token.getText() == "NoInline")
+            {
+                attributes.push_back(GlobalAttribute(GlobalAttributeType::NoInline));
+            }
             else
             {
                 mDiag.compilerError(token.getStart(), token.getEnd(), std::format("unknown attribute '{}{}{}'", fmt::bold, token.getText(), fmt::defaults));
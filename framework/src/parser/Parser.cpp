@@ -12,6 +12,8 @@
 #include "parser/ast/statement/BreakStatement.h"
 #include "parser/ast/statement/ContinueStatement.h"
 
+#include "context/CompilerContext.h"
+
 #include "lexer/Token.h"
 
 #include "symbol/Identifier.h"
@@ -25,39 +27,41 @@
 #include <filesystem>
 #include <format>
 
-#include "parser/ImportParser.h"
-
 namespace parser
 {
-    Parser::Parser(std::vector<lexing::Token>& tokens, diagnostic::Diagnostics& diag, symbol::ImportManager& importManager)
-        : mTokens(tokens)
+    Parser::Parser(lexing::Lexer& lexer, diagnostic::Diagnostics& diag, symbol::ImportManager& importManager, CompilerContext& context)
+        : mTokens(lexer)
         , mImportManager(importManager)
-        , mPosition(0)
+        , mContext(context)
         , mScope(nullptr)
         , mDiag(diag)
     {
     }
 
-    lexing::Token Parser::current() const
+    lexing::Token Parser::current()
     {
-        return mTokens.at(mPosition);
+        return mTokens.peek(0);
     }
 
     lexing::Token Parser::consume()
     {
-        return mTokens.at(mPosition++);
+        if (current().getTokenType() == lexing::TokenType::EndOfFile)
+        {
+            mDiag.compilerError(current().getStart(), current().getEnd(), "unexpected end of file");
+        }
+        return mTokens.consume();
     }
 
-    lexing::Token Parser::peek(int offset) const
+    lexing::Token Parser::peek(int offset)
     {
-        return mTokens.at(mPosition + offset);
+        return mTokens.peek(offset);
     }
 
     void Parser::expectToken(lexing::TokenType tokenType)
     {
         if (current().getTokenType() != tokenType)
         {
-            lexing::Token temp(tokenType, {0, 0}, {0, 0});
+            lexing::Token temp(tokenType);
             mDiag.compilerError(current().getStart(), current().getEnd(), std::format("expected '{}{}{}' before '{}{}{}' token",
                 fmt::bold, temp.getId(), fmt::defaults, fmt::bold, current().getId(), fmt::defaults));
         }
@@ -71,7 +75,7 @@ namespace parser
             if (current().getTokenType() == tokenType)
                 return;
 
-            lexing::Token temp(tokenType, {0, 0}, {0, 0});
+            lexing::Token temp(tokenType);
             tokensString += std::format("'{}{}{}', ", fmt::bold, temp.getId(), fmt::defaults);
         }
 
@@ -85,50 +89,135 @@ namespace parser
     {
         std::vector<ASTNodePtr> result;
 
-        auto tokensCopy = mTokens;
+        while (current().getTokenType() != lexing::TokenType::EndOfFile)
+        {
+            auto node = parseGlobal();
+            if (node)
+            {
+                result.push_back(std::move(node));
+            }
+        }
 
-        ImportParser hoistingParser(tokensCopy, mDiag, mImportManager, true);
+        for (auto& deferred : mDeferredBodies)
+        {
+            parseBody(deferred);
+        }
 
-        auto nodes = hoistingParser.parse();
-        auto symbols = hoistingParser.getSymbols();
+        if (!mForwardStructs.empty())
+        {
+            lexing::Token& token = mForwardStructs.front().token;
+            mDiag.compilerError(token.getStart(), token.getEnd(), std::format("unknown type name '{}{}{}'", fmt::bold, token.getText(), fmt::defaults));
+        }
+
+        std::move(result.begin(), result.end(), std::back_inserter(mDeclarations));
+        return std::move(mDeclarations);
+    }
 
-        std::move(nodes.begin(), nodes.end(), std::back_inserter(result));
-        std::move(symbols.begin(), symbols.end(), std::back_inserter(mSymbols));
+    // Steps over a body without parsing it, stopping after its closing
+    // bracket, or its semicolon if it's expression bodied
+    std::uint32_t Parser::skipBody(bool expressionBodied)
+    {
+        std::uint32_t offset = current().getStart().position;
 
-        while (mPosition < mTokens.size())
+        int bracketCount = 0;
+        while (true)
         {
-            auto node = parseGlobal(result);
-            if (node)
+            lexing::TokenType tokenType = consume().getTokenType();
+
+            if (tokenType == lexing::TokenType::LeftBracket)
             {
-                result.push_back(std::move(node));
+                bracketCount++;
+            }
+            else if (tokenType == lexing::TokenType::RightBracket)
+            {
+                if (bracketCount-- == 0 && !expressionBodied)
+                    break;
+            }
+            else if (tokenType == lexing::TokenType::Semicolon)
+            {
+                if (bracketCount == 0 && expressionBodied)
+                    break;
             }
         }
 
-        return result;
+        return offset;
     }
 
-    ASTNodePtr Parser::parseGlobal(std::vector<ASTNodePtr>& nodes)
+    void Parser::parseBody(DeferredBody& deferred)
+    {
+        mTokens.seek(deferred.offset);
+        mScope = deferred.scope;
+        mNamespaces = std::move(deferred.namespaces);
+
+        mLocals.enterScope();
+        for (auto& [name, local] : deferred.parameters)
+        {
+            mLocals.declare(name, local);
+        }
+
+        if (deferred.initializer)
+        {
+            *deferred.initializer = parseExpression(deferred.type);
+            expectToken(lexing::TokenType::Semicolon);
+            mLocals.exitScope();
+            return;
+        }
+
+        std::vector<ASTNodePtr>& body = *deferred.body;
+        if (deferred.expressionBodied)
+        {
+            ASTNodePtr exp = parseExpression(deferred.type);
+            if (deferred.type->isVoidType())
+                body.push_back(std::move(exp));
+            else
+                body.push_back(mContext.astArena.create<ReturnStatement>(std::move(exp)));
+            expectToken(lexing::TokenType::Semicolon);
+        }
+        else
+        {
+            while (current().getTokenType() != lexing::TokenType::RightBracket)
+            {
+                body.push_back(parseExpression());
+                expectToken(lexing::TokenType::Semicolon);
+                consume();
+            }
+        }
+
+        mLocals.exitScope();
+    }
+
+    ASTNodePtr Parser::parseGlobal()
     {
         std::vector<GlobalAttribute> attributes;
+        lexing::Token attributesToken = current();
         if (current().getTokenType() == lexing::TokenType::DoubleLeftSquareBracket)
         {
             parseAttributes(attributes);
         }
 
+        bool exported = false;
         if (current().getTokenType() == lexing::TokenType::ExportKeyword)
         {
             consume();
+            exported = true;
             expectEitherToken({ lexing::TokenType::FuncKeyword, lexing::TokenType::GlobalKeyword,
                                 lexing::TokenType::ConstexprKeyword, lexing::TokenType::StructKeyword,
                                 lexing::TokenType::UsingKeyword, lexing::TokenType::EnumKeyword });
         }
 
+        bool isStruct = current().getTokenType() == lexing::TokenType::StructKeyword
+            || (current().getTokenType() == lexing::TokenType::UsingKeyword && peek(1).getTokenType() == lexing::TokenType::StructKeyword);
+        if (!isStruct)
+        {
+            GlobalAttribute::RejectLayoutAttributes(attributes, attributesToken, mDiag);
+        }
+
         switch (current().getTokenType())
         {
             case lexing::TokenType::FuncKeyword:
-                return parseFunction(attributes);
+                return parseFunction(exported, attributes);
             case lexing::TokenType::StructKeyword:
-                return parseStructDeclaration();
+                return parseStructDeclaration(exported, attributes);
             case lexing::TokenType::GlobalKeyword:
                 return parseGlobalDeclaration();
             case lexing::TokenType::ConstexprKeyword:
@@ -136,8 +225,11 @@ namespace parser
             case lexing::TokenType::ImportKeyword:
             {
                 auto symbols = parseImportStatement();
-                std::move(symbols.first.begin(), symbols.first.end(), std::back_inserter(nodes));
-                std::move(symbols.second.begin(), symbols.second.end(), std::back_inserter(mSymbols));
+                std::move(symbols.first.begin(), symbols.first.end(), std::back_inserter(mDeclarations));
+                for (auto& symbol : symbols.second)
+                {
+                    mSymbols.try_emplace(symbol.name, symbol);
+                }
                 return nullptr;
             }
             case lexing::TokenType::NamespaceKeyword:
@@ -146,8 +238,8 @@ namespace parser
                 if (peek(1).getTokenType() == lexing::TokenType::StructKeyword)
                 {
                     consume();
-                    StructDeclarationPtr structDecl = parseStructDeclaration();
-                    Type::AddAlias(structDecl->getNames(), structDecl->getType());
+                    StructDeclarationPtr structDecl = parseStructDeclaration(exported, attributes);
+                    Type::AddAlias(mContext, structDecl->getNames(), structDecl->getType());
                     return structDecl;
                 }
                 return parseUsingDeclaration();
@@ -239,7 +331,7 @@ namespace parser
 
     Type* Parser::parseType(bool failable)
     {
-        int startPosition = mPosition;
+        mTokens.mark();
         Type* type = nullptr;
         if (current().getTokenType() == lexing::TokenType::StructKeyword)
         {
@@ -248,26 +340,36 @@ namespace parser
             expectToken(lexing::TokenType::Identifier);
             while (current().getTokenType() == lexing::TokenType::Identifier)
             {
-                names.push_back(consume().getText());
+                names.emplace_back(consume().getText());
                 if (current().getTokenType() == lexing::TokenType::DoubleColon)
                 {
                     consume();
                 }
             }
-            std::vector<std::string> types = symbol::GetSymbol(names, mNamespaces);
+            std::vector<std::string> types = symbol::GetSymbol(mContext, names, mNamespaces);
             for (auto& name : types)
             {
-                type = StructType::Get(name);
+                type = StructType::Get(mContext, name);
                 if (type) break;
             }
             if (!type)
             {
                 if (failable)
                 {
-                    mPosition = startPosition;
+                    mTokens.rewind();
                     return nullptr;
                 }
-                mDiag.compilerError(peek(-1).getStart(), peek(-1).getEnd(), std::format("unknown type name '{}{}{}'", fmt::bold, names.back(), fmt::defaults));
+
+                // Assume it's defined further down, which fills in the fields
+                std::vector<std::string> forwardNames = names;
+                if (names.size() == 1)
+                {
+                    forwardNames = mNamespaces;
+                    forwardNames.push_back(names.back());
+                }
+                StructType* structType = StructType::Create(mContext, std::move(forwardNames), {});
+                mForwardStructs.push_back({structType, peek(-1)});
+                type = structType;
             }
         }
         else
@@ -275,13 +377,13 @@ namespace parser
             std::vector<std::string> names;
             if (current().getTokenType() == lexing::TokenType::Type)
             {
-                names.push_back(consume().getText());
+                names.emplace_back(consume().getText());
             }
             else
             {
                 while (current().getTokenType() == lexing::TokenType::Identifier)
                 {
-                    names.push_back(consume().getText());
+                    names.emplace_back(consume().getText());
                     if (current().getTokenType() == lexing::TokenType::DoubleColon)
                     {
                         consume();
@@ -289,24 +391,24 @@ namespace parser
                 }
             }
 
-            std::vector<std::string> types = symbol::GetSymbol(names, mNamespaces);
+            std::vector<std::string> types = symbol::GetSymbol(mContext, names, mNamespaces);
 
             lexing::Token token = peek(-1);
             for (auto& name : types)
             {
-                type = Type::Get(name);
+                type = Type::Get(mContext, name);
                 if (type) break;
             }
             if (!type)
             {
                 if (!names.empty())
-                    type = Type::Get(names.front());
+                    type = Type::Get(mContext, names.front());
 
                 if (!type)
                 {
                     if (failable)
                     {
-                        mPosition = startPosition;
+                        mTokens.rewind();
                         return nullptr;
                     }
 
@@ -320,19 +422,20 @@ namespace parser
             if (current().getTokenType() == lexing::TokenType::Star)
             {
                 consume();
-                type = PointerType::Create(type);
+                type = PointerType::Create(mContext, type);
             }
             else
             {
                 consume();
                 expectToken(lexing::TokenType::IntegerLiteral);
-                int count = std::stoi(consume().getText(), 0, 0);
+                int count = consume().getIntegerValue();
                 expectToken(lexing::TokenType::RightSquareBracket);
                 consume();
-                type = ArrayType::Create(type, count);
+                type = ArrayType::Create(mContext, type, count);
             }
         }
 
+        mTokens.unmark();
         return type;
     }
 
@@ -349,7 +452,7 @@ namespace parser
                 {
                     expectToken(lexing::TokenType::RightParen);
                     consume();
-                    lhs = std::make_unique<CastExpression>(parseExpression(nullptr, prefixOperatorPrecedence), type, std::move(operatorToken));
+                    lhs = mContext.astArena.create<CastExpression>(parseExpression(nullptr, prefixOperatorPrecedence), type, std::move(operatorToken));
                 }
                 else // Parenthesized expression
                 {
@@ -358,7 +461,7 @@ namespace parser
             }
             else
             {
-                lhs = std::make_unique<UnaryExpression>(parseExpression(preferredType, prefixOperatorPrecedence), std::move(operatorToken));
+                lhs = mContext.astArena.create<UnaryExpression>(mContext, parseExpression(preferredType, prefixOperatorPrecedence), std::move(operatorToken));
             }
         }
         else
@@ -376,7 +479,7 @@ namespace parser
 
             lexing::Token operatorToken = consume();
 
-            lhs = std::make_unique<UnaryExpression>(std::move(lhs), std::move(operatorToken), true);
+            lhs = mContext.astArena.create<UnaryExpression>(mContext, std::move(lhs), std::move(operatorToken), true);
         }
 
         while (true)
@@ -404,12 +507,12 @@ namespace parser
             else if (operatorToken.getTokenType() == lexing::TokenType::DoubleColon)
             {
                 lexing::Token token = current();
-                lhs = std::make_unique<ScopeResolution>(std::move(lhs), token, parseExpression(nullptr, binaryOperatorPrecedence));
+                lhs = mContext.astArena.create<ScopeResolution>(mContext, std::move(lhs), token, parseExpression(nullptr, binaryOperatorPrecedence));
             }
             else
             {
                 ASTNodePtr rhs = parseExpression(nullptr, binaryOperatorPrecedence);
-                lhs = std::make_unique<BinaryExpression>(std::move(lhs), std::move(operatorToken), std::move(rhs));
+                lhs = mContext.astArena.create<BinaryExpression>(mContext, std::move(lhs), std::move(operatorToken), std::move(rhs));
             }
 
             if (operatorToken.getTokenType() == lexing::TokenType::LeftSquareBracket)
@@ -447,17 +550,17 @@ namespace parser
             case lexing::TokenType::SwitchKeyword:
                 return parseSwitchStatement();
             case lexing::TokenType::BreakKeyword:
-                return std::make_unique<BreakStatement>(std::move(consume()));
+                return mContext.astArena.create<BreakStatement>(std::move(consume()));
             case lexing::TokenType::ContinueKeyword:
-                return std::make_unique<ContinueStatement>(std::move(consume()));
+                return mContext.astArena.create<ContinueStatement>(std::move(consume()));
 
             case lexing::TokenType::TrueKeyword:
-                return std::make_unique<BooleanLiteral>(true, consume());
+                return mContext.astArena.create<BooleanLiteral>(mContext, true, consume());
             case lexing::TokenType::FalseKeyword:
-                return std::make_unique<BooleanLiteral>(false, consume());
+                return mContext.astArena.create<BooleanLiteral>(mContext, false, consume());
 
             case lexing::TokenType::NullptrKeyword:
-                return std::make_unique<NullptrLiteral>(preferredType, consume());
+                return mContext.astArena.create<NullptrLiteral>(preferredType ? preferredType : PointerType::Create(mContext, Type::GetIntegerType(mContext, 8, true)), consume());
 
             case lexing::TokenType::SizeofKeyword:
                 return parseSizeof(preferredType);
@@ -498,7 +601,7 @@ namespace parser
         return expression;
     }
 
-    FunctionPtr Parser::parseFunction(std::vector<GlobalAttribute> attributes)
+    FunctionPtr Parser::parseFunction(bool exported, std::vector<GlobalAttribute> attributes)
     {
         consume();
 
@@ -506,27 +609,29 @@ namespace parser
         consume();
 
         expectToken(lexing::TokenType::Identifier);
-        std::string name = consume().getText();
+        std::string name(consume().getText());
 
         expectToken(lexing::TokenType::LeftParen);
         consume();
 
         std::vector<FunctionArgument> arguments;
 
-        Scope* functionScope = new Scope(mScope, nullptr);
+        Scope* functionScope = new Scope(mScope, nullptr, Scope::Kind::Function);
         mScope = functionScope;
+        mLocals.enterScope();
 
         while (current().getTokenType() != lexing::TokenType::RightParen)
         {
             expectToken(lexing::TokenType::Identifier);
-            std::string name = consume().getText();
+            std::string name(consume().getText());
 
             expectToken(lexing::TokenType::Colon);
             consume();
 
             Type* type = parseType();
-            mScope->locals[name] = LocalSymbol(nullptr, type);
-            arguments.push_back({std::move(name), type});
+            LocalSymbol* local = mScope->addLocal(type);
+            mLocals.declare(name, local);
+            arguments.push_back({std::move(name), type, local});
 
             if (current().getTokenType() != lexing::TokenType::RightParen)
             {
@@ -535,60 +640,64 @@ namespace parser
             }
         }
         consume();
+        mLocals.exitScope();
 
-        Type* returnType = Type::Get("void");
+        Type* returnType = Type::GetVoidType(mContext);
         if (current().getTokenType() == lexing::TokenType::RightArrow)
         {
             consume();
             returnType = parseType();
         }
+        functionScope->currentReturnType = returnType;
 
         std::vector<Type*> argumentTypes;
         for (auto& argument : arguments)
         {
             argumentTypes.push_back(argument.type);
         }
-        Type* type = FunctionType::Create(returnType, std::move(argumentTypes));
+        Type* type = FunctionType::Create(mContext, returnType, std::move(argumentTypes));
 
-        mSymbols.push_back({name, type});
+        mSymbols.try_emplace(name, GlobalSymbol{name, type});
+
+        // Declared here rather than by typeCheck, so that a qualified call
+        // (n::f()) in a body parsed later already knows what it returns
+        std::vector<std::string> names = mNamespaces;
+        names.push_back(name);
+        std::string mangledName;
+        Function::Declare(mContext, std::move(names), type, attributes, mangledName);
 
         if (current().getTokenType() == lexing::TokenType::Semicolon) // Extern function declaration
         {
             consume();
             mScope = functionScope->parent;
             delete functionScope;
-            return std::make_unique<Function>(std::move(attributes), type, std::move(arguments), std::move(name), std::vector<ASTNodePtr>(), nullptr);
+            for (auto& argument : arguments)
+            {
+                argument.symbol = nullptr;
+            }
+            mDeclarations.push_back(mContext.astArena.create<Function>(std::move(attributes), type, std::move(arguments), std::move(name), std::vector<ASTNodePtr>(), nullptr));
+            return nullptr;
         }
 
         expectEitherToken({lexing::TokenType::LeftBracket, lexing::TokenType::Equals});
         bool isExpressionBodied = current().getTokenType() == lexing::TokenType::Equals;
         consume();
 
-        std::vector<ASTNodePtr> body;
-        if (isExpressionBodied)
-        {
-            ASTNodePtr exp = parseExpression(type);
-            if (type->isVoidType())
-                body.push_back(std::move(exp));
-            else
-                body.push_back(std::make_unique<ReturnStatement>(std::move(exp)));
-            expectToken(lexing::TokenType::Semicolon);
-            consume();
-        }
-        else
-        {
-            while (current().getTokenType() != lexing::TokenType::RightBracket)
-            {
-                body.push_back(parseExpression());
-                expectToken(lexing::TokenType::Semicolon);
-                consume();
-            }
-            consume();
-        }
+        std::uint32_t bodyOffset = skipBody(isExpressionBodied);
 
         mScope = functionScope->parent;
 
-        return std::make_unique<Function>(std::move(attributes), type, std::move(arguments), std::move(name), std::move(body), functionScope);
+        mDeclarations.push_back(mContext.astArena.create<Function>(attributes, type, arguments, name, std::vector<ASTNodePtr>(), nullptr));
+
+        std::vector<std::pair<std::string, LocalSymbol*> > parameters;
+        for (auto& argument : arguments)
+        {
+            parameters.push_back({argument.name, argument.symbol});
+        }
+
+        FunctionPtr function = mContext.astArena.create<Function>(std::move(attributes), type, std::move(arguments), std::move(name), std::vector<ASTNodePtr>(), functionScope, exported);
+        mDeferredBodies.push_back({bodyOffset, isExpressionBodied, returnType, functionScope, mNamespaces, &function->getBody(), std::move(parameters)});
+        return function;
     }
 
     NamespacePtr Parser::parseNamespace()
@@ -596,52 +705,94 @@ namespace parser
         consume(); // namespace
 
         expectToken(lexing::TokenType::Identifier);
-        std::string name = consume().getText();
+        std::string name(consume().getText());
         mNamespaces.push_back(name);
 
         expectToken(lexing::TokenType::LeftBracket);
         consume();
 
-        Scope* scope = new Scope(mScope, nullptr);
+        Scope* scope = new Scope(mContext, mScope, name);
         mScope = scope;
+
+        std::vector<ASTNodePtr> declarations;
+        std::swap(declarations, mDeclarations);
         
         std::vector<ASTNodePtr> body;
         while(current().getTokenType() != lexing::TokenType::RightBracket)
         {
-            ASTNodePtr node = parseGlobal(body);
+            ASTNodePtr node = parseGlobal();
             if (node)
             {
                 body.push_back(std::move(node));
             }
         }
         consume();
-        mSymbols.push_back({name, nullptr});
+        mSymbols.try_emplace(name, GlobalSymbol{name, nullptr});
 
         mScope = scope->parent;
         mNamespaces.pop_back();
 
-        return std::make_unique<Namespace>(std::move(name), std::move(body), scope);
+        std::swap(declarations, mDeclarations);
+        if (!declarations.empty())
+        {
+            mDeclarations.push_back(mContext.astArena.create<Namespace>(name, std::move(declarations), new Scope(mContext, mScope, name)));
+        }
+
+        return mContext.astArena.create<Namespace>(std::move(name), std::move(body), scope);
     }
 
-    StructDeclarationPtr Parser::parseStructDeclaration()
+    StructDeclarationPtr Parser::parseStructDeclaration(bool exported, std::vector<GlobalAttribute> attributes)
     {
         consume(); // struct
 
         expectToken(lexing::TokenType::Identifier);
-        std::string name = consume().getText();
+        lexing::Token nameToken = consume();
+        std::string name(nameToken.getText());
         std::vector<std::string> names = mNamespaces;
         names.push_back(name);
 
         expectToken(lexing::TokenType::LeftBracket);
         consume();
 
-        StructType* structType = StructType::Create(names, {});
+        StructType* structType = StructType::Create(mContext, names, {});
+        // In a whole-program build a file can be imported by another input
+        // before it's parsed itself, in which case the fields are there already
+        bool defined = structType->isComplete();
+        std::erase_if(mForwardStructs, [structType](const ForwardStruct& forwardStruct) {
+            return forwardStruct.type == structType;
+        });
+
+        for (auto& attribute : attributes)
+        {
+            if (attribute.getType() == GlobalAttributeType::Align)
+            {
+                structType->setAlignment(static_cast<int>(attribute.getValue()) * 8);
+                if (attribute.getValue() > GlobalAttribute::GuaranteedAlignment)
+                {
+                    mDiag.compilerWarning(nameToken.getStart(), nameToken.getEnd(), std::format("'{}struct {}{}' is aligned to {} bytes, but its objects are only guaranteed {}-byte alignment",
+                        fmt::bold, name, fmt::defaults, attribute.getValue(), GlobalAttribute::GuaranteedAlignment));
+                }
+            }
+            else if (attribute.getType() == GlobalAttributeType::Reorder)
+            {
+                structType->setReordered(true);
+            }
+        }
 
-        std::vector<StructType::Field>& fieldTypes = structType->getFields();
         std::vector<StructField> fields;
         std::vector<StructMethod> methods;
+        std::vector<std::pair<std::size_t, DeferredBody> > methodBodies;
         while (current().getTokenType() != lexing::TokenType::RightBracket)
         {
+            std::vector<GlobalAttribute> methodAttributes;
+            if (current().getTokenType() == lexing::TokenType::DoubleLeftSquareBracket)
+            {
+                lexing::Token attributesToken = current();
+                parseAttributes(methodAttributes);
+                GlobalAttribute::RejectLayoutAttributes(methodAttributes, attributesToken, mDiag);
+                expectEitherToken({ lexing::TokenType::PrivateKeyword, lexing::TokenType::FuncKeyword });
+            }
+
             bool priv = false;
             if (current().getTokenType() == lexing::TokenType::PrivateKeyword)
             {
@@ -656,26 +807,28 @@ namespace parser
                 consume();
 
                 expectToken(lexing::TokenType::Identifier);
-                std::string name = consume().getText();
+                std::string name(consume().getText());
 
                 expectToken(lexing::TokenType::LeftParen);
                 consume();
 
-                Scope* scope = new Scope(mScope, structType);
+                Scope* scope = new Scope(mScope, structType, Scope::Kind::Function);
                 mScope = scope;
+                mLocals.enterScope();
 
                 std::vector<FunctionArgument> arguments;
                 while (current().getTokenType() != lexing::TokenType::RightParen)
                 {
                     expectToken(lexing::TokenType::Identifier);
-                    std::string name = consume().getText();
+                    std::string name(consume().getText());
 
                     expectToken(lexing::TokenType::Colon);
                     consume();
 
                     Type* type = parseType();
-                    mScope->locals[name] = LocalSymbol(nullptr, type);
-                    arguments.push_back({std::move(name), type});
+                    LocalSymbol* local = mScope->addLocal(type);
+                    mLocals.declare(name, local);
+                    arguments.push_back({std::move(name), type, local});
 
                     if (current().getTokenType() != lexing::TokenType::RightParen)
                     {
@@ -684,71 +837,70 @@ namespace parser
                     }
                 }
                 consume();
+                mLocals.exitScope();
 
-                Type* returnType = Type::Get("void");
+                Type* returnType = Type::GetVoidType(mContext);
                 if (current().getTokenType() == lexing::TokenType::RightArrow)
                 {
                     consume();
                     returnType = parseType();
                 }
+                scope->currentReturnType = returnType;
 
-                std::vector<Type*> argumentTypes { PointerType::Create(structType) };
+                std::vector<Type*> argumentTypes { PointerType::Create(mContext, structType) };
                 for (auto& argument : arguments)
                 {
                     argumentTypes.push_back(argument.type);
                 }
-                Type* type = FunctionType::Create(returnType, std::move(argumentTypes));
+                Type* type = FunctionType::Create(mContext, returnType, std::move(argumentTypes));
 
                 if (current().getTokenType() == lexing::TokenType::Semicolon)
                 {
                     consume();
+                    mScope = scope->parent;
+                    delete scope;
+                    for (auto& argument : arguments)
+                    {
+                        argument.symbol = nullptr;
+                    }
                     methods.push_back({priv, std::move(name), type, std::move(arguments), std::vector<ASTNodePtr>(), nullptr});
                     continue;
                 }
 
-                mScope->locals["this"] = LocalSymbol(nullptr, PointerType::Create(structType));
+                LocalSymbol* self = mScope->addLocal(PointerType::Create(mContext, structType));
+                std::vector<std::pair<std::string, LocalSymbol*> > parameters { {"this", self} };
+                for (auto& argument : arguments)
+                {
+                    parameters.push_back({argument.name, argument.symbol});
+                }
 
                 expectEitherToken({lexing::TokenType::LeftBracket, lexing::TokenType::Equals});
                 bool isExpressionBodied = current().getTokenType() == lexing::TokenType::Equals;
                 consume();
 
-                std::vector<ASTNodePtr> body;
-                if (isExpressionBodied)
-                {
-                    ASTNodePtr exp = parseExpression(type);
-                    if (type->isVoidType())
-                        body.push_back(std::move(exp));
-                    else
-                        body.push_back(std::make_unique<ReturnStatement>(std::move(exp)));
-                    expectToken(lexing::TokenType::Semicolon);
-                    consume();
-                }
-                else
-                {
-                    while (current().getTokenType() != lexing::TokenType::RightBracket)
-                    {
-                        body.push_back(parseExpression());
-                        expectToken(lexing::TokenType::Semicolon);
-                        consume();
-                    }
-                    consume();
-                }
+                std::uint32_t bodyOffset = skipBody(isExpressionBodied);
 
                 mScope = mScope->parent;
 
-                methods.push_back({priv, name, type, std::move(arguments), std::move(body), ScopePtr(scope)});
+                methodBodies.push_back({methods.size(), {bodyOffset, isExpressionBodied, returnType, scope, mNamespaces, nullptr, std::move(parameters)}});
+                methods.push_back({priv, name, type, std::move(arguments), std::vector<ASTNodePtr>(), ScopePtr(scope)});
+                methods.back().self = self;
+                methods.back().attributes = std::move(methodAttributes);
             }
             else
             {
                 expectToken(lexing::TokenType::Identifier);
-                std::string name = consume().getText();
+                std::string name(consume().getText());
 
                 expectToken(lexing::TokenType::Colon);
                 consume();
 
                 Type* type = parseType();
 
-                fieldTypes.push_back({priv, name, type});
+                if (!defined)
+                {
+                    structType->addField({priv, name, type});
+                }
                 fields.push_back({priv, std::move(name), type});
 
                 expectToken(lexing::TokenType::Semicolon);
@@ -756,8 +908,22 @@ namespace parser
             }
         }
         consume();
+        structType->complete();
+
+        std::vector<StructMethod> declaredMethods;
+        for (auto& method : methods)
+        {
+            declaredMethods.push_back({method.priv, method.name, method.type, method.arguments, std::vector<ASTNodePtr>(), nullptr});
+        }
+        mDeclarations.push_back(mContext.astArena.create<StructDeclaration>(mContext, names, fields, std::move(declaredMethods), structType));
 
-        return std::make_unique<StructDeclaration>(std::move(names), std::move(fields), std::move(methods), structType);
+        StructDeclarationPtr structDeclaration = mContext.astArena.create<StructDeclaration>(mContext, std::move(names), std::move(fields), std::move(methods), structType, exported);
+        for (auto& [index, deferred] : methodBodies)
+        {
+            deferred.body = &structDeclaration->getMethods()[index].body;
+            mDeferredBodies.push_back(std::move(deferred));
+        }
+        return structDeclaration;
     }
 
     GlobalDeclarationPtr Parser::parseGlobalDeclaration()
@@ -766,7 +932,7 @@ namespace parser
 
         expectToken(lexing::TokenType::Identifier);
         std::vector<std::string> names = mNamespaces;
-        names.push_back(consume().getText());
+        names.emplace_back(consume().getText());
 
         expectToken(lexing::TokenType::Colon);
         consume();
@@ -776,14 +942,15 @@ namespace parser
         expectToken(lexing::TokenType::Equals);
         consume();
 
-        ASTNodePtr initVal = parseExpression(type);
-
-        expectToken(lexing::TokenType::Semicolon);
-        consume();
+        // The initializer can name globals declared further down, so it's parsed with the bodies
+        std::uint32_t initializerOffset = skipBody(true);
 
-        mSymbols.push_back({names.back(), type});
+        mSymbols.try_emplace(names.back(), GlobalSymbol{names.back(), type});
 
-        return std::make_unique<GlobalDeclaration>(std::move(names), type, std::move(initVal));
+        mDeclarations.push_back(mContext.astArena.create<GlobalDeclaration>(mContext, names, type, nullptr));
+        GlobalDeclarationPtr declaration = mContext.astArena.create<GlobalDeclaration>(mContext, std::move(names), type, nullptr);
+        mDeferredBodies.push_back({initializerOffset, true, type, mScope, mNamespaces, nullptr, {}, &declaration->getInitializer()});
+        return declaration;
     }
 
     std::pair<std::vector<ASTNodePtr>, std::vector<GlobalSymbol>> Parser::parseImportStatement()
@@ -812,7 +979,7 @@ namespace parser
         consume(); // using
 
         std::vector<std::string> names = mNamespaces;
-        names.push_back(consume().getText());
+        names.emplace_back(consume().getText());
 
         expectToken(lexing::TokenType::Equals);
         consume();
@@ -822,7 +989,7 @@ namespace parser
         expectToken(lexing::TokenType::Semicolon);
         consume();
 
-        return std::make_unique<UsingDeclaration>(std::move(names), type);
+        return mContext.astArena.create<UsingDeclaration>(mContext, std::move(names), type);
     }
 
     EnumDeclarationPtr Parser::parseEnumDeclaration(std::vector<GlobalAttribute> attributes)
@@ -830,7 +997,7 @@ namespace parser
         consume(); // enum
 
         std::vector<std::string> names = mNamespaces;
-        names.push_back(consume().getText());
+        names.emplace_back(consume().getText());
 
         expectToken(lexing::TokenType::LeftBracket);
         consume();
@@ -840,7 +1007,7 @@ namespace parser
         while (current().getTokenType() != lexing::TokenType::RightBracket)
         {
             expectToken(lexing::TokenType::Identifier);
-            std::string name = consume().getText();
+            std::string name(consume().getText());
 
             if (current().getTokenType() == lexing::TokenType::Equals)
             {
@@ -859,7 +1026,13 @@ namespace parser
         }
         consume();
 
-        return std::make_unique<EnumDeclaration>(std::move(attributes), std::move(names), std::move(fields));
+        mSymbols.try_emplace(names.back(), GlobalSymbol{names.back(), nullptr});
+        for (auto& field : fields)
+        {
+            mSymbols.try_emplace(field.name, GlobalSymbol{field.name, nullptr});
+        }
+
+        return mContext.astArena.create<EnumDeclaration>(mContext, std::move(attributes), std::move(names), std::move(fields));
     }
 
     CompoundStatementPtr Parser::parseCompoundStatement()
@@ -868,6 +1041,7 @@ namespace parser
 
         Scope* blockScope = new Scope(mScope, nullptr);
         mScope = blockScope;
+        mLocals.enterScope();
 
         std::vector<ASTNodePtr> body;
         while (current().getTokenType() != lexing::TokenType::RightBracket)
@@ -878,11 +1052,12 @@ namespace parser
         }
         consume();
 
-        mTokens.insert(mTokens.begin()+mPosition, lexing::Token(lexing::TokenType::Semicolon, {0, 0}, {0, 0}));
+        mTokens.insert(lexing::Token(lexing::TokenType::Semicolon));
 
         mScope = blockScope->parent;
+        mLocals.exitScope();
 
-        return std::make_unique<CompoundStatement>(std::move(body), blockScope);
+        return mContext.astArena.create<CompoundStatement>(std::move(body), blockScope);
     }
 
     ReturnStatementPtr Parser::parseReturnStatement()
@@ -891,34 +1066,35 @@ namespace parser
 
         if (current().getTokenType() == lexing::TokenType::Semicolon)
         {
-            return std::make_unique<ReturnStatement>(nullptr);
+            return mContext.astArena.create<ReturnStatement>(nullptr);
         }
 
-        return std::make_unique<ReturnStatement>(parseExpression()); // TODO: Pass preferred type as current function return type
+        return mContext.astArena.create<ReturnStatement>(parseExpression()); // TODO: Pass preferred type as current function return type
     }
 
     VariableDeclarationPtr Parser::parseVariableDeclaration()
     {
         consume(); // let
 
-        std::string name = consume().getText();
+        std::string name(consume().getText());
 
         expectToken(lexing::TokenType::Colon);
         consume();
 
         Type* type = parseType();
         
-        mScope->locals[name] = LocalSymbol(nullptr, type);
+        LocalSymbol* local = mScope->addLocal(type);
+        mLocals.declare(name, local);
 
         if (current().getTokenType() == lexing::TokenType::Semicolon)
         {
-            return std::make_unique<VariableDeclaration>(type, std::move(name), nullptr);
+            return mContext.astArena.create<VariableDeclaration>(type, std::move(name), nullptr, local);
         }
 
         expectToken(lexing::TokenType::Equals);
         consume();
 
-        return std::make_unique<VariableDeclaration>(type, std::move(name), parseExpression(type));
+        return mContext.astArena.create<VariableDeclaration>(type, std::move(name), parseExpression(type), local);
     }
 
     ConstexprStatementPtr Parser::parseConstexprStatement(bool global)
@@ -926,7 +1102,7 @@ namespace parser
         consume(); // constexpr
 
         lexing::Token token = current();
-        std::string name = consume().getText();
+        std::string name(consume().getText());
 
         auto names = mNamespaces;
         names.push_back(name);
@@ -936,23 +1112,32 @@ namespace parser
 
         Type* type = parseType();
 
+        LocalSymbol* local = nullptr;
         if (global)
-            mSymbols.push_back({name, type});
+        {
+            mSymbols.try_emplace(name, GlobalSymbol{name, type});
+        }
         else
-            mScope->locals[name] = LocalSymbol(nullptr, type);
+        {
+            local = mScope->addLocal(type);
+            mLocals.declare(name, local);
+        }
 
         expectToken(lexing::TokenType::Equals);
         consume();
 
-        ASTNodePtr value = parseExpression(type);
-
         if (global)
         {
-            expectToken(lexing::TokenType::Semicolon);
-            consume();
+            // Parsed with the bodies, like a global's initializer
+            std::uint32_t valueOffset = skipBody(true);
+
+            ConstexprStatementPtr constexprStatement = mContext.astArena.create<ConstexprStatement>(mContext, type, std::move(names), nullptr, token, global, local);
+            mDeferredBodies.push_back({valueOffset, true, type, mScope, mNamespaces, nullptr, {}, &constexprStatement->getValue()});
+            return constexprStatement;
         }
 
-        return std::make_unique<ConstexprStatement>(type, global ? std::move(names) : std::vector<std::string>{name}, std::move(value), token, global);
+        ASTNodePtr value = parseExpression(type);
+        return mContext.astArena.create<ConstexprStatement>(mContext, type, std::vector<std::string>{name}, std::move(value), token, global, local);
     }
 
     IfStatementPtr Parser::parseIfStatement()
@@ -980,7 +1165,7 @@ namespace parser
             elseBody = parseExpression();
         }
 
-        return std::make_unique<IfStatement>(std::move(condition), std::move(body), std::move(elseBody));
+        return mContext.astArena.create<IfStatement>(std::move(condition), std::move(body), std::move(elseBody));
     }
 
     WhileStatementPtr Parser::parseWhileStatement()
@@ -990,8 +1175,9 @@ namespace parser
         expectToken(lexing::TokenType::LeftParen);
         consume();
 
-        Scope* whileScope = new Scope(mScope, nullptr);
+        Scope* whileScope = new Scope(mScope, nullptr, Scope::Kind::Loop);
         mScope = whileScope;
+        mLocals.enterScope();
 
         ASTNodePtr condition = parseExpression();
 
@@ -1001,8 +1187,9 @@ namespace parser
         ASTNodePtr body = parseExpression();
 
         mScope = whileScope->parent;
+        mLocals.exitScope();
 
-        return std::make_unique<WhileStatement>(std::move(condition), std::move(body), whileScope);
+        return mContext.astArena.create<WhileStatement>(std::move(condition), std::move(body), whileScope);
     }
 
     ForStatementPtr Parser::parseForStatement()
@@ -1016,8 +1203,9 @@ namespace parser
         ASTNodePtr condition = nullptr;
         std::vector<ASTNodePtr> loopExpr;
 
-        Scope* forScope = new Scope(mScope, nullptr);
+        Scope* forScope = new Scope(mScope, nullptr, Scope::Kind::Loop);
         mScope = forScope;
+        mLocals.enterScope();
 
         if (current().getTokenType() != lexing::TokenType::Semicolon)
         {
@@ -1051,13 +1239,14 @@ namespace parser
         ASTNodePtr body = parseExpression();
 
         mScope = forScope->parent;
+        mLocals.exitScope();
 
-        return std::make_unique<ForStatement>(std::move(init), std::move(condition), std::move(loopExpr), std::move(body), forScope);
+        return mContext.astArena.create<ForStatement>(std::move(init), std::move(condition), std::move(loopExpr), std::move(body), forScope);
     }
 
     SwitchStatementPtr Parser::parseSwitchStatement()
     {
-        consume();
+        lexing::Token token = consume();
 
         expectToken(lexing::TokenType::LeftParen);
         consume();
@@ -1082,6 +1271,10 @@ namespace parser
         expectToken(lexing::TokenType::LeftBracket);
         consume();
 
+        Scope* switchScope = new Scope(mScope, nullptr, Scope::Kind::Switch);
+        mScope = switchScope;
+        mLocals.enterScope();
+
         std::vector<SwitchSection> sections;
         bool hasDefaultSection = false;
 
@@ -1125,9 +1318,12 @@ namespace parser
         }
         consume();
 
-        mTokens.insert(mTokens.begin() + mPosition, lexing::Token(lexing::TokenType::Semicolon, {0, 0}, {0, 0}));
+        mScope = switchScope->parent;
+        mLocals.exitScope();
 
-        return std::make_unique<SwitchStatement>(std::move(value), std::move(sections));
+        mTokens.insert(lexing::Token(lexing::TokenType::Semicolon));
+
+        return mContext.astArena.create<SwitchStatement>(std::move(value), std::move(sections), switchScope, std::move(token));
     }
 
     SizeofExpressionPtr Parser::parseSizeof(Type* preferredType)
@@ -1141,47 +1337,47 @@ namespace parser
         expectToken(lexing::TokenType::RightParen);
         consume();
 
-        return std::make_unique<SizeofExpression>(preferredType, type, std::move(token));
+        return mContext.astArena.create<SizeofExpression>(preferredType ? preferredType : Type::GetIntegerType(mContext, 32, true), type, std::move(token));
     }
 
     IntegerLiteralPtr Parser::parseIntegerLiteral(Type* preferredType)
     {
         lexing::Token token = consume();
-        unsigned long long value = std::stoull(token.getText(), 0, 0);
-        return std::make_unique<IntegerLiteral>(value, preferredType, std::move(token));
+        unsigned long long value = token.getIntegerValue();
+        return mContext.astArena.create<IntegerLiteral>(value, preferredType ? preferredType : Type::GetIntegerType(mContext, 32, true), std::move(token));
     }
 
     StringLiteralPtr Parser::parseStringLiteral()
     {
         lexing::Token token = consume();
-        std::string text = token.getText();
-        return std::make_unique<StringLiteral>(std::move(text), std::move(token));
+        std::string text = token.getStringValue();
+        return mContext.astArena.create<StringLiteral>(mContext, std::move(text), std::move(token));
     }
 
     VariableExpressionPtr Parser::parseVariableExpression(Type*)
     {
         lexing::Token nameToken = current();
-        std::string name = consume().getText();
+        std::string name(consume().getText());
 
-        auto local = mScope->findVariable(name);
-        if (local)
+        if (LocalSymbol* local = mLocals.find(name))
         {
-            return std::make_unique<VariableExpression>(std::move(name), local->type, std::move(nameToken));
+            return mContext.astArena.create<VariableExpression>(std::move(name), local->type, std::move(nameToken), local);
         }
 
-        if (mScope->findOwner() != nullptr && mScope->findOwner()->hasField(name))
+        if (StructType* owner = mScope ? mScope->findOwner() : nullptr)
         {
-            std::string nameCopy = name;
-            return std::make_unique<VariableExpression>(std::move(nameCopy), mScope->findOwner()->getField(name)->type, std::move(nameToken));
+            int fieldIndex = owner->getFieldIndex(name);
+            if (fieldIndex != static_cast<int>(owner->getFields().size()))
+            {
+                Type* type = owner->getFields()[fieldIndex].type;
+                return mContext.astArena.create<VariableExpression>(std::move(name), type, std::move(nameToken), mLocals.find("this"), fieldIndex);
+            }
         }
 
-        auto it = std::find_if(mSymbols.begin(), mSymbols.end(), [&name](const GlobalSymbol& symbol) {
-            return symbol.name == name;
-        });
-
+        auto it = mSymbols.find(name);
         if (it != mSymbols.end())
         {
-            return std::make_unique<VariableExpression>(std::move(name), it->type, std::move(nameToken));
+            return mContext.astArena.create<VariableExpression>(std::move(name), it->second.type, std::move(nameToken));
         }
 
         mDiag.compilerError(nameToken.getStart(), nameToken.getEnd(), std::format("Unknown symbol '{}{}{}'", fmt::bold, name, fmt::defaults));
@@ -1204,14 +1400,14 @@ namespace parser
         }
         consume();
 
-        return std::make_unique<CallExpression>(std::move(function), std::move(parameters), std::move(token));
+        return mContext.astArena.create<CallExpression>(mContext, std::move(function), std::move(parameters), std::move(token));
     }
 
     MemberAccessPtr Parser::parseMemberAccess(ASTNodePtr struc, bool pointer)
     {
         lexing::Token nameToken = consume();
 
-        return std::make_unique<MemberAccess>(std::move(struc), std::string(nameToken.getText()), pointer, std::move(nameToken));
+        return mContext.astArena.create<MemberAccess>(std::move(struc), std::string(nameToken.getText()), pointer, std::move(nameToken));
     }
 
     StructInitializerPtr Parser::parseStructInitializer(Type* type, lexing::Token token)
@@ -1228,10 +1424,13 @@ namespace parser
         consume();
 
         std::vector<ASTNodePtr> body;
-        int index = 0;
+        std::size_t index = 0;
         while (current().getTokenType() != lexing::TokenType::RightBracket)
         {
-            body.push_back(parseExpression(structType->getFields()[index++].type));
+            // Extra values are parsed without a preferred type and rejected by typeCheck
+            Type* fieldType = index < structType->getFields().size() ? structType->getFields()[index].type : nullptr;
+            body.push_back(parseExpression(fieldType));
+            ++index;
 
             if (current().getTokenType() != lexing::TokenType::RightBracket)
             {
@@ -1241,7 +1440,7 @@ namespace parser
         }
         consume();
 
-        return std::make_unique<StructInitializer>(type, std::move(body), std::move(token));
+        return mContext.astArena.create<StructInitializer>(type, std::move(body), std::move(token));
     }
 
     ArrayInitializerPtr Parser::parseArrayInitializer(Type* preferredType)
@@ -1263,7 +1462,7 @@ namespace parser
         }
         consume();
 
-        return std::make_unique<ArrayInitializer>(std::move(values), std::move(token));
+        return mContext.astArena.create<ArrayInitializer>(mContext, std::move(values), std::move(token));
     }
 
     void Parser::parseAttributes(std::vector<GlobalAttribute>& attributes)
@@ -1282,6 +1481,33 @@ namespace parser
             {
                 attributes.push_back(GlobalAttribute(GlobalAttributeType::GenerateNames));
             }
+            else if (token.getText() == "Align")
+            {
+                expectToken(lexing::TokenType::LeftParen);
+                consume();
+
+                expectToken(lexing::TokenType::IntegerLiteral);
+                lexing::Token valueToken = consume();
+                unsigned long long alignment = valueToken.getIntegerValue();
+                GlobalAttribute::CheckAlignment(alignment, valueToken, mDiag);
+
+                expectToken(lexing::TokenType::RightParen);
+                consume();
+
+                attributes.push_back(GlobalAttribute(GlobalAttributeType::Align, alignment));
+            }
+            else if (token.getText() == "Reorder")
+            {
+                attributes.push_back(GlobalAttribute(GlobalAttributeType::Reorder));
+            }
+            else if (token.getText() == "Inline")
+            {
+                attributes.push_back(GlobalAttribute(GlobalAttributeType::Inline));
+            }
+            else if (token.getText() == "NoInline")
+            {
+                attributes.push_back(GlobalAttribute(GlobalAttributeType::NoInline));
+            }
             else
             {
                 mDiag.compilerError(token.getStart(), token.getEnd(), std::format("unknown attribute '{}{}{}'", fmt::bold, token.getText(), fmt::defaults));
@@ -1295,4 +1521,4 @@ namespace parser
         }
         consume();
     }
-}
+}
\ No newline at end of file
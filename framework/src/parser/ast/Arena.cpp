@@ -0,0 +1,58 @@
+// Copyright 2024 solar-mist
+
+
+#include "parser/ast/Arena.h"
+#include "parser/ast/Node.h"
+
+#include <algorithm>
+
+namespace parser
+{
+    static constexpr std::size_t Alignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+    static constexpr std::size_t FirstBlockSize = 64 * 1024;
+    static constexpr std::size_t MaxBlockSize = 16 * 1024 * 1024;
+
+    Arena::Arena()
+        : mCurrent(nullptr)
+        , mEnd(nullptr)
+    {
+    }
+
+    void* Arena::allocate(std::size_t size)
+    {
+        size = (size + Alignment - 1) & ~(Alignment - 1);
+        if (static_cast<std::size_t>(mEnd - mCurrent) < size)
+        {
+            newBlock(size);
+        }
+
+        void* pointer = mCurrent;
+        mCurrent += size;
+        return pointer;
+    }
+
+    void Arena::newBlock(std::size_t minimumSize)
+    {
+        std::size_t size = mBlocks.empty() ? FirstBlockSize : std::min(mBlocks.back().size * 2, MaxBlockSize);
+        size = std::max(size, minimumSize);
+
+        mBlocks.push_back({std::unique_ptr<std::byte[]>(new std::byte[size]), size});
+        mCurrent = mBlocks.back().data.get();
+        mEnd = mCurrent + size;
+    }
+
+
+    void* ASTNode::operator new(std::size_t size, Arena& arena)
+    {
+        return arena.allocate(size);
+    }
+
+    void ASTNode::operator delete(void*)
+    {
+        // released along with the rest of the arena
+    }
+
+    void ASTNode::operator delete(void*, Arena&)
+    {
+    }
+}
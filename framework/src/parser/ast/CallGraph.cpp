@@ -0,0 +1,184 @@
+// Copyright 2024 solar-mist
+
+
+#include "parser/ast/CallGraph.h"
+
+#include "parser/ast/expression/CallExpression.h"
+#include "parser/ast/expression/VariableExpression.h"
+
+#include "parser/ast/global/Function.h"
+#include "parser/ast/global/Namespace.h"
+#include "parser/ast/global/StructDeclaration.h"
+
+#include <algorithm>
+
+namespace parser
+{
+    CallGraph::CallGraph(bool wholeProgram)
+        : mWholeProgram(wholeProgram)
+    {
+    }
+
+    void CallGraph::add(std::vector<ASTNodePtr>& ast)
+    {
+        for (auto& node : ast)
+        {
+            addGlobal(node.get());
+        }
+    }
+
+    void CallGraph::removeUnreachable()
+    {
+        for (std::size_t i = 0; i < mFunctions.size(); ++i)
+        {
+            if (mVertices[mFunctions[i]].root)
+            {
+                markReachable(mFunctions[i]);
+            }
+        }
+
+        for (auto& [function, vertex] : mVertices)
+        {
+            if (!vertex.reachable)
+            {
+                function->reachable = false;
+            }
+        }
+    }
+
+    static void PrintName(std::ostream& stream, FunctionSymbol* function)
+    {
+        for (std::size_t i = 0; i < function->names.size(); ++i)
+        {
+            if (i != 0) stream << "::";
+            stream << function->names[i];
+        }
+    }
+
+    void CallGraph::print(std::ostream& stream) const
+    {
+        for (FunctionSymbol* function : mFunctions)
+        {
+            const Vertex& vertex = mVertices.at(function);
+
+            PrintName(stream, function);
+            if (vertex.root) stream << " (root)";
+            else if (!vertex.reachable) stream << " (unreachable)";
+
+            if (!vertex.references.empty())
+            {
+                stream << " ->";
+                for (FunctionSymbol* reference : vertex.references)
+                {
+                    stream << " ";
+                    PrintName(stream, reference);
+                }
+            }
+            stream << "\n";
+        }
+    }
+
+    CallGraph::Vertex& CallGraph::addFunction(FunctionSymbol* function)
+    {
+        auto [it, inserted] = mVertices.try_emplace(function);
+        if (inserted)
+        {
+            mFunctions.push_back(function);
+        }
+        return it->second;
+    }
+
+    void CallGraph::addGlobal(ASTNode* node)
+    {
+        if (auto function = dynamic_cast<Function*>(node))
+        {
+            // A function defined in this file has a declaration as well, and
+            // both share the symbol
+            Vertex& vertex = addFunction(function->getSymbol());
+
+            bool noMangle = std::find_if(function->getAttributes().begin(), function->getAttributes().end(), [](const auto& attribute){
+                return attribute.getType() == GlobalAttributeType::NoMangle;
+            }) != function->getAttributes().end();
+            if ((function->isExported() && !mWholeProgram) || noMangle || function->getSymbol()->names == std::vector<std::string>{"main"})
+            {
+                vertex.root = true;
+            }
+
+            for (auto& statement : function->getBody())
+            {
+                CollectReferences(statement.get(), vertex.references);
+            }
+        }
+        else if (auto structDeclaration = dynamic_cast<StructDeclaration*>(node))
+        {
+            for (auto& method : structDeclaration->getMethods())
+            {
+                Vertex& vertex = addFunction(method.symbol);
+                if (structDeclaration->isExported() && !mWholeProgram)
+                {
+                    vertex.root = true;
+                }
+
+                for (auto& statement : method.body)
+                {
+                    CollectReferences(statement.get(), vertex.references);
+                }
+            }
+        }
+        else if (dynamic_cast<Namespace*>(node))
+        {
+            node->forEachChild([this](ASTNode* child) {
+                addGlobal(child);
+            });
+        }
+        else
+        {
+            // Global initializers are emitted whatever happens, so whatever
+            // they refer to has to be too
+            std::vector<FunctionSymbol*> references;
+            CollectReferences(node, references);
+            for (FunctionSymbol* reference : references)
+            {
+                addFunction(reference).root = true;
+            }
+        }
+    }
+
+    void CallGraph::markReachable(FunctionSymbol* function)
+    {
+        std::vector<FunctionSymbol*> worklist { function };
+        while (!worklist.empty())
+        {
+            FunctionSymbol* current = worklist.back();
+            worklist.pop_back();
+
+            Vertex& vertex = addFunction(current);
+            if (vertex.reachable) continue;
+
+            vertex.reachable = true;
+            worklist.insert(worklist.end(), vertex.references.begin(), vertex.references.end());
+        }
+    }
+
+    void CallGraph::CollectReferences(ASTNode* node, std::vector<FunctionSymbol*>& references)
+    {
+        FunctionSymbol* reference = nullptr;
+        if (auto call = dynamic_cast<CallExpression*>(node))
+        {
+            reference = call->getCallee();
+        }
+        else if (auto variable = dynamic_cast<VariableExpression*>(node))
+        {
+            reference = variable->getFunction();
+        }
+
+        if (reference && std::find(references.begin(), references.end(), reference) == references.end())
+        {
+            references.push_back(reference);
+        }
+
+        node->forEachChild([&references](ASTNode* child) {
+            CollectReferences(child, references);
+        });
+    }
+}
@@ -0,0 +1,140 @@
+// Copyright 2024 solar-mist
+
+
+#include "parser/ast/ConstantEvaluator.h"
+
+#include "parser/ast/expression/BooleanLiteral.h"
+#include "parser/ast/expression/IntegerLiteral.h"
+
+#include <format>
+
+namespace parser
+{
+    ConstantEvaluator::ConstantEvaluator(CompilerContext& context, diagnostic::Diagnostics& diag)
+        : mContext(context)
+        , mDiag(diag)
+        , mSteps(0)
+        , mOutOfSteps(false)
+        , mOutOfDepth(false)
+        , mFlow(Flow::Normal)
+    {
+    }
+
+    ASTNodePtr ConstantEvaluator::EvaluateInitializer(ASTNode* node, const lexing::Token& token, CompilerContext& context, diagnostic::Diagnostics& diag)
+    {
+        if (!node || dynamic_cast<IntegerLiteral*>(node) || dynamic_cast<BooleanLiteral*>(node))
+        {
+            return nullptr;
+        }
+
+        ConstantEvaluator evaluator(context, diag);
+        std::optional<ConstantValue> value = evaluator.evaluate(node);
+
+        if (evaluator.mOutOfSteps)
+        {
+            diag.compilerError(token.getStart(), token.getEnd(), std::format("compile-time evaluation took more than {} steps", StepBudget));
+        }
+        if (evaluator.mOutOfDepth)
+        {
+            diag.compilerError(token.getStart(), token.getEnd(), std::format("compile-time evaluation nested more than {} calls deep", MaxCallDepth));
+        }
+
+        if (!value || !value->type)
+        {
+            return nullptr;
+        }
+        return value->toNode(context, token);
+    }
+
+    CompilerContext& ConstantEvaluator::getContext()
+    {
+        return mContext;
+    }
+
+    diagnostic::Diagnostics& ConstantEvaluator::getDiagnostics()
+    {
+        return mDiag;
+    }
+
+    std::optional<ConstantValue> ConstantEvaluator::evaluate(ASTNode* node)
+    {
+        if (++mSteps > StepBudget)
+        {
+            mOutOfSteps = true;
+            return std::nullopt;
+        }
+        return node->evaluate(*this);
+    }
+
+    ConstantValue* ConstantEvaluator::evaluateAddress(ASTNode* node)
+    {
+        if (++mSteps > StepBudget)
+        {
+            mOutOfSteps = true;
+            return nullptr;
+        }
+        return node->evaluateAddress(*this);
+    }
+
+    bool ConstantEvaluator::pushFrame(std::size_t size)
+    {
+        if (mFrames.size() == MaxCallDepth)
+        {
+            mOutOfDepth = true;
+            return false;
+        }
+
+        // A frame is never resized, so the address of a local stays valid
+        // for as long as the call it belongs to
+        mFrames.emplace_back(size);
+        return true;
+    }
+
+    void ConstantEvaluator::popFrame()
+    {
+        mFrames.pop_back();
+    }
+
+    ConstantValue* ConstantEvaluator::getLocal(LocalSymbol* symbol)
+    {
+        if (mFrames.empty() || symbol->slot >= mFrames.back().size())
+        {
+            return nullptr;
+        }
+        return &mFrames.back()[symbol->slot];
+    }
+
+    ConstantEvaluator::Flow ConstantEvaluator::getFlow() const
+    {
+        return mFlow;
+    }
+
+    void ConstantEvaluator::setFlow(Flow flow, ConstantValue returnValue)
+    {
+        mFlow = flow;
+        mReturnValue = std::move(returnValue);
+    }
+
+    ConstantValue ConstantEvaluator::takeReturnValue()
+    {
+        mFlow = Flow::Normal;
+        return std::move(mReturnValue);
+    }
+
+    bool ConstantEvaluator::leaveLoop()
+    {
+        switch (mFlow)
+        {
+            case Flow::Break:
+                mFlow = Flow::Normal;
+                return true;
+            case Flow::Continue:
+                mFlow = Flow::Normal;
+                return false;
+            case Flow::Return:
+                return true;
+            default:
+                return false;
+        }
+    }
+}
@@ -0,0 +1,76 @@
+// Copyright 2024 solar-mist
+
+
+#include "parser/ast/ConstantValue.h"
+
+#include "parser/ast/expression/ArrayInitializer.h"
+#include "parser/ast/expression/BooleanLiteral.h"
+#include "parser/ast/expression/IntegerLiteral.h"
+#include "parser/ast/expression/StructInitializer.h"
+
+#include "context/CompilerContext.h"
+
+#include "type/ArrayType.h"
+#include "type/StructType.h"
+
+namespace parser
+{
+    std::optional<ConstantValue> ConstantValue::Zero(Type* type)
+    {
+        ConstantValue value;
+        value.type = type;
+
+        if (type->isIntegerType() || type->isBooleanType())
+        {
+            return value;
+        }
+
+        if (type->isArrayType())
+        {
+            auto arrayType = static_cast<ArrayType*>(type);
+            std::optional<ConstantValue> element = Zero(arrayType->getBaseType());
+            if (!element || arrayType->getCount() == 0) return std::nullopt; // an empty initializer has no type to emit
+
+            value.elements.assign(arrayType->getCount(), *element);
+            return value;
+        }
+
+        if (type->isStructType())
+        {
+            for (auto& field : static_cast<StructType*>(type)->getFields())
+            {
+                std::optional<ConstantValue> element = Zero(field.type);
+                if (!element) return std::nullopt;
+
+                value.elements.push_back(std::move(*element));
+            }
+            return value;
+        }
+
+        return std::nullopt;
+    }
+
+    std::unique_ptr<ASTNode> ConstantValue::toNode(CompilerContext& context, const lexing::Token& token) const
+    {
+        if (type->isBooleanType())
+        {
+            return context.astArena.create<BooleanLiteral>(context, integer != 0, token);
+        }
+        if (type->isIntegerType())
+        {
+            return context.astArena.create<IntegerLiteral>(integer, type, token);
+        }
+
+        std::vector<ASTNodePtr> body;
+        for (auto& element : elements)
+        {
+            body.push_back(element.toNode(context, token));
+        }
+
+        if (type->isArrayType())
+        {
+            return context.astArena.create<ArrayInitializer>(context, std::move(body), token);
+        }
+        return context.astArena.create<StructInitializer>(type, std::move(body), token);
+    }
+}
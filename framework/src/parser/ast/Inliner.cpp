@@ -0,0 +1,106 @@
+// Copyright 2024 solar-mist
+
+
+#include "parser/ast/Inliner.h"
+
+#include "parser/ast/statement/ReturnStatement.h"
+
+#include <vipir/IR/BasicBlock.h>
+#include <vipir/IR/Instruction/AllocaInst.h>
+#include <vipir/IR/Instruction/LoadInst.h>
+#include <vipir/IR/Instruction/StoreInst.h>
+
+#include <algorithm>
+
+namespace parser
+{
+    bool Inliner::ShouldInline(std::vector<ASTNodePtr>& body, Type* returnType, const std::vector<GlobalAttribute>& attributes, Scope* scope)
+    {
+        if (body.empty() || scope->emitting)
+        {
+            return false;
+        }
+
+        if (!returnType->isVoidType() && !dynamic_cast<ReturnStatement*>(body.back().get()))
+        {
+            return false;
+        }
+
+        auto hasAttribute = [&attributes](GlobalAttributeType type) {
+            return std::find_if(attributes.begin(), attributes.end(), [type](const auto& attribute){
+                return attribute.getType() == type;
+            }) != attributes.end();
+        };
+        if (hasAttribute(GlobalAttributeType::NoInline)) return false;
+        if (hasAttribute(GlobalAttributeType::Inline)) return true;
+
+        // Counting stops as soon as the body is known to be too big
+        std::size_t size = 0;
+        std::function<void(ASTNode*)> count = [&size, &count](ASTNode* node) {
+            if (++size > SizeLimit) return;
+            node->forEachChild(count);
+        };
+        for (auto& node : body)
+        {
+            count(node.get());
+            if (size > SizeLimit) return false;
+        }
+        return true;
+    }
+
+    vipir::Value* Inliner::EmitBody(vipir::IRBuilder& builder, vipir::Module& module, CompilerContext& context, diagnostic::Diagnostics& diag,
+        std::vector<ASTNodePtr>& body, Type* returnType, Scope* scope, Scope* caller, const std::vector<std::pair<LocalSymbol*, vipir::Value*> >& arguments)
+    {
+        vipir::BasicBlock* returnBasicBlock = vipir::BasicBlock::Create("", builder.getInsertPoint()->getParent());
+
+        // Every slot the body needs, its own locals included, goes in the caller's entry block
+        scope->allocaBlock = caller->function->allocaBlock;
+
+        vipir::AllocaInst* returnSlot = nullptr;
+        if (!returnType->isVoidType())
+        {
+            returnSlot = scope->createAlloca(builder, returnType->getVipirType());
+        }
+
+        for (auto& [symbol, value] : arguments)
+        {
+            if (symbol->inRegister())
+            {
+                symbol->alloca = value;
+                continue;
+            }
+
+            vipir::AllocaInst* alloca = scope->createAlloca(builder, symbol->type->getVipirType());
+            symbol->alloca = alloca;
+
+            builder.CreateStore(alloca, value);
+        }
+
+        scope->emitting = true;
+        scope->returnTo = returnBasicBlock;
+        scope->returnSlot = returnSlot;
+
+        for (auto& node : body)
+        {
+            node->emit(builder, module, scope, context, diag);
+        }
+
+        // Only a void body can get here without returning, see ShouldInline
+        if (!dynamic_cast<ReturnStatement*>(body.back().get()))
+        {
+            builder.CreateBr(returnBasicBlock);
+        }
+
+        scope->emitting = false;
+        scope->returnTo = nullptr;
+        scope->returnSlot = nullptr;
+        scope->allocaBlock = nullptr;
+
+        builder.setInsertPoint(returnBasicBlock);
+        if (!returnSlot)
+        {
+            return nullptr;
+        }
+        return builder.CreateLoad(returnSlot);
+    }
+}
@@ -2,6 +2,7 @@
 
 
 #include "parser/ast/expression/ArrayInitializer.h"
+#include "parser/ast/ConstantEvaluator.h"
 
 #include "type/ArrayType.h"
 
@@ -9,14 +10,14 @@
 
 namespace parser
 {
-    ArrayInitializer::ArrayInitializer(std::vector<ASTNodePtr>&& body, lexing::Token token)
+    ArrayInitializer::ArrayInitializer(CompilerContext& context, std::vector<ASTNodePtr>&& body, lexing::Token token)
         : mBody(std::move(body))
     {
-        mType = ArrayType::Create(mBody[0]->getType(), mBody.size());
+        mType = ArrayType::Create(context, mBody[0]->getType(), mBody.size());
         mPreferredDebugToken = std::move(token);
     }
 
-    void ArrayInitializer::typeCheck(Scope* scope, diagnostic::Diagnostics& diag)
+    void ArrayInitializer::typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
         if (!mType->isArrayType())
         {
@@ -31,17 +32,47 @@ namespace parser
             {
                 diag.compilerError(node->getDebugToken().getStart(), node->getDebugToken().getEnd(), "Array initializer values must have the same type");
             }
-            node->typeCheck(scope, diag);
+            node->typeCheck(scope, context, diag);
         }
     }
 
-    vipir::Value* ArrayInitializer::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag)
+    vipir::Value* ArrayInitializer::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
         std::vector<vipir::Value*> values;
         for (auto& value : mBody)
         {
-            values.push_back(value->emit(builder, module, scope, diag));
+            values.push_back(value->emit(builder, module, scope, context, diag));
         }
         return vipir::ConstantArray::Get(module, mType->getVipirType(), std::move(values));
     }
-}
\ No newline at end of file
+
+    ASTNodePtr ArrayInitializer::fold(CompilerContext& context, diagnostic::Diagnostics& diag)
+    {
+        for (auto& value : mBody)
+        {
+            Fold(value, context, diag);
+        }
+        return nullptr;
+    }
+
+    std::optional<ConstantValue> ArrayInitializer::evaluate(ConstantEvaluator& evaluator)
+    {
+        ConstantValue array{ mType };
+        for (auto& value : mBody)
+        {
+            std::optional<ConstantValue> element = evaluator.evaluate(value.get());
+            if (!element) return std::nullopt;
+
+            array.elements.push_back(std::move(*element));
+        }
+        return array;
+    }
+
+    void ArrayInitializer::forEachChild(const std::function<void(ASTNode*)>& callback)
+    {
+        for (auto& element : mBody)
+        {
+            callback(element.get());
+        }
+    }
+}
@@ -2,21 +2,66 @@
 
 
 #include "parser/ast/expression/BinaryExpression.h"
+#include "parser/ast/ConstantEvaluator.h"
+#include "parser/ast/expression/BooleanLiteral.h"
+#include "parser/ast/expression/IntegerLiteral.h"
+#include "parser/ast/expression/MemberAccess.h"
+#include "parser/ast/expression/ScopeResolution.h"
+#include "parser/ast/expression/VariableExpression.h"
+
+#include "context/CompilerContext.h"
 
 #include "type/ArrayType.h"
 #include "type/IntegerType.h"
 
 #include <vipir/Module.h>
+#include <vipir/IR/Constant/ConstantInt.h>
 #include <vipir/IR/Instruction/BinaryInst.h>
 #include <vipir/IR/Instruction/StoreInst.h>
 #include <vipir/IR/Instruction/GEPInst.h>
 #include <vipir/IR/Instruction/LoadInst.h>
 
 #include <cassert>
+#include <cstdint>
 
 namespace parser
 {
-    BinaryExpression::BinaryExpression(ASTNodePtr left, lexing::Token operatorToken, ASTNodePtr right)
+    // Whether node is an integer literal equal to value once both are wrapped to the literal's type
+    static bool IsIntegerLiteral(ASTNode* node, std::intmax_t value)
+    {
+        auto integer = dynamic_cast<IntegerLiteral*>(node);
+        if (!integer || !integer->getType()->isIntegerType()) return false;
+
+        auto type = static_cast<IntegerType*>(integer->getType());
+        return type->wrap(integer->getValue()) == type->wrap(value);
+    }
+
+    // Conservative: anything that isn't a plain read of a variable or constant might have side effects
+    static bool HasSideEffects(ASTNode* node)
+    {
+        return !dynamic_cast<VariableExpression*>(node) && !dynamic_cast<IntegerLiteral*>(node)
+            && !dynamic_cast<BooleanLiteral*>(node) && !dynamic_cast<ScopeResolution*>(node);
+    }
+
+    static bool IsSameVariable(ASTNode* left, ASTNode* right)
+    {
+        auto leftVariable = dynamic_cast<VariableExpression*>(left);
+        auto rightVariable = dynamic_cast<VariableExpression*>(right);
+        return leftVariable && rightVariable && leftVariable->isSameVariable(rightVariable);
+    }
+
+    // The element of array at index, which is an error if it's out of bounds
+    static ConstantValue* ElementAt(ConstantValue& array, const ConstantValue& index, const lexing::Token& token, diagnostic::Diagnostics& diag)
+    {
+        if (static_cast<std::uintmax_t>(index.integer) >= array.elements.size())
+        {
+            diag.compilerError(token.getStart(), token.getEnd(), std::format("index {} is out of bounds for type '{}{}{}'",
+                index.integer, fmt::bold, array.type->getName(), fmt::defaults));
+        }
+        return &array.elements[index.integer];
+    }
+
+    BinaryExpression::BinaryExpression(CompilerContext& context, ASTNodePtr left, lexing::Token operatorToken, ASTNodePtr right)
         : mLeft(std::move(left))
         , mRight(std::move(right))
         , mToken(std::move(operatorToken))
@@ -56,29 +101,29 @@ namespace parser
 
             case lexing::TokenType::DoubleEquals:
                 mOperator = Operator::Equal;
-                mType = Type::Get("bool");
+                mType = Type::GetBooleanType(context);
                 break;
             case lexing::TokenType::BangEquals:
                 mOperator = Operator::NotEqual;
-                mType = Type::Get("bool");
+                mType = Type::GetBooleanType(context);
                 break;
 
             case lexing::TokenType::LessThan:
                 mOperator = Operator::LessThan;
-                mType = Type::Get("bool");
+                mType = Type::GetBooleanType(context);
                 break;
             case lexing::TokenType::GreaterThan:
                 mOperator = Operator::GreaterThan;
-                mType = Type::Get("bool");
+                mType = Type::GetBooleanType(context);
                 break;
 
             case lexing::TokenType::LessEqual:
                 mOperator = Operator::LessEqual;
-                mType = Type::Get("bool");
+                mType = Type::GetBooleanType(context);
                 break;
             case lexing::TokenType::GreaterEqual:
                 mOperator = Operator::GreaterEqual;
-                mType = Type::Get("bool");
+                mType = Type::GetBooleanType(context);
                 break;
 
             case lexing::TokenType::Equals:
@@ -103,7 +148,7 @@ namespace parser
         mPreferredDebugToken = mToken;
     }
 
-    void BinaryExpression::typeCheck(Scope* scope, diagnostic::Diagnostics& diag)
+    void BinaryExpression::typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
         switch (mOperator)
         {
@@ -185,14 +230,58 @@ namespace parser
                 break;
         }
 
-        mLeft->typeCheck(scope, diag);
-        mRight->typeCheck(scope, diag);
+        switch (mOperator)
+        {
+            case Operator::Assign:
+            case Operator::AddAssign:
+            case Operator::SubAssign:
+                VariableExpression::RequireSlot(mLeft.get());
+                break;
+            default:
+                break;
+        }
+
+        mLeft->typeCheck(scope, context, diag);
+        mRight->typeCheck(scope, context, diag);
+
+        switch (mOperator)
+        {
+            case Operator::Assign:
+            case Operator::AddAssign:
+            case Operator::SubAssign:
+                checkAssignmentTarget(diag);
+                break;
+            default:
+                break;
+        }
+    }
+
+    // Constexpr arrays and structs are emitted as data, so an element or
+    // field of one is an lvalue to vipir, but it mustn't be written to
+    void BinaryExpression::checkAssignmentTarget(diagnostic::Diagnostics& diag)
+    {
+        ASTNode* target = mLeft.get();
+        while (true)
+        {
+            if (auto access = dynamic_cast<BinaryExpression*>(target); access && access->mOperator == Operator::ArrayAccess)
+                target = access->mLeft.get();
+            else if (auto member = dynamic_cast<MemberAccess*>(target); member && !member->mPointer)
+                target = member->mStruct.get();
+            else
+                break;
+        }
+
+        if (auto variable = dynamic_cast<VariableExpression*>(target); variable && variable->isConstexpr())
+        {
+            diag.compilerError(mToken.getStart(), mToken.getEnd(), std::format("cannot assign to constexpr '{}{}{}'",
+                fmt::bold, variable->getName(), fmt::defaults));
+        }
     }
 
-    vipir::Value* BinaryExpression::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag)
+    vipir::Value* BinaryExpression::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
-        vipir::Value* left  = mLeft->emit(builder, module, scope, diag);
-        vipir::Value* right = mRight->emit(builder, module, scope, diag);
+        vipir::Value* left  = mLeft->emit(builder, module, scope, context, diag);
+        vipir::Value* right = mRight->emit(builder, module, scope, context, diag);
 
         switch (mOperator)
         {
@@ -240,13 +329,17 @@ namespace parser
                 return builder.CreateCmpNE(left, right);
 
             case Operator::LessThan:
+                if (isUnsignedCompare()) flipSignBits(builder, module, left, right);
                 return builder.CreateCmpLT(left, right);
             case Operator::GreaterThan:
+                if (isUnsignedCompare()) flipSignBits(builder, module, left, right);
                 return builder.CreateCmpGT(left, right);
 
             case Operator::LessEqual:
+                if (isUnsignedCompare()) flipSignBits(builder, module, left, right);
                 return builder.CreateCmpLE(left, right);
             case Operator::GreaterEqual:
+                if (isUnsignedCompare()) flipSignBits(builder, module, left, right);
                 return builder.CreateCmpGE(left, right);
 
             case Operator::Assign:
@@ -302,6 +395,25 @@ namespace parser
     }
 
 
+    bool BinaryExpression::isUnsignedCompare() const
+    {
+        Type* operandType = mLeft->getType();
+        return operandType->isIntegerType() && !static_cast<IntegerType*>(operandType)->isSigned();
+    }
+
+    // vipir's ordered compares are signed. Flipping the top bit of both
+    // operands maps unsigned order onto signed order, so unsigned values
+    // compare the same at runtime as applyOperator folds them
+    void BinaryExpression::flipSignBits(vipir::IRBuilder& builder, vipir::Module& module, vipir::Value*& left, vipir::Value*& right)
+    {
+        Type* operandType = mLeft->getType();
+        std::intmax_t signBit = operandType->getSize() < 64 ? std::intmax_t(1) << (operandType->getSize() - 1) : INTMAX_MIN;
+        vipir::Value* mask = vipir::ConstantInt::Get(module, signBit, operandType->getVipirType());
+
+        left = builder.CreateBWXor(left, mask);
+        right = builder.CreateBWXor(right, mask);
+    }
+
     void BinaryExpression::checkAssignmentLvalue(vipir::Value* pointer, diagnostic::Diagnostics& diag)
     {
         if (pointer == nullptr)
@@ -309,4 +421,329 @@ namespace parser
             diag.compilerError(mToken.getStart(), mToken.getEnd(), std::format("lvalue required as left operand of assignment"));
         }
     }
+
+    ASTNodePtr BinaryExpression::fold(CompilerContext& context, diagnostic::Diagnostics& diag)
+    {
+        switch (mOperator)
+        {
+            case Operator::Assign:
+            case Operator::AddAssign:
+            case Operator::SubAssign:
+                mLeft->fold(context, diag); // has to stay an lvalue, so only its subexpressions are folded
+                Fold(mRight, context, diag);
+                return nullptr;
+
+            case Operator::ArrayAccess:
+                Fold(mLeft, context, diag);
+                Fold(mRight, context, diag);
+                return nullptr;
+
+            default:
+                Fold(mLeft, context, diag);
+                Fold(mRight, context, diag);
+                if (ASTNodePtr folded = foldConstants(context, diag))
+                {
+                    return folded;
+                }
+                return simplify(context);
+        }
+    }
+
+    // Folds an operator on two literals the way it would run
+    ASTNodePtr BinaryExpression::foldConstants(CompilerContext& context, diagnostic::Diagnostics& diag)
+    {
+        auto leftBoolean = dynamic_cast<BooleanLiteral*>(mLeft.get());
+        auto rightBoolean = dynamic_cast<BooleanLiteral*>(mRight.get());
+        if (leftBoolean && rightBoolean)
+        {
+            if (mOperator == Operator::Equal)
+                return context.astArena.create<BooleanLiteral>(context, leftBoolean->getValue() == rightBoolean->getValue(), mToken);
+            if (mOperator == Operator::NotEqual)
+                return context.astArena.create<BooleanLiteral>(context, leftBoolean->getValue() != rightBoolean->getValue(), mToken);
+            return nullptr;
+        }
+
+        auto leftInteger = dynamic_cast<IntegerLiteral*>(mLeft.get());
+        auto rightInteger = dynamic_cast<IntegerLiteral*>(mRight.get());
+        if (!leftInteger || !rightInteger || !mLeft->getType()->isIntegerType())
+        {
+            return nullptr;
+        }
+
+        auto operandType = static_cast<IntegerType*>(mLeft->getType());
+        if (mOperator == Operator::Div && operandType->wrap(rightInteger->getValue()) == 0)
+        {
+            diag.compilerWarning(mToken.getStart(), mToken.getEnd(), "division by zero");
+            return nullptr;
+        }
+
+        std::optional<std::intmax_t> result = applyOperator(mOperator, leftInteger->getValue(), rightInteger->getValue());
+        if (!result)
+        {
+            return nullptr;
+        }
+
+        if (mType->isBooleanType())
+        {
+            return context.astArena.create<BooleanLiteral>(context, *result != 0, mToken);
+        }
+        return context.astArena.create<IntegerLiteral>(*result, mType, mToken);
+    }
+
+    // Applies op to two values of the left operand's integer type the way
+    // it would run, wrapping around at the width of the type and comparing
+    // by its signedness. Comparisons give 0 or 1, and division by zero gives
+    // nullopt. AddAssign and SubAssign are treated as Add and Sub
+    std::optional<std::intmax_t> BinaryExpression::applyOperator(Operator op, std::intmax_t lhsValue, std::intmax_t rhsValue) const
+    {
+        auto operandType = static_cast<IntegerType*>(mLeft->getType());
+        std::intmax_t left = operandType->wrap(lhsValue);
+        std::intmax_t right = operandType->wrap(rhsValue);
+
+        // Unsigned values are zero extended by wrap, so comparing their bit patterns as unsigned orders them correctly
+        auto less = [operandType](std::intmax_t lhs, std::intmax_t rhs) {
+            if (operandType->isSigned()) return lhs < rhs;
+            return static_cast<std::uintmax_t>(lhs) < static_cast<std::uintmax_t>(rhs);
+        };
+
+        switch (op)
+        {
+            case Operator::Equal:
+                return left == right;
+            case Operator::NotEqual:
+                return left != right;
+            case Operator::LessThan:
+                return less(left, right);
+            case Operator::GreaterThan:
+                return less(right, left);
+            case Operator::LessEqual:
+                return !less(right, left);
+            case Operator::GreaterEqual:
+                return !less(left, right);
+            default:
+                break;
+        }
+
+        // Two's complement arithmetic is the same for signed and unsigned
+        // values, and unsigned overflow is well defined
+        std::uintmax_t lhs = left;
+        std::uintmax_t rhs = right;
+        std::uintmax_t result;
+        switch (op)
+        {
+            case Operator::Add:
+            case Operator::AddAssign:
+                result = lhs + rhs;
+                break;
+            case Operator::Sub:
+            case Operator::SubAssign:
+                result = lhs - rhs;
+                break;
+            case Operator::Mul:
+                result = lhs * rhs;
+                break;
+            case Operator::Div:
+                if (right == 0)
+                {
+                    return std::nullopt;
+                }
+                if (operandType->isSigned())
+                {
+                    result = right == -1 ? 0 - lhs : static_cast<std::uintmax_t>(left / right); // dividing the minimum by -1 wraps
+                }
+                else
+                {
+                    result = lhs / rhs;
+                }
+                break;
+            case Operator::BitwiseOr:
+                result = lhs | rhs;
+                break;
+            case Operator::BitwiseAnd:
+                result = lhs & rhs;
+                break;
+            case Operator::BitwiseXor:
+                result = lhs ^ rhs;
+                break;
+            default:
+                return std::nullopt;
+        }
+
+        return operandType->wrap(result);
+    }
+
+    // Algebraic identities where one side is a literal, or both sides read
+    // the same variable. An operand only replaces the whole expression when
+    // it already has the expression's type, and one is only dropped when it
+    // can't have side effects
+    ASTNodePtr BinaryExpression::simplify(CompilerContext& context)
+    {
+        if (!mType->isIntegerType() && !mType->isPointerType() && !mType->isBooleanType())
+        {
+            return nullptr;
+        }
+
+        auto keep = [this](ASTNodePtr& operand) -> ASTNodePtr {
+            if (operand->getType() != mType) return nullptr;
+            return std::move(operand);
+        };
+        auto integer = [this, &context](ASTNodePtr& other, std::intmax_t value) -> ASTNodePtr {
+            if (!mType->isIntegerType() || HasSideEffects(other.get())) return nullptr;
+            return context.astArena.create<IntegerLiteral>(value, mType, mToken);
+        };
+        auto boolean = [this, &context](bool value) -> ASTNodePtr {
+            return context.astArena.create<BooleanLiteral>(context, value, mToken);
+        };
+
+        bool same = IsSameVariable(mLeft.get(), mRight.get());
+        switch (mOperator)
+        {
+            case Operator::Add:
+            case Operator::BitwiseOr:
+            case Operator::BitwiseXor:
+                if (IsIntegerLiteral(mRight.get(), 0)) return keep(mLeft);
+                if (IsIntegerLiteral(mLeft.get(), 0)) return keep(mRight);
+                if (same && mOperator == Operator::BitwiseOr) return keep(mLeft);
+                if (same && mOperator == Operator::BitwiseXor) return integer(mLeft, 0);
+                break;
+
+            case Operator::Sub:
+                if (IsIntegerLiteral(mRight.get(), 0)) return keep(mLeft);
+                if (same) return integer(mLeft, 0);
+                break;
+
+            case Operator::Mul:
+                if (IsIntegerLiteral(mRight.get(), 1)) return keep(mLeft);
+                if (IsIntegerLiteral(mLeft.get(), 1)) return keep(mRight);
+                if (IsIntegerLiteral(mRight.get(), 0)) return integer(mLeft, 0);
+                if (IsIntegerLiteral(mLeft.get(), 0)) return integer(mRight, 0);
+                break;
+
+            case Operator::Div:
+                if (IsIntegerLiteral(mRight.get(), 1)) return keep(mLeft);
+                break;
+
+            case Operator::BitwiseAnd:
+                if (IsIntegerLiteral(mRight.get(), -1)) return keep(mLeft);
+                if (IsIntegerLiteral(mLeft.get(), -1)) return keep(mRight);
+                if (IsIntegerLiteral(mRight.get(), 0)) return integer(mLeft, 0);
+                if (IsIntegerLiteral(mLeft.get(), 0)) return integer(mRight, 0);
+                if (same) return keep(mLeft);
+                break;
+
+            case Operator::Equal:
+            case Operator::LessEqual:
+            case Operator::GreaterEqual:
+                if (same) return boolean(true);
+                break;
+
+            case Operator::NotEqual:
+            case Operator::LessThan:
+            case Operator::GreaterThan:
+                if (same) return boolean(false);
+                break;
+
+            default:
+                break;
+        }
+        return nullptr;
+    }
+
+    std::optional<ConstantValue> BinaryExpression::evaluate(ConstantEvaluator& evaluator)
+    {
+        switch (mOperator)
+        {
+            case Operator::Assign:
+            {
+                std::optional<ConstantValue> value = evaluator.evaluate(mRight.get());
+                if (!value) return std::nullopt;
+
+                ConstantValue* target = evaluator.evaluateAddress(mLeft.get());
+                if (!target) return std::nullopt;
+
+                *target = *value;
+                return value;
+            }
+            case Operator::AddAssign:
+            case Operator::SubAssign:
+            {
+                if (!mLeft->getType()->isIntegerType()) return std::nullopt;
+
+                std::optional<ConstantValue> value = evaluator.evaluate(mRight.get());
+                if (!value) return std::nullopt;
+
+                ConstantValue* target = evaluator.evaluateAddress(mLeft.get());
+                if (!target || !target->type) return std::nullopt;
+
+                std::optional<std::intmax_t> result = applyOperator(mOperator, target->integer, value->integer);
+                if (!result) return std::nullopt;
+
+                target->integer = *result;
+                return *target;
+            }
+
+            case Operator::ArrayAccess:
+            {
+                // Indexing a variable in place saves copying the whole array
+                if (ConstantValue* element = evaluateAddress(evaluator))
+                {
+                    if (!element->type) return std::nullopt;
+                    return *element;
+                }
+
+                std::optional<ConstantValue> array = evaluator.evaluate(mLeft.get());
+                if (!array) return std::nullopt;
+
+                std::optional<ConstantValue> index = evaluator.evaluate(mRight.get());
+                if (!index) return std::nullopt;
+
+                return *ElementAt(*array, *index, mToken, evaluator.getDiagnostics());
+            }
+
+            default:
+                break;
+        }
+
+        std::optional<ConstantValue> left = evaluator.evaluate(mLeft.get());
+        if (!left) return std::nullopt;
+
+        std::optional<ConstantValue> right = evaluator.evaluate(mRight.get());
+        if (!right) return std::nullopt;
+
+        if (mLeft->getType()->isBooleanType())
+        {
+            if (mOperator == Operator::Equal)
+                return ConstantValue{ mType, left->integer == right->integer };
+            if (mOperator == Operator::NotEqual)
+                return ConstantValue{ mType, left->integer != right->integer };
+            return std::nullopt;
+        }
+
+        if (!mLeft->getType()->isIntegerType()) return std::nullopt;
+
+        std::optional<std::intmax_t> result = applyOperator(mOperator, left->integer, right->integer);
+        if (!result) return std::nullopt;
+
+        return ConstantValue{ mType, *result };
+    }
+
+    ConstantValue* BinaryExpression::evaluateAddress(ConstantEvaluator& evaluator)
+    {
+        if (mOperator != Operator::ArrayAccess) return nullptr;
+
+        // The array goes first, since it can't have side effects if it isn't an lvalue
+        ConstantValue* array = evaluator.evaluateAddress(mLeft.get());
+        if (!array || !array->type) return nullptr;
+
+        std::optional<ConstantValue> index = evaluator.evaluate(mRight.get());
+        if (!index) return nullptr;
+
+        return ElementAt(*array, *index, mToken, evaluator.getDiagnostics());
+    }
+
+    void BinaryExpression::forEachChild(const std::function<void(ASTNode*)>& callback)
+    {
+        callback(mLeft.get());
+        callback(mRight.get());
+    }
 }
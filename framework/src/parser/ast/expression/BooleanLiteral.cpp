@@ -6,10 +6,10 @@
 
 namespace parser
 {
-    BooleanLiteral::BooleanLiteral(bool value, lexing::Token token)
+    BooleanLiteral::BooleanLiteral(CompilerContext& context, bool value, lexing::Token token)
         : mValue(value)
     {
-        mType = Type::Get("bool");
+        mType = Type::GetBooleanType(context);
         mPreferredDebugToken = std::move(token);
     }
 
@@ -18,7 +18,7 @@ namespace parser
         return mValue;
     }
 
-    void BooleanLiteral::typeCheck(Scope* scope, diagnostic::Diagnostics& diag)
+    void BooleanLiteral::typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
         // something has seriously gone wrong if this is true
         if (!mType->isBooleanType())
@@ -28,8 +28,13 @@ namespace parser
         }
     }
 
-    vipir::Value* BooleanLiteral::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag)
+    vipir::Value* BooleanLiteral::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
         return builder.CreateConstantBool(mValue);
     }
-}
\ No newline at end of file
+
+    std::optional<ConstantValue> BooleanLiteral::evaluate(ConstantEvaluator& evaluator)
+    {
+        return ConstantValue{ mType, mValue };
+    }
+}
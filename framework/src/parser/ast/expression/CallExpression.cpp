@@ -2,6 +2,9 @@
 
 
 #include "parser/ast/expression/CallExpression.h"
+#include "parser/ast/ConstantEvaluator.h"
+#include "parser/ast/Inliner.h"
+#include "parser/ast/global/Function.h"
 #include "parser/ast/expression/MemberAccess.h"
 #include "parser/ast/expression/VariableExpression.h"
 #include "parser/ast/expression/ScopeResolution.h"
@@ -24,9 +27,10 @@
 
 namespace parser
 {
-    CallExpression::CallExpression(ASTNodePtr function, std::vector<ASTNodePtr> parameters, lexing::Token token)
+    CallExpression::CallExpression(CompilerContext& context, ASTNodePtr function, std::vector<ASTNodePtr> parameters, lexing::Token token)
         : mFunction(std::move(function))
         , mParameters(std::move(parameters))
+        , mCallee(nullptr)
     {
         if (MemberAccess* member = dynamic_cast<MemberAccess*>(mFunction.get()))
         {
@@ -41,24 +45,50 @@ namespace parser
             structNames.push_back(methodName);
 
             if (member->mStruct->getType()->isStructType())
-                manglingArguments.insert(manglingArguments.begin(), PointerType::Create(member->mStruct->getType()));
+                manglingArguments.insert(manglingArguments.begin(), PointerType::Create(context, member->mStruct->getType()));
             else
                 manglingArguments.insert(manglingArguments.begin(), member->mStruct->getType());
 
-            FunctionSymbol* func = FindFunction(structNames, structNames, manglingArguments);
-            mFunctionType = func->type;
+            // A missing method is reported by typeCheck. Until then the call
+            // is given the void type so that enclosing nodes still have one
+            mCallee = FindFunction(context, structNames, structNames, manglingArguments);
+            mFunctionType = mCallee ? mCallee->type : nullptr;
         }
         else
         {
             mFunctionType = static_cast<FunctionType*>(mFunction->getType());
         }
 
-        mType = mFunctionType->getReturnType();
+        mType = mFunctionType ? mFunctionType->getReturnType() : Type::GetVoidType(context);
         mPreferredDebugToken = mFunction->getDebugToken();
     }
 
-    void CallExpression::typeCheck(Scope* scope, diagnostic::Diagnostics& diag)
+    FunctionSymbol* CallExpression::getCallee() const
     {
+        return mCallee;
+    }
+
+    void CallExpression::typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
+    {
+        MemberAccess* member = dynamic_cast<MemberAccess*>(mFunction.get());
+        if (member)
+        {
+            member->mStruct->typeCheck(scope, context, diag);
+
+            if (mCallee == nullptr)
+            {
+                diag.compilerError(member->mFieldToken.getStart(), member->mFieldToken.getEnd(), std::format("'{}struct {}{}' has no member named '{}{}{}'",
+                    fmt::bold, member->mStructType->getName(), fmt::defaults, fmt::bold, member->mField, fmt::defaults));
+            }
+            if (mCallee->priv && scope->findOwner() != member->mStructType)
+            {
+                diag.compilerError(member->mFieldToken.getStart(), member->mFieldToken.getEnd(), std::format("'{}{}{}' is a private member of '{}struct {}{}'",
+                    fmt::bold, member->mField, fmt::defaults, fmt::bold, member->mStructType->getName(), fmt::defaults));
+            }
+            mFunctionType = mCallee->type;
+        }
+
+        std::vector<Type*> manglingArguments;
         int index = 0;
         for (auto& param : mParameters)
         {
@@ -68,42 +98,49 @@ namespace parser
                     fmt::bold, mFunctionType->getArgumentTypes()[index]->getName(), fmt::defaults,
                     fmt::bold, param->getType()->getName(), fmt::defaults));
             }
-            param->typeCheck(scope, diag);
+            param->typeCheck(scope, context, diag);
+            manglingArguments.push_back(param->getType());
             ++index;
         }
-    }
 
-    vipir::Value* CallExpression::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag)
-    {
-        std::vector<Type*> manglingArguments;
-        std::vector<vipir::Value*> parameters;
-        for (auto& parameter : mParameters)
+        if (member)
         {
-            manglingArguments.push_back(parameter->getType());
-            parameters.push_back(parameter->emit(builder, module, scope, diag));
+            return;
         }
 
-        auto namespaceNames = scope->getNamespaces();
-
         if (VariableExpression* variable = dynamic_cast<VariableExpression*>(mFunction.get()))
         {
-            std::string name = variable->mName;
-
-            vipir::Function* function = FindFunction({name}, namespaceNames, manglingArguments)->function;
-
-            return builder.CreateCall(function, std::move(parameters));
+            mCallee = FindFunction(context, {variable->mName}, Scope::GetNamespaces(scope), std::move(manglingArguments));
+            if (!mCallee)
+            {
+                mFunction->typeCheck(scope, context, diag);
+            }
         }
-        else if (MemberAccess* member = dynamic_cast<MemberAccess*>(mFunction.get()))
+        else if (auto scopeRes = dynamic_cast<ScopeResolution*>(mFunction.get()))
         {
-            StructType* structType = member->mPointer
-                ? static_cast<StructType*>(static_cast<PointerType*>(member->mStruct->getType())->getBaseType())
-                : static_cast<StructType*>(member->mStruct->getType());
-            std::string methodName = member->mField;
+            mCallee = FindFunction(context, scopeRes->getNames(), Scope::GetNamespaces(scope), std::move(manglingArguments));
+            if (!mCallee)
+            {
+                mFunction->typeCheck(scope, context, diag);
+            }
+        }
+        else
+        {
+            mFunction->typeCheck(scope, context, diag);
+        }
+    }
 
-            std::vector<std::string> structNames = structType->getNames();
-            structNames.push_back(methodName);
+    vipir::Value* CallExpression::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
+    {
+        std::vector<vipir::Value*> parameters;
+        for (auto& parameter : mParameters)
+        {
+            parameters.push_back(parameter->emit(builder, module, scope, context, diag));
+        }
 
-            vipir::Value* value = member->mStruct->emit(builder, module, scope, diag);
+        if (MemberAccess* member = dynamic_cast<MemberAccess*>(mFunction.get()))
+        {
+            vipir::Value* value = member->mStruct->emit(builder, module, scope, context, diag);
 
             if (member->mStruct->getType()->isStructType())
             {
@@ -120,47 +157,74 @@ namespace parser
                 {
                     value = builder.CreateAddrOf(self);
                 }
-
-                parameters.insert(parameters.begin(), value);
-                manglingArguments.insert(manglingArguments.begin(), PointerType::Create(member->mStruct->getType()));
-            }
-            else
-            {
-                mParameters.insert(mParameters.begin(), std::move(member->mStruct));
-                parameters.insert(parameters.begin(), value);
-                manglingArguments.insert(manglingArguments.begin(), mParameters[0]->getType());
             }
+            parameters.insert(parameters.begin(), value);
+        }
 
-            FunctionSymbol* func = FindFunction(structNames, namespaceNames, manglingArguments);
+        if (mCallee)
+        {
+            // Only a call inside a function body has somewhere to inline into
+            bool inFunction = scope && scope->function && scope->function->allocaBlock;
 
-            if (func == nullptr)
+            if (inFunction && mCallee->definition && mCallee->definition->shouldInline())
             {
-                diag.compilerError(member->mFieldToken.getStart(), member->mFieldToken.getEnd(), std::format("'{}struct {}{}' has no member named '{}{}{}'",
-                    fmt::bold, structType->getName(), fmt::defaults, fmt::bold, methodName, fmt::defaults));
+                return mCallee->definition->emitInline(builder, module, scope, std::move(parameters), context);
             }
-            if (func->priv && scope->findOwner() != structType)
+
+            StructMethod* method = mCallee->method;
+            Type* returnType = method ? static_cast<FunctionType*>(method->type)->getReturnType() : nullptr;
+            if (inFunction && method && Inliner::ShouldInline(method->body, returnType, method->attributes, method->scope.get()))
             {
-                diag.compilerError(member->mFieldToken.getStart(), member->mFieldToken.getEnd(), std::format("'{}{}{}' is a private member of '{}struct {}{}'",
-                fmt::bold, member->mField, fmt::defaults, fmt::bold, structType->getName(), fmt::defaults));
-            }
+                std::vector<std::pair<LocalSymbol*, vipir::Value*> > arguments { {method->self, parameters[0]} };
+                for (std::size_t i = 0; i < method->arguments.size(); ++i)
+                {
+                    arguments.push_back({method->arguments[i].symbol, parameters[i + 1]});
+                }
 
-            vipir::Function* function = func->function;
+                return Inliner::EmitBody(builder, module, context, *method->diag, method->body, returnType, method->scope.get(), scope, arguments);
+            }
 
-            return builder.CreateCall(function, std::move(parameters));
+            return builder.CreateCall(mCallee->function, std::move(parameters));
         }
-        else if (auto scopeRes = dynamic_cast<ScopeResolution*>(mFunction.get()))
-        {
-            auto names = scopeRes->getNames();
 
-            FunctionSymbol* func = FindFunction(names, namespaceNames, manglingArguments);
+        vipir::Function* function = static_cast<vipir::Function*>(mFunction->emit(builder, module, scope, context, diag));
+
+        return builder.CreateCall(function, std::move(parameters));
+    }
 
-            return builder.CreateCall(func->function, std::move(parameters));
+    ASTNodePtr CallExpression::fold(CompilerContext& context, diagnostic::Diagnostics& diag)
+    {
+        Fold(mFunction, context, diag);
+        for (auto& parameter : mParameters)
+        {
+            Fold(parameter, context, diag);
         }
-        else
+        return nullptr;
+    }
+
+    std::optional<ConstantValue> CallExpression::evaluate(ConstantEvaluator& evaluator)
+    {
+        // Only plain functions with a body in this module can be run
+        if (!mCallee || !mCallee->definition) return std::nullopt;
+
+        std::vector<ConstantValue> arguments;
+        for (auto& parameter : mParameters)
         {
-            vipir::Function* function = static_cast<vipir::Function*>(mFunction->emit(builder, module, scope, diag));
+            std::optional<ConstantValue> argument = evaluator.evaluate(parameter.get());
+            if (!argument) return std::nullopt;
 
-            return builder.CreateCall(function, std::move(parameters));
+            arguments.push_back(std::move(*argument));
+        }
+
+        return mCallee->definition->evaluateCall(evaluator, std::move(arguments));
+    }
+
+    void CallExpression::forEachChild(const std::function<void(ASTNode*)>& callback)
+    {
+        callback(mFunction.get());
+        for (auto& parameter : mParameters)
+        {
+            callback(parameter.get());
         }
     }
 }
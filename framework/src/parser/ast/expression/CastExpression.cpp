@@ -2,6 +2,10 @@
 
 
 #include "parser/ast/expression/CastExpression.h"
+#include "parser/ast/ConstantEvaluator.h"
+#include "parser/ast/expression/IntegerLiteral.h"
+
+#include "context/CompilerContext.h"
 
 #include "type/IntegerType.h"
 
@@ -21,15 +25,15 @@ namespace parser
         mType = destType;
     }
 
-    void CastExpression::typeCheck(Scope* scope, diagnostic::Diagnostics& diag)
+    void CastExpression::typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
-        mOperand->typeCheck(scope, diag);
+        mOperand->typeCheck(scope, context, diag);
         // maybe check for type compatibility here in future
     }
 
-    vipir::Value* CastExpression::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag)
+    vipir::Value* CastExpression::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
-        vipir::Value* operand = mOperand->emit(builder, module, scope, diag);
+        vipir::Value* operand = mOperand->emit(builder, module, scope, context, diag);
         if (mOperand->getType() == mType)
         {
             diag.compilerWarning(mToken.getStart(), mToken.getEnd(), std::format("cast from '{}{}{}' to itself has no effect", fmt::bold, mType->getName(), fmt::defaults));
@@ -99,4 +103,35 @@ namespace parser
         diag.compilerError(mToken.getStart(), mToken.getEnd(), std::format("value has type '{}{}{}' which cannot be converted to '{}{}{}",
             fmt::bold, mOperand->getType()->getName(), fmt::defaults, fmt::bold, mType->getName(), fmt::defaults));
     }
-}
\ No newline at end of file
+
+    ASTNodePtr CastExpression::fold(CompilerContext& context, diagnostic::Diagnostics& diag)
+    {
+        Fold(mOperand, context, diag);
+
+        // Casts to the same type are left for emit to warn about
+        auto integer = dynamic_cast<IntegerLiteral*>(mOperand.get());
+        if (integer && mOperand->getType() != mType && mOperand->getType()->isIntegerType() && mType->isIntegerType())
+        {
+            // Extending from the operand's width first gives the sign or zero extension emit would
+            std::intmax_t value = static_cast<IntegerType*>(mOperand->getType())->wrap(integer->getValue());
+            return context.astArena.create<IntegerLiteral>(static_cast<IntegerType*>(mType)->wrap(value), mType, mToken);
+        }
+        return nullptr;
+    }
+
+    std::optional<ConstantValue> CastExpression::evaluate(ConstantEvaluator& evaluator)
+    {
+        if (!mOperand->getType()->isIntegerType() || !mType->isIntegerType()) return std::nullopt;
+
+        std::optional<ConstantValue> operand = evaluator.evaluate(mOperand.get());
+        if (!operand) return std::nullopt;
+
+        // The operand is already wrapped to its own type, so this extends or truncates it the way emit would
+        return ConstantValue{ mType, static_cast<IntegerType*>(mType)->wrap(operand->integer) };
+    }
+
+    void CastExpression::forEachChild(const std::function<void(ASTNode*)>& callback)
+    {
+        callback(mOperand.get());
+    }
+}
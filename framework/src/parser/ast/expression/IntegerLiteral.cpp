@@ -2,6 +2,8 @@
 
 #include "parser/ast/expression/IntegerLiteral.h"
 
+#include "type/IntegerType.h"
+
 #include <vipir/IR/Constant/ConstantInt.h>
 
 namespace parser
@@ -9,7 +11,7 @@ namespace parser
     IntegerLiteral::IntegerLiteral(intmax_t value, Type* type, lexing::Token token)
         : mValue(value)
     {
-        mType = type ? type : Type::Get("i32");
+        mType = type;
         mPreferredDebugToken = std::move(token);
     }
 
@@ -18,7 +20,7 @@ namespace parser
         return mValue;
     }
 
-    void IntegerLiteral::typeCheck(Scope* scope, diagnostic::Diagnostics& diag)
+    void IntegerLiteral::typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
         if (!mType->isIntegerType())
         {
@@ -27,8 +29,15 @@ namespace parser
         }
     }
 
-    vipir::Value* IntegerLiteral::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag)
+    vipir::Value* IntegerLiteral::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
         return vipir::ConstantInt::Get(module, mValue, mType->getVipirType());
     }
-}
\ No newline at end of file
+
+    std::optional<ConstantValue> IntegerLiteral::evaluate(ConstantEvaluator& evaluator)
+    {
+        if (!mType->isIntegerType()) return std::nullopt;
+
+        return ConstantValue{ mType, static_cast<IntegerType*>(mType)->wrap(mValue) };
+    }
+}
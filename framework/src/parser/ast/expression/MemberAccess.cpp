@@ -2,6 +2,7 @@
 
 
 #include "parser/ast/expression/MemberAccess.h"
+#include "parser/ast/ConstantEvaluator.h"
 
 #include "type/StructType.h"
 #include "type/PointerType.h"
@@ -23,79 +24,106 @@ namespace parser
         , mField(field)
         , mPointer(pointer)
         , mFieldToken(std::move(fieldToken))
+        , mFieldIndex(-1)
     {
-
-        StructType* structType;
         if (mPointer)
         {
-            structType = static_cast<StructType*>(static_cast<PointerType*>(mStruct->getType())->getBaseType());
+            mStructType = static_cast<StructType*>(static_cast<PointerType*>(mStruct->getType())->getBaseType());
         }
         else
         {
-            structType = static_cast<StructType*>(mStruct->getType());
+            mStructType = static_cast<StructType*>(mStruct->getType());
         }
 
-        auto structField = structType->getField(mField);
+        auto structField = mStructType->getField(mField);
         if (structField)
             mType = structField->type;
 
         mPreferredDebugToken = mFieldToken;
     }
 
-    void MemberAccess::typeCheck(Scope* scope, diagnostic::Diagnostics& diag)
+    void MemberAccess::typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
-        mStruct->typeCheck(scope, diag);
+        mStruct->typeCheck(scope, context, diag);
+
+        mFieldIndex = mStructType->getFieldIndex(mField);
+        if (mFieldIndex == static_cast<int>(mStructType->getFields().size()))
+        {
+            diag.compilerError(mFieldToken.getStart(), mFieldToken.getEnd(), std::format("'{}struct {}{}' has no member named '{}{}{}'",
+                fmt::bold, mStructType->getName(), fmt::defaults, fmt::bold, mField, fmt::defaults));
+        }
+        if (mStructType->getFields()[mFieldIndex].priv && scope->findOwner() != mStructType)
+        {
+            diag.compilerError(mFieldToken.getStart(), mFieldToken.getEnd(), std::format("'{}{}{}' is a private member of '{}struct {}{}'",
+                fmt::bold, mField, fmt::defaults, fmt::bold, mStructType->getName(), fmt::defaults));
+        }
     }
 
-    vipir::Value* MemberAccess::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag)
+    vipir::Value* MemberAccess::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
         vipir::Value* struc;
         if (mPointer)
         {
-            struc = mStruct->emit(builder, module, scope, diag);
+            struc = mStruct->emit(builder, module, scope, context, diag);
         }
         else
         {
-            vipir::Value* structValue = mStruct->emit(builder, module, scope, diag);
+            vipir::Value* structValue = mStruct->emit(builder, module, scope, context, diag);
             struc = vipir::getPointerOperand(structValue);
 
             vipir::Instruction* instruction = static_cast<vipir::Instruction*>(structValue);
             instruction->eraseFromParent();
         }
 
-        StructType* structType;
-        if (mPointer)
-        {
-            structType = static_cast<StructType*>(static_cast<PointerType*>(mStruct->getType())->getBaseType());
-        }
-        else
-        {
-            structType = static_cast<StructType*>(mStruct->getType());
-        }
-
-        if (!structType->hasField(mField))
-        {
-            diag.compilerError(mFieldToken.getStart(), mFieldToken.getEnd(), std::format("'{}struct {}{}' has no member named '{}{}{}'",
-                fmt::bold, structType->getName(), fmt::defaults, fmt::bold, mField, fmt::defaults));
-        }
-        if (structType->getField(mField)->priv && scope->findOwner() != structType)
-        {
-            diag.compilerError(mFieldToken.getStart(), mFieldToken.getEnd(), std::format("'{}{}{}' is a private member of '{}struct {}{}'",
-                fmt::bold, mField, fmt::defaults, fmt::bold, structType->getName(), fmt::defaults));
-        }
-
-        vipir::Value* gep = builder.CreateStructGEP(struc, structType->getFieldOffset(mField));
+        const StructType::Field& field = mStructType->getFields()[mFieldIndex];
+        vipir::Value* gep = builder.CreateStructGEP(struc, mStructType->getFieldElement(mFieldIndex));
 
         // struct types with a pointer to themselves cannot be emitted normally
-        if (structType->getField(mField)->type->isPointerType())
+        if (field.type->isPointerType())
         {
-            if (static_cast<PointerType*>(structType->getField(mField)->type)->getBaseType() == structType)
+            if (static_cast<PointerType*>(field.type)->getBaseType() == mStructType)
             {
-                vipir::Type* type = vipir::PointerType::GetPointerType(vipir::PointerType::GetPointerType(structType->getVipirType()));
+                vipir::Type* type = vipir::PointerType::GetPointerType(vipir::PointerType::GetPointerType(mStructType->getVipirType()));
                 gep = builder.CreatePtrCast(gep, type);
             }
         }
 
         return builder.CreateLoad(gep);
     }
+
+    ASTNodePtr MemberAccess::fold(CompilerContext& context, diagnostic::Diagnostics& diag)
+    {
+        Fold(mStruct, context, diag);
+        return nullptr;
+    }
+
+    std::optional<ConstantValue> MemberAccess::evaluate(ConstantEvaluator& evaluator)
+    {
+        // Reading a field of a variable in place saves copying the whole struct
+        if (ConstantValue* field = evaluateAddress(evaluator))
+        {
+            return *field;
+        }
+        if (mPointer) return std::nullopt;
+
+        std::optional<ConstantValue> structValue = evaluator.evaluate(mStruct.get());
+        if (!structValue) return std::nullopt;
+
+        return structValue->elements[mFieldIndex];
+    }
+
+    ConstantValue* MemberAccess::evaluateAddress(ConstantEvaluator& evaluator)
+    {
+        if (mPointer) return nullptr;
+
+        ConstantValue* structValue = evaluator.evaluateAddress(mStruct.get());
+        if (!structValue || !structValue->type) return nullptr;
+
+        return &structValue->elements[mFieldIndex];
+    }
+
+    void MemberAccess::forEachChild(const std::function<void(ASTNode*)>& callback)
+    {
+        callback(mStruct.get());
+    }
 }
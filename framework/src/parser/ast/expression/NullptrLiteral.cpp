@@ -10,11 +10,11 @@ namespace parser
 {
     NullptrLiteral::NullptrLiteral(Type* type, lexing::Token token)
     {
-        mType = type ? type : PointerType::Create(Type::Get("i8"));
+        mType = type;
         mPreferredDebugToken = std::move(token);
     }
 
-    void NullptrLiteral::typeCheck(Scope* scope, diagnostic::Diagnostics& diag)
+    void NullptrLiteral::typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
         if (!mType->isPointerType())
         {
@@ -23,7 +23,7 @@ namespace parser
         }
     }
 
-    vipir::Value* NullptrLiteral::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag)
+    vipir::Value* NullptrLiteral::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
         return vipir::ConstantNullPtr::Get(module, mType->getVipirType());
     }
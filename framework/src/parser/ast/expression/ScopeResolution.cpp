@@ -3,41 +3,53 @@
 
 #include "parser/ast/expression/ScopeResolution.h"
 
+#include "parser/ast/statement/ConstexprStatement.h"
+
 #include <iostream>
 
 #include "parser/ast/expression/VariableExpression.h"
 
+#include "context/CompilerContext.h"
+
 #include "symbol/Identifier.h"
 
 #include <vipir/IR/Instruction/LoadInst.h>
 
 namespace parser
 {
-    ScopeResolution::ScopeResolution(ASTNodePtr left, lexing::Token token, ASTNodePtr right)
+    ScopeResolution::ScopeResolution(CompilerContext& context, ASTNodePtr left, lexing::Token token, ASTNodePtr right)
         : mLeft(std::move(left))
         , mToken(std::move(token))
         , mRight(std::move(right))
+        , mGlobal(nullptr)
     {
-        std::vector<std::string> symbols = symbol::GetSymbol(getNames(), getNames());
+        std::vector<std::string> symbols = symbol::GetSymbol(context, getNames(), getNames());
         
         for (auto symbol : symbols)
         {
-            if (GlobalVariables.contains(symbol))
+            if (context.globals.contains(symbol))
             {
-                mType = GlobalVariables[symbol].type;
+                mType = context.globals[symbol].type;
             }
-            else if (GlobalFunctions.contains(symbol))
+            else if (context.functions.contains(symbol))
             {
-                mType = GlobalFunctions[symbol].type;
+                mType = context.functions[symbol].type;
             }
         }
         mPreferredDebugToken = token;
     }
 
-    void ScopeResolution::typeCheck(Scope* scope, diagnostic::Diagnostics& diag)
+    void ScopeResolution::typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
-        mLeft->typeCheck(scope, diag);
-        mRight->typeCheck(scope, diag);
+        // mLeft and mRight only spell out the name, so there's nothing in them to check
+        for (auto& symbol : symbol::GetSymbol(context, getNames(), Scope::GetNamespaces(scope)))
+        {
+            if (auto it = context.globals.find(symbol); it != context.globals.end())
+            {
+                mGlobal = &it->second;
+                return;
+            }
+        }
     }
 
     std::vector<std::string> ScopeResolution::getNames()
@@ -61,23 +73,42 @@ namespace parser
         return ret;
     }
 
-    vipir::Value* ScopeResolution::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag)
+    vipir::Value* ScopeResolution::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
-        std::vector<std::string> symbols = symbol::GetSymbol(getNames(), scope->getNamespaces());
-        
-        for (auto symbol : symbols)
+        if (mGlobal)
         {
-            if (GlobalVariables.find(symbol) != GlobalVariables.end())
-            {
-                vipir::Value* value = GlobalVariables[symbol].global;
-                if (value->isConstant()) return value;
+            vipir::Value* value = mGlobal->global;
+            if (value->isConstant()) return value;
 
-                if (value->getType()->isPointerType()) return builder.CreateLoad(value); // TODO: Something better than this
-            }
+            if (value->getType()->isPointerType()) return builder.CreateLoad(value); // TODO: Something better than this
         }
 
         diag.compilerError(mToken.getStart(), mToken.getEnd(), std::format("unknown identifier '{}{}{}'", fmt::bold, getNames().back(), fmt::defaults));
 
         return nullptr;
     }
-}
\ No newline at end of file
+
+    ASTNodePtr ScopeResolution::fold(CompilerContext& context, diagnostic::Diagnostics& diag)
+    {
+        if (mGlobal && mGlobal->constexprDefinition)
+        {
+            return mGlobal->constexprDefinition->foldUse(mToken, context, diag);
+        }
+        return nullptr;
+    }
+
+    std::optional<ConstantValue> ScopeResolution::evaluate(ConstantEvaluator& evaluator)
+    {
+        if (mGlobal && mGlobal->constexprDefinition)
+        {
+            return mGlobal->constexprDefinition->evaluateUse(evaluator);
+        }
+        return std::nullopt;
+    }
+
+    void ScopeResolution::forEachChild(const std::function<void(ASTNode*)>& callback)
+    {
+        callback(mLeft.get());
+        callback(mRight.get());
+    }
+}
@@ -1,4 +1,7 @@
 #include "parser/ast/expression/SizeofExpression.h"
+#include "parser/ast/expression/IntegerLiteral.h"
+
+#include "context/CompilerContext.h"
 
 #include <vipir/IR/Constant/ConstantInt.h>
 
@@ -7,11 +10,11 @@ namespace parser
     SizeofExpression::SizeofExpression(Type* expressionType, Type* type, lexing::Token token)
         : mTypeToSize(type)
     {
-        mType = expressionType ? expressionType : Type::Get("i32");
+        mType = expressionType;
         mPreferredDebugToken = std::move(token);
     }
 
-    void SizeofExpression::typeCheck(Scope* scope, diagnostic::Diagnostics& diag)
+    void SizeofExpression::typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
         if (!mType->isIntegerType())
         {
@@ -20,8 +23,18 @@ namespace parser
         }
     }
 
-    vipir::Value* SizeofExpression::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag)
+    vipir::Value* SizeofExpression::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
         return vipir::ConstantInt::Get(module, mTypeToSize->getSize() / 8, mType->getVipirType());
     }
-}
\ No newline at end of file
+
+    ASTNodePtr SizeofExpression::fold(CompilerContext& context, diagnostic::Diagnostics& diag)
+    {
+        return context.astArena.create<IntegerLiteral>(mTypeToSize->getSize() / 8, mType, mPreferredDebugToken);
+    }
+
+    std::optional<ConstantValue> SizeofExpression::evaluate(ConstantEvaluator& evaluator)
+    {
+        return ConstantValue{ mType, mTypeToSize->getSize() / 8 };
+    }
+}
@@ -10,14 +10,14 @@
 
 namespace parser
 {
-    StringLiteral::StringLiteral(std::string value, lexing::Token token)
+    StringLiteral::StringLiteral(CompilerContext& context, std::string value, lexing::Token token)
         : mValue(value)
     {
-        mType = PointerType::Create(Type::Get("i8"));
+        mType = PointerType::Create(context, Type::GetIntegerType(context, 8, true));
         mPreferredDebugToken = std::move(token);
     }
 
-    void StringLiteral::typeCheck(Scope* scope, diagnostic::Diagnostics& diag)
+    void StringLiteral::typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
         if (!mType->isPointerType() || !static_cast<PointerType*>(mType)->getBaseType()->isIntegerType()
          || static_cast<PointerType*>(mType)->getBaseType()->getSize() != 8)
@@ -27,9 +27,9 @@ namespace parser
             }
     }
 
-    vipir::Value* StringLiteral::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag)
+    vipir::Value* StringLiteral::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
-        vipir::GlobalString* string = vipir::GlobalString::Create(module, std::move(mValue));
+        vipir::GlobalString* string = vipir::GlobalString::Create(module, mValue);
 
         return builder.CreateAddrOf(string);
     }
@@ -2,8 +2,13 @@
 
 
 #include "parser/ast/expression/StructInitializer.h"
+#include "parser/ast/ConstantEvaluator.h"
 
 #include <vipir/IR/Constant/ConstantStruct.h>
+#include <vipir/IR/Constant/ConstantArray.h>
+#include <vipir/IR/Constant/ConstantInt.h>
+
+#include <vipir/Type/ArrayType.h>
 
 namespace parser
 {
@@ -15,7 +20,7 @@ namespace parser
         mPreferredDebugToken = mTypeToken;
     }
 
-    void StructInitializer::typeCheck(Scope* scope, diagnostic::Diagnostics& diag)
+    void StructInitializer::typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
         if (!mType->isStructType())
         {
@@ -24,7 +29,12 @@ namespace parser
         }
 
         StructType* structType = static_cast<StructType*>(mType);
-        
+        if (mBody.size() != structType->getFields().size())
+        {
+            diag.compilerError(mTypeToken.getStart(), mTypeToken.getEnd(), std::format("Struct '{}{}{}' has {} fields but its initializer gives {} values",
+                fmt::bold, mType->getName(), fmt::defaults, structType->getFields().size(), mBody.size()));
+        }
+
         int index = 0;
         for (auto& node : mBody)
         {
@@ -35,17 +45,62 @@ namespace parser
                     fmt::bold, node->getType()->getName(), fmt::defaults));
             }
             ++index;
-            node->typeCheck(scope, diag);
+            node->typeCheck(scope, context, diag);
         }
     }
 
-    vipir::Value* StructInitializer::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag)
+    vipir::Value* StructInitializer::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
-        std::vector<vipir::Value*> values;
+        std::vector<vipir::Value*> fieldValues;
         for (auto& value : mBody)
         {
-            values.push_back(value->emit(builder, module, scope, diag));
+            fieldValues.push_back(value->emit(builder, module, scope, context, diag));
+        }
+
+        // The vipir struct holds the fields in layout order with explicit padding between them
+        std::vector<vipir::Value*> values;
+        for (auto [index, padding] : static_cast<StructType*>(mType)->getLayout().elements)
+        {
+            if (index != -1)
+            {
+                values.push_back(fieldValues[index]);
+                continue;
+            }
+
+            vipir::Type* byteType = vipir::Type::GetIntegerType(8);
+            std::vector<vipir::Value*> zeroes(padding, vipir::ConstantInt::Get(module, 0, byteType));
+            values.push_back(vipir::ConstantArray::Get(module, vipir::Type::GetArrayType(byteType, padding), std::move(zeroes)));
         }
         return vipir::ConstantStruct::Get(module, mType->getVipirType(), std::move(values));
     }
-}
\ No newline at end of file
+
+    ASTNodePtr StructInitializer::fold(CompilerContext& context, diagnostic::Diagnostics& diag)
+    {
+        for (auto& value : mBody)
+        {
+            Fold(value, context, diag);
+        }
+        return nullptr;
+    }
+
+    std::optional<ConstantValue> StructInitializer::evaluate(ConstantEvaluator& evaluator)
+    {
+        ConstantValue structValue{ mType };
+        for (auto& value : mBody)
+        {
+            std::optional<ConstantValue> field = evaluator.evaluate(value.get());
+            if (!field) return std::nullopt;
+
+            structValue.elements.push_back(std::move(*field));
+        }
+        return structValue;
+    }
+
+    void StructInitializer::forEachChild(const std::function<void(ASTNode*)>& callback)
+    {
+        for (auto& element : mBody)
+        {
+            callback(element.get());
+        }
+    }
+}
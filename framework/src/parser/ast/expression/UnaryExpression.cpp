@@ -2,7 +2,13 @@
 
 
 #include "parser/ast/expression/UnaryExpression.h"
+#include "parser/ast/ConstantEvaluator.h"
+#include "parser/ast/expression/IntegerLiteral.h"
+#include "parser/ast/expression/VariableExpression.h"
 
+#include "context/CompilerContext.h"
+
+#include "type/IntegerType.h"
 #include "type/PointerType.h"
 
 #include <vipir/IR/Constant/ConstantInt.h>
@@ -17,7 +23,7 @@
 
 namespace parser
 {
-    UnaryExpression::UnaryExpression(ASTNodePtr operand, lexing::Token operatorToken, bool postfix)
+    UnaryExpression::UnaryExpression(CompilerContext& context, ASTNodePtr operand, lexing::Token operatorToken, bool postfix)
         : mOperand(std::move(operand))
         , mPostfix(postfix)
     {
@@ -45,7 +51,7 @@ namespace parser
 
             case lexing::TokenType::Ampersand:
                 mOperator = Operator::AddressOf;
-                mType = PointerType::Create(mOperand->getType());
+                mType = PointerType::Create(context, mOperand->getType());
                 break;
             case lexing::TokenType::Star:
                 mOperator = Operator::Indirection;
@@ -58,7 +64,7 @@ namespace parser
         mPreferredDebugToken = std::move(operatorToken);
     }
 
-    void UnaryExpression::typeCheck(Scope* scope, diagnostic::Diagnostics& diag)
+    void UnaryExpression::typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
         switch (mOperator)
         {
@@ -73,6 +79,7 @@ namespace parser
                         fmt::bold, mPreferredDebugToken.getId(), fmt::defaults,
                         fmt::bold, mType->getName(),             fmt::defaults));
                 }
+                VariableExpression::RequireSlot(mOperand.get());
                 break;
             
             case Operator::Indirection:
@@ -96,16 +103,20 @@ namespace parser
                 }
                 break;
             
-            default:
+            case Operator::AddressOf:
+                VariableExpression::RequireSlot(mOperand.get());
                 break; // maybe check for address-of actually being a variable here
+
+            default:
+                break;
         }
 
-        mOperand->typeCheck(scope, diag);
+        mOperand->typeCheck(scope, context, diag);
     }
 
-    vipir::Value* UnaryExpression::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag)
+    vipir::Value* UnaryExpression::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
-        vipir::Value* operand = mOperand->emit(builder, module, scope, diag);
+        vipir::Value* operand = mOperand->emit(builder, module, scope, context, diag);
 
         switch(mOperator)
         {
@@ -197,4 +208,80 @@ namespace parser
                 mPostfix ? "left" : "right"));
         }
     }
+
+    ASTNodePtr UnaryExpression::fold(CompilerContext& context, diagnostic::Diagnostics& diag)
+    {
+        switch (mOperator)
+        {
+            case Operator::PreIncrement:
+            case Operator::PreDecrement:
+            case Operator::PostIncrement:
+            case Operator::PostDecrement:
+            case Operator::AddressOf:
+                mOperand->fold(context, diag); // has to stay an lvalue, so only its subexpressions are folded
+                return nullptr;
+
+            case Operator::Negate:
+            case Operator::BitwiseNot:
+            {
+                Fold(mOperand, context, diag);
+
+                auto integer = dynamic_cast<IntegerLiteral*>(mOperand.get());
+                if (!integer || !mType->isIntegerType())
+                {
+                    return nullptr;
+                }
+
+                std::uintmax_t value = integer->getValue();
+                value = mOperator == Operator::Negate ? 0 - value : ~value;
+                return context.astArena.create<IntegerLiteral>(static_cast<IntegerType*>(mType)->wrap(value), mType, mPreferredDebugToken);
+            }
+
+            default:
+                Fold(mOperand, context, diag);
+                return nullptr;
+        }
+    }
+
+    std::optional<ConstantValue> UnaryExpression::evaluate(ConstantEvaluator& evaluator)
+    {
+        if (!mType->isIntegerType()) return std::nullopt; // pointers can't be evaluated
+
+        auto integerType = static_cast<IntegerType*>(mType);
+        switch (mOperator)
+        {
+            case Operator::PreIncrement:
+            case Operator::PreDecrement:
+            case Operator::PostIncrement:
+            case Operator::PostDecrement:
+            {
+                ConstantValue* operand = evaluator.evaluateAddress(mOperand.get());
+                if (!operand || !operand->type) return std::nullopt;
+
+                ConstantValue old = *operand;
+                bool increment = mOperator == Operator::PreIncrement || mOperator == Operator::PostIncrement;
+                operand->integer = integerType->wrap(static_cast<std::uintmax_t>(operand->integer) + (increment ? 1 : -1));
+                return mPostfix ? old : *operand;
+            }
+
+            case Operator::Negate:
+            case Operator::BitwiseNot:
+            {
+                std::optional<ConstantValue> operand = evaluator.evaluate(mOperand.get());
+                if (!operand) return std::nullopt;
+
+                std::uintmax_t value = operand->integer;
+                value = mOperator == Operator::Negate ? 0 - value : ~value;
+                return ConstantValue{ mType, integerType->wrap(value) };
+            }
+
+            default:
+                return std::nullopt;
+        }
+    }
+
+    void UnaryExpression::forEachChild(const std::function<void(ASTNode*)>& callback)
+    {
+        callback(mOperand.get());
+    }
 }
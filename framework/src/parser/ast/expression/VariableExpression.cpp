@@ -2,6 +2,11 @@
 
 #include "parser/ast/expression/VariableExpression.h"
 
+#include "parser/ast/ConstantEvaluator.h"
+#include "parser/ast/statement/ConstexprStatement.h"
+
+#include "context/CompilerContext.h"
+
 #include "symbol/Identifier.h"
 
 #include "type/PointerType.h"
@@ -16,44 +21,85 @@
 
 namespace parser
 {
-    VariableExpression::VariableExpression(std::string&& name, Type* type, lexing::Token token)
+    VariableExpression::VariableExpression(std::string&& name, Type* type, lexing::Token token, LocalSymbol* local)
         : mName(std::move(name))
         , mToken(std::move(token))
+        , mLocal(local)
+        , mSelf(nullptr)
+        , mFieldIndex(-1)
+        , mFunction(nullptr)
+        , mGlobal(nullptr)
     {
         mType = type;
         mPreferredDebugToken = mToken;
     }
 
+    VariableExpression::VariableExpression(std::string&& name, Type* type, lexing::Token token, LocalSymbol* self, int fieldIndex)
+        : VariableExpression(std::move(name), type, std::move(token))
+    {
+        mSelf = self;
+        mFieldIndex = fieldIndex;
+    }
+
     std::string VariableExpression::getName()
     {
         return mName;
     }
 
-    void VariableExpression::typeCheck(Scope* scope, diagnostic::Diagnostics& diag)
+    FunctionSymbol* VariableExpression::getFunction() const
     {
+        return mFunction;
     }
 
-    vipir::Value* VariableExpression::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag)
+    void VariableExpression::RequireSlot(ASTNode* node)
     {
-        LocalSymbol* local = scope->findVariable(mName);
+        if (auto variable = dynamic_cast<VariableExpression*>(node); variable && variable->mLocal)
+        {
+            variable->mLocal->needsSlot = true;
+        }
+    }
 
-        std::vector<std::string> symbols = symbol::GetSymbol({mName}, scope->getNamespaces());
+    void VariableExpression::typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
+    {
+        if (mLocal || mSelf)
+        {
+            return;
+        }
 
-        if (local)
+        for (auto& symbol : symbol::GetSymbol(context, {mName}, Scope::GetNamespaces(scope)))
         {
-            if (local->alloca->isConstant()) return local->alloca;
+            if (auto it = context.functions.find(symbol); it != context.functions.end())
+            {
+                mFunction = &it->second;
+                return;
+            }
+            else if (auto it = context.globals.find(symbol); it != context.globals.end())
+            {
+                mGlobal = &it->second;
+                return;
+            }
+        }
+    }
 
-            return builder.CreateLoad(local->alloca);
+    vipir::Value* VariableExpression::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
+    {
+        if (mLocal)
+        {
+            if (mLocal->inRegister() || mLocal->alloca->isConstant()) return mLocal->alloca;
+
+            return builder.CreateLoad(mLocal->alloca);
         }
-        else if (scope->findOwner() != nullptr && scope->findOwner()->hasField(mName))
+        else if (mSelf)
         {
-            StructType* structType = scope->findOwner();
-            vipir::Value* self = builder.CreateLoad(scope->findVariable("this")->alloca);
-            vipir::Value* gep = builder.CreateStructGEP(self, structType->getFieldOffset(mName));
+            StructType* structType = static_cast<StructType*>(static_cast<PointerType*>(mSelf->type)->getBaseType());
+            const StructType::Field& field = structType->getFields()[mFieldIndex];
+
+            vipir::Value* self = mSelf->inRegister() ? mSelf->alloca : builder.CreateLoad(mSelf->alloca);
+            vipir::Value* gep = builder.CreateStructGEP(self, structType->getFieldElement(mFieldIndex));
 
-            if (structType->getField(mName)->type->isPointerType())
+            if (field.type->isPointerType())
             {
-                if (static_cast<PointerType*>(structType->getField(mName)->type)->getBaseType() == structType)
+                if (static_cast<PointerType*>(field.type)->getBaseType() == structType)
                 {
                     vipir::Type* type = vipir::PointerType::GetPointerType(vipir::PointerType::GetPointerType(structType->getVipirType()));
                     gep = builder.CreatePtrCast(gep, type);
@@ -62,24 +108,71 @@ namespace parser
 
             return builder.CreateLoad(gep);
         }
-        else
+        else if (mFunction)
         {
-            for (auto& symbol : symbols)
-            {
-                if (GlobalFunctions.contains(symbol))
-                {
-                    return GlobalFunctions.at(symbol).function;
-                }
-                else if (GlobalVariables.contains(symbol))
-                {
-                    vipir::Value* value = GlobalVariables[symbol].global;
-                    if (value->isConstant()) return value;
+            return mFunction->function;
+        }
+        else if (mGlobal)
+        {
+            vipir::Value* value = mGlobal->global;
+            if (value->isConstant()) return value;
 
-                    if (value->getType()->isPointerType()) return builder.CreateLoad(value); // TODO: Something better than this
-                }
-            }
+            if (value->getType()->isPointerType()) return builder.CreateLoad(value); // TODO: Something better than this
         }
         diag.compilerError(mToken.getStart(), mToken.getEnd(), std::format("identifier '{}{}{}' undeclared",
             fmt::bold, mName, fmt::defaults));
     }
+
+    ASTNodePtr VariableExpression::fold(CompilerContext& context, diagnostic::Diagnostics& diag)
+    {
+        if (mLocal && mLocal->constexprDefinition)
+        {
+            return mLocal->constexprDefinition->foldUse(mToken, context, diag);
+        }
+        if (mGlobal && mGlobal->constexprDefinition)
+        {
+            return mGlobal->constexprDefinition->foldUse(mToken, context, diag);
+        }
+        return nullptr;
+    }
+
+    bool VariableExpression::isConstexpr() const
+    {
+        return (mLocal && mLocal->constexprDefinition) || (mGlobal && mGlobal->constexprDefinition);
+    }
+
+    bool VariableExpression::isSameVariable(const VariableExpression* other) const
+    {
+        if (mLocal) return mLocal == other->mLocal;
+        if (mSelf) return mSelf == other->mSelf && mFieldIndex == other->mFieldIndex;
+        if (mGlobal) return mGlobal == other->mGlobal;
+        return false;
+    }
+
+    std::optional<ConstantValue> VariableExpression::evaluate(ConstantEvaluator& evaluator)
+    {
+        if (mLocal && mLocal->constexprDefinition)
+        {
+            return mLocal->constexprDefinition->evaluateUse(evaluator);
+        }
+        if (mGlobal && mGlobal->constexprDefinition)
+        {
+            return mGlobal->constexprDefinition->evaluateUse(evaluator);
+        }
+
+        if (ConstantValue* local = evaluateAddress(evaluator); local && local->type)
+        {
+            return *local;
+        }
+        return std::nullopt;
+    }
+
+    ConstantValue* VariableExpression::evaluateAddress(ConstantEvaluator& evaluator)
+    {
+        if (mLocal && !mLocal->constexprDefinition)
+        {
+            return evaluator.getLocal(mLocal);
+        }
+        return nullptr;
+    }
 }
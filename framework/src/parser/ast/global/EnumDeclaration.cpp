@@ -3,6 +3,8 @@
 
 #include "parser/ast/global/EnumDeclaration.h"
 
+#include "context/CompilerContext.h"
+
 #include "symbol/Identifier.h"
 
 #include "type/EnumType.h"
@@ -14,7 +16,7 @@
 
 namespace parser
 {
-    EnumDeclaration::EnumDeclaration(std::vector<GlobalAttribute> attributes, std::vector<std::string> names, std::vector<EnumField> fields)
+    EnumDeclaration::EnumDeclaration(CompilerContext& context, std::vector<GlobalAttribute> attributes, std::vector<std::string> names, std::vector<EnumField> fields)
         : mAttributes(std::move(attributes))
         , mNames(std::move(names))
         , mFields(std::move(fields))
@@ -22,8 +24,8 @@ namespace parser
         bool generateNames = std::find_if(mAttributes.begin(), mAttributes.end(), [](const auto& attribute){
             return attribute.getType() == GlobalAttributeType::GenerateNames;
         }) == mAttributes.end();
-        mType = EnumType::Create(mNames);
-        symbol::AddIdentifier(mType->getMangleID(), mNames);
+        mType = EnumType::Create(context, mNames, generateNames);
+        symbol::AddIdentifier(context, mType->getMangleID(), mNames);
 
         for (auto& field : mFields)
         {
@@ -32,24 +34,24 @@ namespace parser
             std::vector<std::string> names = mNames;
             names.push_back(field.name);
 
-            symbol::AddIdentifier(mangledName, std::move(names));
+            symbol::AddIdentifier(context, mangledName, std::move(names));
 
-            GlobalVariables[mangledName] = GlobalSymbol(nullptr, mType);
+            context.globals[mangledName] = GlobalSymbol(nullptr, mType);
         }
     }
 
-    void EnumDeclaration::typeCheck(Scope* scope, diagnostic::Diagnostics& diag)
+    void EnumDeclaration::typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
     }
 
-    vipir::Value* EnumDeclaration::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag)
+    vipir::Value* EnumDeclaration::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
         for (auto& field : mFields)
         {
             std::string mangledName = "_EM" + field.name;
 
             vipir::Value* constant = vipir::ConstantInt::Get(module, field.value, vipir::Type::GetIntegerType(32));
-            GlobalVariables[mangledName] = GlobalSymbol(constant, mType);
+            context.globals[mangledName] = GlobalSymbol(constant, mType);
         }
 
         return nullptr;
@@ -1,9 +1,14 @@
 // Copyright 2024 solar-mist
 
 #include "parser/ast/global/Function.h"
+#include "parser/ast/ConstantEvaluator.h"
+#include "parser/ast/Inliner.h"
 
+#include "parser/ast/statement/CompoundStatement.h"
 #include "parser/ast/statement/ReturnStatement.h"
 
+#include "context/CompilerContext.h"
+
 #include "symbol/NameMangling.h"
 
 #include <vipir/IR/Function.h>
@@ -16,72 +21,107 @@
 
 namespace parser
 {
-    Function::Function(std::vector<GlobalAttribute> attributes, Type* type, std::vector<FunctionArgument> arguments, std::string_view name, std::vector<ASTNodePtr>&& body, Scope* scope)
+    Function::Function(std::vector<GlobalAttribute> attributes, Type* type, std::vector<FunctionArgument> arguments, std::string_view name, std::vector<ASTNodePtr>&& body, Scope* scope, bool exported)
         : mAttributes(std::move(attributes))
         , mType(type)
         , mArguments(std::move(arguments))
         , mName(name)
         , mBody(std::move(body))
         , mScope(scope)
+        , mExported(exported)
+        , mSymbol(nullptr)
+        , mDiag(nullptr)
     {
     }
 
+    FunctionSymbol* Function::Declare(CompilerContext& context, std::vector<std::string> names, Type* type, const std::vector<GlobalAttribute>& attributes, std::string& mangledName)
+    {
+        bool mangled = std::find_if(attributes.begin(), attributes.end(), [](const auto& attribute){
+            return attribute.getType() == GlobalAttributeType::NoMangle;
+        }) == attributes.end();
+
+        if (mangled)
+            mangledName = symbol::mangleFunctionName(names, static_cast<FunctionType*>(type)->getArgumentTypes());
+        else
+            mangledName = names.back();
+
+        auto it = context.functions.find(mangledName);
+        if (it != context.functions.end())
+            return &it->second;
+
+        return FunctionSymbol::Create(context, nullptr, mangledName, std::move(names), type, false, mangled);
+    }
+
     Type* Function::getReturnType() const
     {
         return static_cast<FunctionType*>(mType)->getReturnType();
     }
 
-    void Function::typeCheck(Scope* scope, diagnostic::Diagnostics& diag)
+    std::vector<ASTNodePtr>& Function::getBody()
+    {
+        return mBody;
+    }
+
+    const std::vector<GlobalAttribute>& Function::getAttributes() const
+    {
+        return mAttributes;
+    }
+
+    FunctionSymbol* Function::getSymbol() const
+    {
+        return mSymbol;
+    }
+
+    bool Function::isExported() const
+    {
+        return mExported;
+    }
+
+    void Function::typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
         if (mScope)
         {
             scope = mScope.get();
-            mScope->currentReturnType = getReturnType();
         }
+        mDiag = &diag;
+
+        std::vector<std::string> names = Scope::GetNamespaces(scope);
+        names.push_back(mName);
+
+        // The parser declares a function as soon as it reads its signature,
+        // so every declaration and definition of it shares one symbol
+        mSymbol = Declare(context, std::move(names), mType, mAttributes, mMangledName);
+
+        if (!mBody.empty())
+            mSymbol->definition = this;
+
         for (auto& node : mBody)
         {
-            node->typeCheck(scope, diag);
+            node->typeCheck(scope, context, diag);
         }
     }
 
-    vipir::Value* Function::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag)
+    vipir::Value* Function::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
-        if (!mBody.empty()) scope = mScope.get();
-
-        std::vector<Type*> manglingArguments;
-        std::vector<vipir::Type*> argumentTypes;
-        for (auto& argument : mArguments)
+        if (!mSymbol->reachable)
         {
-            manglingArguments.push_back(argument.type);
-            argumentTypes.push_back(argument.type->getVipirType());
+            return nullptr;
         }
 
-        std::vector<std::string> names = scope->getNamespaces();
-        names.push_back(mName);
-
-        bool mangled = std::find_if(mAttributes.begin(), mAttributes.end(), [](const auto& attribute){
-            return attribute.getType() == GlobalAttributeType::NoMangle;
-        }) == mAttributes.end();
-
-        std::string name;
-        if (mangled)
-            name = symbol::mangleFunctionName(names, std::move(manglingArguments));
-        else
-            name = mName;
+        if (!mBody.empty()) scope = mScope.get();
 
         vipir::FunctionType* functionType = static_cast<vipir::FunctionType*>(mType->getVipirType());
-        vipir::Function* func;
+        vipir::Function* func = mSymbol->function;
 
-        if (GlobalFunctions.contains(name))
+        if (func)
         {
-            func = GlobalFunctions[name].function;
             assert(func->getFunctionType() == functionType);
             // assert func is empty
         }
         else
         {
-            func = vipir::Function::Create(functionType, module, name);
-            FunctionSymbol::Create(func, name, names, mType,false, mangled);
+            func = vipir::Function::Create(functionType, module, mMangledName);
+            mSymbol->function = func;
         }
 
         if (mBody.empty())
@@ -89,21 +129,34 @@ namespace parser
             return func;
         }
 
+        // The entry block only holds stack slots, so that slots created
+        // partway through the body can still be added to it, and branches
+        // to the body once that's done
         vipir::BasicBlock* entryBasicBlock = vipir::BasicBlock::Create("", func);
+        vipir::BasicBlock* bodyBasicBlock = vipir::BasicBlock::Create("", func);
         builder.setInsertPoint(entryBasicBlock);
+        scope->emitting = true;
+        scope->allocaBlock = entryBasicBlock;
 
         int index = 0;
         for (auto& argument : mArguments)
         {
+            if (argument.symbol->inRegister())
+            {
+                argument.symbol->alloca = func->getArgument(index++);
+                continue;
+            }
+
             vipir::AllocaInst* alloca = builder.CreateAlloca(argument.type->getVipirType());
-            scope->locals[argument.name].alloca = alloca;
+            argument.symbol->alloca = alloca;
 
             builder.CreateStore(alloca, func->getArgument(index++));
         }
 
+        builder.setInsertPoint(bodyBasicBlock);
         for (auto& node : mBody)
         {
-            node->emit(builder, module, scope, diag);
+            node->emit(builder, module, scope, context, diag);
         }
 
         if (!dynamic_cast<ReturnStatement*>(mBody.back().get()))
@@ -118,7 +171,89 @@ namespace parser
             }
         }
 
+        builder.setInsertPoint(entryBasicBlock);
+        builder.CreateBr(bodyBasicBlock);
+
+        scope->emitting = false;
+        scope->allocaBlock = nullptr;
         return func;
     }
 
+    ASTNodePtr Function::fold(CompilerContext& context, diagnostic::Diagnostics& diag)
+    {
+        if (mBody.empty())
+        {
+            return nullptr;
+        }
+
+        CompoundStatement::FoldBody(mBody, context, diag);
+
+        // An empty body would be taken for a declaration
+        if (mBody.empty())
+        {
+            mBody.push_back(context.astArena.create<CompoundStatement>(std::vector<ASTNodePtr>(), nullptr));
+        }
+        return nullptr;
+    }
+
+    std::optional<ConstantValue> Function::evaluateCall(ConstantEvaluator& evaluator, std::vector<ConstantValue> arguments)
+    {
+        if (mBody.empty() || !evaluator.pushFrame(mScope->frame.size()))
+        {
+            return std::nullopt;
+        }
+
+        for (std::size_t i = 0; i < mArguments.size(); ++i)
+        {
+            *evaluator.getLocal(mArguments[i].symbol) = std::move(arguments[i]);
+        }
+
+        // Falling off the end returns zero, as it does when emitted
+        std::optional<ConstantValue> result = ConstantValue::Zero(getReturnType());
+        if (getReturnType()->isVoidType())
+        {
+            result = ConstantValue{};
+        }
+
+        for (auto& node : mBody)
+        {
+            if (!evaluator.evaluate(node.get()))
+            {
+                result = std::nullopt;
+                break;
+            }
+            if (evaluator.getFlow() == ConstantEvaluator::Flow::Return)
+            {
+                result = evaluator.takeReturnValue();
+                break;
+            }
+        }
+
+        evaluator.popFrame();
+        return result;
+    }
+
+    bool Function::shouldInline()
+    {
+        return Inliner::ShouldInline(mBody, getReturnType(), mAttributes, mScope.get());
+    }
+
+    vipir::Value* Function::emitInline(vipir::IRBuilder& builder, vipir::Module& module, Scope* caller, std::vector<vipir::Value*> arguments, CompilerContext& context)
+    {
+        std::vector<std::pair<LocalSymbol*, vipir::Value*> > bindings;
+        for (std::size_t i = 0; i < mArguments.size(); ++i)
+        {
+            bindings.push_back({mArguments[i].symbol, arguments[i]});
+        }
+
+        return Inliner::EmitBody(builder, module, context, *mDiag, mBody, getReturnType(), mScope.get(), caller, bindings);
+    }
+
+    void Function::forEachChild(const std::function<void(ASTNode*)>& callback)
+    {
+        for (auto& node : mBody)
+        {
+            callback(node.get());
+        }
+    }
 }
@@ -3,10 +3,17 @@
 
 #include "parser/ast/global/GlobalAttribute.h"
 
+#include "lexer/Token.h"
+
+#include "diagnostic/Diagnostic.h"
+
+#include <format>
+
 namespace parser
 {
-    GlobalAttribute::GlobalAttribute(GlobalAttributeType type)
+    GlobalAttribute::GlobalAttribute(GlobalAttributeType type, unsigned long long value)
         : mType(type)
+        , mValue(value)
     {
     }
 
@@ -14,4 +21,37 @@ namespace parser
     {
         return mType;
     }
+
+    unsigned long long GlobalAttribute::getValue() const
+    {
+        return mValue;
+    }
+
+    void GlobalAttribute::CheckAlignment(unsigned long long alignment, const lexing::Token& token, diagnostic::Diagnostics& diag)
+    {
+        if (alignment == 0 || (alignment & (alignment - 1)) != 0)
+        {
+            diag.compilerError(token.getStart(), token.getEnd(), std::format("alignment '{}{}{}' is not a power of two",
+                fmt::bold, alignment, fmt::defaults));
+        }
+        if (alignment > MaxAlignment)
+        {
+            diag.compilerError(token.getStart(), token.getEnd(), std::format("alignment '{}{}{}' is larger than the maximum of {}",
+                fmt::bold, alignment, fmt::defaults, MaxAlignment));
+        }
+    }
+
+    void GlobalAttribute::RejectLayoutAttributes(const std::vector<GlobalAttribute>& attributes, const lexing::Token& token, diagnostic::Diagnostics& diag)
+    {
+        for (auto& attribute : attributes)
+        {
+            std::string_view name;
+            if (attribute.getType() == GlobalAttributeType::Align) name = "Align";
+            else if (attribute.getType() == GlobalAttributeType::Reorder) name = "Reorder";
+            else continue;
+
+            diag.compilerError(token.getStart(), token.getEnd(), std::format("attribute '{}{}{}' only applies to struct declarations",
+                fmt::bold, name, fmt::defaults));
+        }
+    }
 }
\ No newline at end of file
@@ -2,6 +2,9 @@
 
 
 #include "parser/ast/global/GlobalDeclaration.h"
+#include "parser/ast/ConstantEvaluator.h"
+
+#include "context/CompilerContext.h"
 
 #include "symbol/Identifier.h"
 
@@ -9,7 +12,7 @@
 
 namespace parser
 {
-    GlobalDeclaration::GlobalDeclaration(std::vector<std::string> names, Type* type, ASTNodePtr initVal)
+    GlobalDeclaration::GlobalDeclaration(CompilerContext& context, std::vector<std::string> names, Type* type, ASTNodePtr initVal)
         : mNames(std::move(names))
         , mInitVal(std::move(initVal))
     {
@@ -21,11 +24,17 @@ namespace parser
             mangledName += std::to_string(name.length());
             mangledName += name;
         }
-        symbol::AddIdentifier(mangledName, mNames);
-        GlobalVariables[mangledName] = GlobalSymbol(nullptr, mType);
+        symbol::AddIdentifier(context, mangledName, mNames);
+        mSymbol = &context.globals[mangledName];
+        *mSymbol = GlobalSymbol(nullptr, mType);
+    }
+
+    ASTNodePtr& GlobalDeclaration::getInitializer()
+    {
+        return mInitVal;
     }
 
-    void GlobalDeclaration::typeCheck(Scope* scope, diagnostic::Diagnostics& diag)
+    void GlobalDeclaration::typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
         if (mInitVal)
         {
@@ -35,42 +44,46 @@ namespace parser
                     fmt::bold, mType->getName(), fmt::defaults,
                     fmt::bold, mInitVal->getType()->getName(), fmt::defaults));
             }
-            mInitVal->typeCheck(scope, diag);
+            mInitVal->typeCheck(scope, context, diag);
         }
     }
 
-    vipir::Value* GlobalDeclaration::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag)
+    vipir::Value* GlobalDeclaration::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
-        std::string mangledName = "_G" + mType->getMangleID();
-        for (auto& name : mNames)
-        {
-            mangledName += std::to_string(name.length());
-            mangledName += name;
-        }
-
-        vipir::GlobalVar* global;
-
-        if (GlobalVariables.contains(mangledName))
-        {
-            global = dynamic_cast<vipir::GlobalVar*>(GlobalVariables[mangledName].global);
-            if (!global)
-            {
-                global = module.createGlobalVar(mType->getVipirType());
-            }
-        }
-        else
+        vipir::GlobalVar* global = dynamic_cast<vipir::GlobalVar*>(mSymbol->global);
+        if (!global)
         {
             global = module.createGlobalVar(mType->getVipirType());
         }
 
         if (mInitVal)
         {
-            vipir::Value* initVal = mInitVal->emit(builder, module, scope, diag);
+            vipir::Value* initVal = mInitVal->emit(builder, module, scope, context, diag);
             global->setInitialValue(initVal);
         }
 
-        GlobalVariables[mangledName] = GlobalSymbol(global, mType);
+        mSymbol->global = global;
+
+        return nullptr;
+    }
 
+    ASTNodePtr GlobalDeclaration::fold(CompilerContext& context, diagnostic::Diagnostics& diag)
+    {
+        Fold(mInitVal, context, diag);
+
+        // The initializer has to be emitted as data, so anything folding left is run now
+        if (mInitVal)
+        {
+            if (ASTNodePtr value = ConstantEvaluator::EvaluateInitializer(mInitVal.get(), mInitVal->getDebugToken(), context, diag))
+            {
+                mInitVal = std::move(value);
+            }
+        }
         return nullptr;
     }
+
+    void GlobalDeclaration::forEachChild(const std::function<void(ASTNode*)>& callback)
+    {
+        if (mInitVal) callback(mInitVal.get());
+    }
 }
\ No newline at end of file
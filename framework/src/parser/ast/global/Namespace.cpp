@@ -12,24 +12,40 @@ namespace parser
     {
     }
 
-    void Namespace::typeCheck(Scope* scope, diagnostic::Diagnostics& diag)
+    void Namespace::typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
         for (auto& node : mBody)
         {
-            node->typeCheck(scope, diag);
+            node->typeCheck(mScope.get(), context, diag);
         }
     }
 
-    vipir::Value* Namespace::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag)
+    vipir::Value* Namespace::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
         scope = mScope.get();
-        scope->namespaceName = mName;
 
         for (auto& value : mBody)
         {
-            value->emit(builder, module, scope, diag);
+            value->emit(builder, module, scope, context, diag);
         }
 
         return nullptr;
     }
+
+    ASTNodePtr Namespace::fold(CompilerContext& context, diagnostic::Diagnostics& diag)
+    {
+        for (auto& node : mBody)
+        {
+            Fold(node, context, diag);
+        }
+        return nullptr;
+    }
+
+    void Namespace::forEachChild(const std::function<void(ASTNode*)>& callback)
+    {
+        for (auto& node : mBody)
+        {
+            callback(node.get());
+        }
+    }
 }
\ No newline at end of file
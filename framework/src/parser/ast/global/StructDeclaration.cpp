@@ -3,6 +3,10 @@
 
 #include "parser/ast/global/StructDeclaration.h"
 
+#include "parser/ast/statement/CompoundStatement.h"
+
+#include "context/CompilerContext.h"
+
 #include "type/StructType.h"
 #include "type/PointerType.h"
 
@@ -19,34 +23,29 @@
 
 namespace parser
 {
-    StructDeclaration::StructDeclaration(std::vector<std::string> names, std::vector<StructField> fields, std::vector<StructMethod> methods, Type* type)
+    StructDeclaration::StructDeclaration(CompilerContext& context, std::vector<std::string> names, std::vector<StructField> fields, std::vector<StructMethod> methods, Type* type, bool exported)
         : mNames(std::move(names))
         , mFields(std::move(fields))
         , mMethods(std::move(methods))
+        , mExported(exported)
     {
         mType = type;
 
         for (auto& method : mMethods)
         {
             std::vector<Type*> manglingArguments;
-            std::vector<vipir::Type*> argumentTypes;
-
-            manglingArguments.push_back(PointerType::Create(mType));
-            argumentTypes.push_back(vipir::Type::GetPointerType(mType->getVipirType()));
+            manglingArguments.push_back(PointerType::Create(context, mType));
 
             for (auto& argument : method.arguments)
             {
                 manglingArguments.push_back(argument.type);
-                argumentTypes.push_back(argument.type->getVipirType());
             }
 
-            vipir::FunctionType* functionType = static_cast<vipir::FunctionType*>(method.type->getVipirType());
-
             std::vector<std::string> names = mNames;
             names.push_back(method.name);
-            std::string name = symbol::mangleFunctionName(names, std::move(manglingArguments));
+            method.mangledName = symbol::mangleFunctionName(names, std::move(manglingArguments));
 
-            FunctionSymbol::Create(nullptr, name, names, method.type, method.priv);
+            method.symbol = FunctionSymbol::Create(context, nullptr, method.mangledName, std::move(names), method.type, method.priv);
         }
     }
 
@@ -65,47 +64,48 @@ namespace parser
         return mMethods;
     }
 
-    void StructDeclaration::typeCheck(Scope* scope, diagnostic::Diagnostics& diag)
+    bool StructDeclaration::isExported() const
+    {
+        return mExported;
+    }
+
+    void StructDeclaration::typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
         for (auto& method : mMethods)
         {
             if (method.scope)
             {
                 scope = method.scope.get();
-                method.scope->currentReturnType = static_cast<FunctionType*>(method.type)->getReturnType();
+            }
+            if (!method.body.empty())
+            {
+                method.symbol->method = &method;
+                method.diag = &diag;
             }
             for (auto& node : method.body)
             {
-                node->typeCheck(scope, diag);
+                node->typeCheck(scope, context, diag);
             }
         }
     }
 
-    vipir::Value* StructDeclaration::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag)
+    vipir::Value* StructDeclaration::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
         StructType* structType = static_cast<StructType*>(mType);
         for (StructMethod& method : mMethods)
         {
-            std::vector<Type*> manglingArguments;
-            std::vector<vipir::Type*> argumentTypes;
-
-            manglingArguments.push_back(PointerType::Create(mType));
-            argumentTypes.push_back(vipir::Type::GetPointerType(mType->getVipirType()));
-
-            for (auto& argument : method.arguments)
+            if (!method.symbol->reachable)
             {
-                manglingArguments.push_back(argument.type);
-                argumentTypes.push_back(argument.type->getVipirType());
+                continue;
             }
 
-            vipir::FunctionType* functionType = static_cast<vipir::FunctionType*>(method.type->getVipirType());
-
-            std::vector<std::string> names = mNames;
-            names.push_back(method.name);
-            std::string name = symbol::mangleFunctionName(names, std::move(manglingArguments));
-
-            vipir::Function* func = vipir::Function::Create(functionType, module, name);
-            GlobalFunctions[name].function = func;
+            vipir::Function* func = method.symbol->function;
+            if (!func)
+            {
+                vipir::FunctionType* functionType = static_cast<vipir::FunctionType*>(method.type->getVipirType());
+                func = vipir::Function::Create(functionType, module, method.mangledName);
+                method.symbol->function = func;
+            }
 
             if (method.body.empty())
             {
@@ -113,31 +113,86 @@ namespace parser
             }
 
             scope = method.scope.get();
+            scope->emitting = true;
 
+            // Stack slots go in the entry block, as in Function::emit
             vipir::BasicBlock* entryBasicBlock = vipir::BasicBlock::Create("", func);
+            vipir::BasicBlock* bodyBasicBlock = vipir::BasicBlock::Create("", func);
             builder.setInsertPoint(entryBasicBlock);
+            scope->allocaBlock = entryBasicBlock;
 
             int index = 0;
 
-            vipir::AllocaInst* self = builder.CreateAlloca(vipir::Type::GetPointerType(mType->getVipirType()));
-            scope->locals["this"].alloca = self;
+            if (method.self->inRegister())
+            {
+                method.self->alloca = func->getArgument(index++);
+            }
+            else
+            {
+                vipir::AllocaInst* self = builder.CreateAlloca(vipir::Type::GetPointerType(mType->getVipirType()));
+                method.self->alloca = self;
 
-            builder.CreateStore(self, func->getArgument(index++));
+                builder.CreateStore(self, func->getArgument(index++));
+            }
 
             for (auto& argument : method.arguments)
             {
+                if (argument.symbol->inRegister())
+                {
+                    argument.symbol->alloca = func->getArgument(index++);
+                    continue;
+                }
+
                 vipir::AllocaInst* alloca = builder.CreateAlloca(argument.type->getVipirType());
-                scope->locals[argument.name].alloca = alloca;
+                argument.symbol->alloca = alloca;
 
                 builder.CreateStore(alloca, func->getArgument(index++));
             }
 
+            builder.setInsertPoint(bodyBasicBlock);
             for (auto& node : method.body)
             {
-                node->emit(builder, module, scope, diag);
+                node->emit(builder, module, scope, context, diag);
             }
+
+            builder.setInsertPoint(entryBasicBlock);
+            builder.CreateBr(bodyBasicBlock);
+
+            scope->emitting = false;
+            scope->allocaBlock = nullptr;
         }
 
         return nullptr;
     }
+
+    ASTNodePtr StructDeclaration::fold(CompilerContext& context, diagnostic::Diagnostics& diag)
+    {
+        for (auto& method : mMethods)
+        {
+            if (method.body.empty())
+            {
+                continue;
+            }
+
+            CompoundStatement::FoldBody(method.body, context, diag);
+
+            // An empty body would be taken for a declaration
+            if (method.body.empty())
+            {
+                method.body.push_back(context.astArena.create<CompoundStatement>(std::vector<ASTNodePtr>(), nullptr));
+            }
+        }
+        return nullptr;
+    }
+
+    void StructDeclaration::forEachChild(const std::function<void(ASTNode*)>& callback)
+    {
+        for (auto& method : mMethods)
+        {
+            for (auto& node : method.body)
+            {
+                callback(node.get());
+            }
+        }
+    }
 }
@@ -7,18 +7,18 @@
 
 namespace parser
 {
-    UsingDeclaration::UsingDeclaration(std::vector<std::string> names, Type* type)
+    UsingDeclaration::UsingDeclaration(CompilerContext& context, std::vector<std::string> names, Type* type)
         : mNames(std::move(names))
         , mType(type)
     {
-        Type::AddAlias(mNames, mType);
+        Type::AddAlias(context, mNames, mType);
     }
 
-    void UsingDeclaration::typeCheck(Scope* scope, diagnostic::Diagnostics& diag)
+    void UsingDeclaration::typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
     }
 
-    vipir::Value* UsingDeclaration::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag)
+    vipir::Value* UsingDeclaration::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
         return nullptr;
     }
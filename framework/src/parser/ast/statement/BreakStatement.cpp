@@ -2,6 +2,7 @@
 
 
 #include "parser/ast/statement/BreakStatement.h"
+#include "parser/ast/ConstantEvaluator.h"
 
 namespace parser
 {
@@ -10,11 +11,11 @@ namespace parser
     {
     }
 
-    void BreakStatement::typeCheck(Scope* scope, diagnostic::Diagnostics& diag)
+    void BreakStatement::typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
     }
 
-    vipir::Value* BreakStatement::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag)
+    vipir::Value* BreakStatement::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
         vipir::BasicBlock* breakTo = scope->findBreakBB();
 
@@ -27,4 +28,15 @@ namespace parser
 
         return nullptr;
     }
-}
\ No newline at end of file
+
+    std::optional<ConstantValue> BreakStatement::evaluate(ConstantEvaluator& evaluator)
+    {
+        evaluator.setFlow(ConstantEvaluator::Flow::Break);
+        return ConstantValue{};
+    }
+
+    bool BreakStatement::leavesBlock() const
+    {
+        return true;
+    }
+}
@@ -2,10 +2,14 @@
 
 #include "parser/ast/statement/CompoundStatement.h"
 
+#include "parser/ast/ConstantEvaluator.h"
+
 #include <vipir/IR/Instruction/RetInst.h>
 
 #include <vipir/IR/BasicBlock.h>
 
+#include <iterator>
+
 namespace parser
 {
     CompoundStatement::CompoundStatement(std::vector<ASTNodePtr>&& body, Scope* scope)
@@ -14,24 +18,82 @@ namespace parser
     {
     }
 
-    void CompoundStatement::typeCheck(Scope* scope, diagnostic::Diagnostics& diag)
+    std::vector<ASTNodePtr>& CompoundStatement::getBody()
+    {
+        return mBody;
+    }
+
+    void CompoundStatement::typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
         for (auto& node : mBody)
         {
-            node->typeCheck(scope, diag);
+            node->typeCheck(mScope.get(), context, diag);
         }
     }
 
-    vipir::Value* CompoundStatement::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag)
+    vipir::Value* CompoundStatement::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
         scope = mScope.get();
 
         for (ASTNodePtr& node : mBody)
         {
-            node->emit(builder, module, scope, diag);
+            node->emit(builder, module, scope, context, diag);
         }
 
         return nullptr;
     }
 
-}
\ No newline at end of file
+    ASTNodePtr CompoundStatement::fold(CompilerContext& context, diagnostic::Diagnostics& diag)
+    {
+        FoldBody(mBody, context, diag);
+        return nullptr;
+    }
+
+    std::optional<ConstantValue> CompoundStatement::evaluate(ConstantEvaluator& evaluator)
+    {
+        for (auto& node : mBody)
+        {
+            if (!evaluator.evaluate(node.get())) return std::nullopt;
+
+            if (evaluator.getFlow() != ConstantEvaluator::Flow::Normal) break;
+        }
+        return ConstantValue{};
+    }
+
+    bool CompoundStatement::leavesBlock() const
+    {
+        return !mBody.empty() && mBody.back()->leavesBlock();
+    }
+
+    void CompoundStatement::FoldBody(std::vector<ASTNodePtr>& body, CompilerContext& context, diagnostic::Diagnostics& diag)
+    {
+        std::vector<ASTNodePtr> folded;
+        for (auto& node : body)
+        {
+            Fold(node, context, diag);
+
+            if (auto block = dynamic_cast<CompoundStatement*>(node.get()))
+            {
+                std::move(block->mBody.begin(), block->mBody.end(), std::back_inserter(folded));
+            }
+            else
+            {
+                folded.push_back(std::move(node));
+            }
+
+            if (!folded.empty() && folded.back()->leavesBlock())
+            {
+                break;
+            }
+        }
+        body = std::move(folded);
+    }
+
+    void CompoundStatement::forEachChild(const std::function<void(ASTNode*)>& callback)
+    {
+        for (auto& node : mBody)
+        {
+            callback(node.get());
+        }
+    }
+}
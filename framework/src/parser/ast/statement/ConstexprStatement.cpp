@@ -1,16 +1,32 @@
 #include "parser/ast/statement/ConstexprStatement.h"
+#include "parser/ast/ConstantEvaluator.h"
+#include "parser/ast/expression/BooleanLiteral.h"
+#include "parser/ast/expression/IntegerLiteral.h"
+
+#include "context/CompilerContext.h"
+
 #include "symbol/Identifier.h"
 
+#include <vipir/Module.h>
+
 namespace parser
 {
-    ConstexprStatement::ConstexprStatement(Type* type, std::vector<std::string> names, ASTNodePtr&& value, lexing::Token token, bool global)
+    ConstexprStatement::ConstexprStatement(CompilerContext& context, Type* type, std::vector<std::string> names, ASTNodePtr&& value, lexing::Token token, bool global, LocalSymbol* localSymbol)
         : mNames(std::move(names))
         , mValue(std::move(value))
         , mToken(std::move(token))
         , mGlobal(global)
+        , mGlobalSymbol(nullptr)
+        , mLocalSymbol(localSymbol)
+        , mFolded(false)
     {
         mType = type;
 
+        if (mLocalSymbol)
+        {
+            mLocalSymbol->constexprDefinition = this;
+        }
+
         if (mGlobal)
         {
             std::string mangledName = "_CE" + mType->getMangleID();
@@ -19,12 +35,19 @@ namespace parser
                 mangledName += std::to_string(name.length());
                 mangledName += name;
             }
-            symbol::AddIdentifier(mangledName, mNames);
-            GlobalVariables[mangledName] = GlobalSymbol(nullptr, mType);
+            symbol::AddIdentifier(context, mangledName, mNames);
+            mGlobalSymbol = &context.globals[mangledName];
+            *mGlobalSymbol = GlobalSymbol(nullptr, mType);
+            mGlobalSymbol->constexprDefinition = this;
         }
     }
 
-    void ConstexprStatement::typeCheck(Scope *scope, diagnostic::Diagnostics &diag)
+    ASTNodePtr& ConstexprStatement::getValue()
+    {
+        return mValue;
+    }
+
+    void ConstexprStatement::typeCheck(Scope *scope, CompilerContext& context, diagnostic::Diagnostics &diag)
     {
         if (mValue)
         {
@@ -34,36 +57,83 @@ namespace parser
                     fmt::bold, mType->getName(), fmt::defaults,
                     fmt::bold, mValue->getType()->getName(), fmt::defaults));
             }
-            mValue->typeCheck(scope, diag);
+            mValue->typeCheck(scope, context, diag);
         }
     }
 
-    vipir::Value* ConstexprStatement::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag)
+    vipir::Value* ConstexprStatement::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
         if (!mValue) return nullptr;
 
-        if (!mGlobal)
-        {
-            vipir::Value* constant = mValue->emit(builder, module, scope, diag);
+        vipir::Value* value = mValue->emit(builder, module, scope, context, diag);
 
-            if (mNames.size() != 1)
-                diag.compilerError(mToken.getStart(), mToken.getEnd(), "internal parser error");
+        // Arrays and structs are indexed and accessed through their address,
+        // which a bare constant doesn't have, so they're emitted as data
+        if ((mType->isArrayType() || mType->isStructType()) && value->isConstant())
+        {
+            vipir::GlobalVar* global = module.createGlobalVar(mType->getVipirType());
+            global->setInitialValue(value);
+            value = global;
+        }
 
-            scope->locals[mNames[0]].alloca = constant;
+        if (!mGlobal)
+        {
+            mLocalSymbol->alloca = value;
         }
         else
         {
-            std::string mangledName = "_CE" + mType->getMangleID();
-            for (auto& name : mNames)
+            mGlobalSymbol->global = value;
+        }
+
+        return nullptr;
+    }
+
+    ASTNodePtr ConstexprStatement::fold(CompilerContext& context, diagnostic::Diagnostics& diag)
+    {
+        if (!mFolded)
+        {
+            mFolded = true; // set first, so a constexpr defined in terms of itself just stays unfolded
+            Fold(mValue, context, diag);
+
+            // Whatever folding left, such as a call, is run now and emitted as data
+            if (ASTNodePtr value = ConstantEvaluator::EvaluateInitializer(mValue.get(), mToken, context, diag))
             {
-                mangledName += std::to_string(name.length());
-                mangledName += name;
+                mValue = std::move(value);
             }
-
-            vipir::Value* constant = mValue->emit(builder, module, scope, diag);
-            GlobalVariables[mangledName] = GlobalSymbol(constant, mType);
         }
+        return nullptr;
+    }
+
+    ASTNodePtr ConstexprStatement::foldUse(const lexing::Token& token, CompilerContext& context, diagnostic::Diagnostics& diag)
+    {
+        fold(context, diag);
 
+        if (auto integer = dynamic_cast<IntegerLiteral*>(mValue.get()))
+        {
+            return context.astArena.create<IntegerLiteral>(integer->getValue(), integer->getType(), token);
+        }
+        if (auto boolean = dynamic_cast<BooleanLiteral*>(mValue.get()))
+        {
+            return context.astArena.create<BooleanLiteral>(context, boolean->getValue(), token);
+        }
         return nullptr;
     }
-}
\ No newline at end of file
+
+    std::optional<ConstantValue> ConstexprStatement::evaluate(ConstantEvaluator& evaluator)
+    {
+        return ConstantValue{}; // uses are evaluated through evaluateUse
+    }
+
+    std::optional<ConstantValue> ConstexprStatement::evaluateUse(ConstantEvaluator& evaluator)
+    {
+        fold(evaluator.getContext(), evaluator.getDiagnostics());
+
+        if (!mValue) return std::nullopt;
+        return evaluator.evaluate(mValue.get());
+    }
+
+    void ConstexprStatement::forEachChild(const std::function<void(ASTNode*)>& callback)
+    {
+        if (mValue) callback(mValue.get());
+    }
+}
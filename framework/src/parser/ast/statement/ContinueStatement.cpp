@@ -1,4 +1,5 @@
 #include "parser/ast/statement/ContinueStatement.h"
+#include "parser/ast/ConstantEvaluator.h"
 
 namespace parser
 {
@@ -7,11 +8,11 @@ namespace parser
     {
     }
 
-    void ContinueStatement::typeCheck(Scope* scope, diagnostic::Diagnostics& diag)
+    void ContinueStatement::typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
     }
 
-    vipir::Value* ContinueStatement::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag)
+    vipir::Value* ContinueStatement::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
         vipir::BasicBlock* continueTo = scope->findContinueBB();
 
@@ -24,4 +25,15 @@ namespace parser
 
         return nullptr;
     }
-}
\ No newline at end of file
+
+    std::optional<ConstantValue> ContinueStatement::evaluate(ConstantEvaluator& evaluator)
+    {
+        evaluator.setFlow(ConstantEvaluator::Flow::Continue);
+        return ConstantValue{};
+    }
+
+    bool ContinueStatement::leavesBlock() const
+    {
+        return true;
+    }
+}
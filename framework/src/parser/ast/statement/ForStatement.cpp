@@ -1,7 +1,11 @@
 #include "parser/ast/statement/ForStatement.h"
+#include "parser/ast/statement/CompoundStatement.h"
+#include "parser/ast/ConstantEvaluator.h"
 
 #include "parser/ast/expression/BooleanLiteral.h"
 
+#include "context/CompilerContext.h"
+
 namespace parser
 {
     ForStatement::ForStatement(parser::ASTNodePtr&& init, parser::ASTNodePtr&& condition, std::vector<parser::ASTNodePtr>&& loopExpr, parser::ASTNodePtr&& body, Scope* scope)
@@ -13,10 +17,12 @@ namespace parser
     {
     }
 
-    void ForStatement::typeCheck(Scope* scope, diagnostic::Diagnostics& diag)
+    void ForStatement::typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
+        scope = mScope.get();
+
         if (mInit)
-            mInit->typeCheck(scope, diag);
+            mInit->typeCheck(scope, context, diag);
         if (mCondition)
         {
             if (!mCondition->getType()->isBooleanType())
@@ -24,17 +30,17 @@ namespace parser
                 diag.compilerError(mCondition->getDebugToken().getStart(), mCondition->getDebugToken().getEnd(), std::format("For-expression condition must have type '{}bool{}'",
                     fmt::bold, fmt::defaults));
             }
-            mCondition->typeCheck(scope, diag);
+            mCondition->typeCheck(scope, context, diag);
         }
         for (auto& node : mLoopExpr)
         {
-            node->typeCheck(scope, diag);
+            node->typeCheck(scope, context, diag);
         }
 
-        mBody->typeCheck(scope, diag);
+        mBody->typeCheck(scope, context, diag);
     }
 
-    vipir::Value* ForStatement::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag)
+    vipir::Value* ForStatement::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
         vipir::BasicBlock* conditionBasicBlock = vipir::BasicBlock::Create("", builder.getInsertPoint()->getParent());
         vipir::BasicBlock* bodyBasicBlock = vipir::BasicBlock::Create("", builder.getInsertPoint()->getParent());
@@ -48,17 +54,17 @@ namespace parser
         bodyBasicBlock->loopEnd() = doneBasicBlock;
 
         if (mInit)
-            mInit->emit(builder, module, scope, diag);
+            mInit->emit(builder, module, scope, context, diag);
 
         if (!mCondition)
         {
             builder.CreateBr(bodyBasicBlock);
             builder.setInsertPoint(bodyBasicBlock);
 
-            mBody->emit(builder, module, scope, diag);
+            mBody->emit(builder, module, scope, context, diag);
             for (auto& node : mLoopExpr)
             {
-                node->emit(builder, module, scope, diag);
+                node->emit(builder, module, scope, context, diag);
             }
 
             builder.CreateBr(bodyBasicBlock);
@@ -77,9 +83,9 @@ namespace parser
                 builder.CreateBr(bodyBasicBlock);
                 builder.setInsertPoint(bodyBasicBlock);
 
-                mBody->emit(builder, module, scope, diag);
+                mBody->emit(builder, module, scope, context, diag);
                 for (auto& node : mLoopExpr) {
-                    node->emit(builder, module, scope, diag);
+                    node->emit(builder, module, scope, context, diag);
                 }
 
                 builder.CreateBr(bodyBasicBlock);
@@ -95,15 +101,15 @@ namespace parser
 
         builder.CreateBr(conditionBasicBlock);
         builder.setInsertPoint(conditionBasicBlock);
-        vipir::Value* condition = mCondition->emit(builder, module, scope, diag);
+        vipir::Value* condition = mCondition->emit(builder, module, scope, context, diag);
         builder.CreateCondBr(condition, bodyBasicBlock, doneBasicBlock);
 
         builder.setInsertPoint(bodyBasicBlock);
 
-        mBody->emit(builder, module, scope, diag);
+        mBody->emit(builder, module, scope, context, diag);
         for (auto& node : mLoopExpr)
         {
-            node->emit(builder, module, scope, diag);
+            node->emit(builder, module, scope, context, diag);
         }
 
         builder.CreateBr(conditionBasicBlock);
@@ -112,4 +118,60 @@ namespace parser
 
         return nullptr;
     }
-}
\ No newline at end of file
+
+    ASTNodePtr ForStatement::fold(CompilerContext& context, diagnostic::Diagnostics& diag)
+    {
+        Fold(mInit, context, diag);
+        Fold(mCondition, context, diag);
+        for (auto& node : mLoopExpr)
+        {
+            Fold(node, context, diag);
+        }
+        Fold(mBody, context, diag);
+
+        // The body never runs, but the initializer still does
+        auto boolean = dynamic_cast<BooleanLiteral*>(mCondition.get());
+        if (boolean && !boolean->getValue())
+        {
+            if (mInit)
+                return std::move(mInit);
+            return context.astArena.create<CompoundStatement>(std::vector<ASTNodePtr>(), nullptr);
+        }
+        return nullptr;
+    }
+
+    std::optional<ConstantValue> ForStatement::evaluate(ConstantEvaluator& evaluator)
+    {
+        if (mInit && !evaluator.evaluate(mInit.get())) return std::nullopt;
+
+        while (true)
+        {
+            if (mCondition)
+            {
+                std::optional<ConstantValue> condition = evaluator.evaluate(mCondition.get());
+                if (!condition) return std::nullopt;
+                if (!condition->integer) break;
+            }
+
+            if (!evaluator.evaluate(mBody.get())) return std::nullopt;
+            if (evaluator.leaveLoop()) break;
+
+            for (auto& node : mLoopExpr)
+            {
+                if (!evaluator.evaluate(node.get())) return std::nullopt;
+            }
+        }
+        return ConstantValue{};
+    }
+
+    void ForStatement::forEachChild(const std::function<void(ASTNode*)>& callback)
+    {
+        if (mInit) callback(mInit.get());
+        if (mCondition) callback(mCondition.get());
+        for (auto& expression : mLoopExpr)
+        {
+            callback(expression.get());
+        }
+        callback(mBody.get());
+    }
+}
@@ -1,6 +1,12 @@
 // Copyright 2024 solar-mist
 
 #include "parser/ast/statement/IfStatement.h"
+#include "parser/ast/statement/CompoundStatement.h"
+#include "parser/ast/ConstantEvaluator.h"
+
+#include "parser/ast/expression/BooleanLiteral.h"
+
+#include "context/CompilerContext.h"
 
 #include <vipir/IR/Instruction/RetInst.h>
 
@@ -15,22 +21,22 @@ namespace parser
     {
     }
 
-    void IfStatement::typeCheck(Scope* scope, diagnostic::Diagnostics& diag)
+    void IfStatement::typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
         if (!mCondition->getType()->isBooleanType())
         {
             diag.compilerError(mCondition->getDebugToken().getStart(), mCondition->getDebugToken().getEnd(), std::format("If-statement condition must have type '{}bool{}'",
                 fmt::bold, fmt::defaults));
         }
-        mCondition->typeCheck(scope, diag);
-        mBody->typeCheck(scope, diag);
+        mCondition->typeCheck(scope, context, diag);
+        mBody->typeCheck(scope, context, diag);
         if (mElseBody)
-            mElseBody->typeCheck(scope, diag);
+            mElseBody->typeCheck(scope, context, diag);
     }
 
-    vipir::Value* IfStatement::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag)
+    vipir::Value* IfStatement::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
-        vipir::Value* condition = mCondition->emit(builder, module, scope, diag);
+        vipir::Value* condition = mCondition->emit(builder, module, scope, context, diag);
 
         vipir::BasicBlock* trueBasicBlock = vipir::BasicBlock::Create("", builder.getInsertPoint()->getParent());
         vipir::BasicBlock* falseBasicBlock;
@@ -53,13 +59,13 @@ namespace parser
         }
 
         builder.setInsertPoint(trueBasicBlock);
-        mBody->emit(builder, module, scope, diag);
+        mBody->emit(builder, module, scope, context, diag);
         builder.CreateBr(mergeBasicBlock);
 
         if (mElseBody)
         {
             builder.setInsertPoint(falseBasicBlock);
-            mElseBody->emit(builder, module, scope, diag);
+            mElseBody->emit(builder, module, scope, context, diag);
             builder.CreateBr(mergeBasicBlock);
         }
 
@@ -68,4 +74,51 @@ namespace parser
         return nullptr;
     }
 
-}
\ No newline at end of file
+    ASTNodePtr IfStatement::fold(CompilerContext& context, diagnostic::Diagnostics& diag)
+    {
+        Fold(mCondition, context, diag);
+        Fold(mBody, context, diag);
+        Fold(mElseBody, context, diag);
+
+        // Only the branch that's taken is kept, with an empty block standing in if that's neither
+        if (auto boolean = dynamic_cast<BooleanLiteral*>(mCondition.get()))
+        {
+            if (boolean->getValue())
+                return std::move(mBody);
+            if (mElseBody)
+                return std::move(mElseBody);
+            return context.astArena.create<CompoundStatement>(std::vector<ASTNodePtr>(), nullptr);
+        }
+
+        auto elseBlock = dynamic_cast<CompoundStatement*>(mElseBody.get());
+        if (elseBlock && elseBlock->getBody().empty())
+        {
+            mElseBody = nullptr;
+        }
+        return nullptr;
+    }
+
+    std::optional<ConstantValue> IfStatement::evaluate(ConstantEvaluator& evaluator)
+    {
+        std::optional<ConstantValue> condition = evaluator.evaluate(mCondition.get());
+        if (!condition) return std::nullopt;
+
+        if (condition->integer)
+            return evaluator.evaluate(mBody.get());
+        if (mElseBody)
+            return evaluator.evaluate(mElseBody.get());
+        return ConstantValue{};
+    }
+
+    bool IfStatement::leavesBlock() const
+    {
+        return mElseBody && mBody->leavesBlock() && mElseBody->leavesBlock();
+    }
+
+    void IfStatement::forEachChild(const std::function<void(ASTNode*)>& callback)
+    {
+        callback(mCondition.get());
+        callback(mBody.get());
+        if (mElseBody) callback(mElseBody.get());
+    }
+}
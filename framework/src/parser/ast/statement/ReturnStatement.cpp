@@ -2,7 +2,11 @@
 
 #include "parser/ast/statement/ReturnStatement.h"
 
+#include "parser/ast/ConstantEvaluator.h"
+
 #include <vipir/IR/Instruction/RetInst.h>
+#include <vipir/IR/Instruction/StoreInst.h>
+#include <vipir/IR/BasicBlock.h>
 
 namespace parser
 {
@@ -11,28 +15,69 @@ namespace parser
     {
     }
 
-    void ReturnStatement::typeCheck(Scope* scope, diagnostic::Diagnostics& diag)
+    void ReturnStatement::typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
-        Type* returnType = mReturnValue ? mReturnValue->getType() : Type::Get("void");
-        if (returnType != scope->currentReturnType)
+        Type* returnType = mReturnValue ? mReturnValue->getType() : Type::GetVoidType(context);
+        Type* functionReturnType = scope->findReturnType();
+        if (returnType != functionReturnType)
         {
             diag.compilerError(mReturnValue->getDebugToken().getStart(), mReturnValue->getDebugToken().getEnd(), std::format("Return value of type '{}{}{}' is incompatible with function with return type '{}{}{}'",
                 fmt::bold, returnType->getName(), fmt::defaults,
-                fmt::bold, scope->currentReturnType->getName(), fmt::defaults));
+                fmt::bold, functionReturnType->getName(), fmt::defaults));
         }
         if (mReturnValue)
-            mReturnValue->typeCheck(scope, diag);
+            mReturnValue->typeCheck(scope, context, diag);
     }
 
-    vipir::Value* ReturnStatement::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag)
+    vipir::Value* ReturnStatement::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
         vipir::Value* returnValue = nullptr;
         if (mReturnValue)
         {
-            returnValue = mReturnValue->emit(builder, module, scope, diag);
+            returnValue = mReturnValue->emit(builder, module, scope, context, diag);
+        }
+
+        // An inlined body returns to its caller by jumping past itself
+        if (vipir::BasicBlock* returnBasicBlock = scope->findReturnBB())
+        {
+            if (returnValue)
+            {
+                builder.CreateStore(scope->function->returnSlot, returnValue);
+            }
+            return builder.CreateBr(returnBasicBlock);
         }
 
         return builder.CreateRet(returnValue);
     }
 
-}
\ No newline at end of file
+    ASTNodePtr ReturnStatement::fold(CompilerContext& context, diagnostic::Diagnostics& diag)
+    {
+        Fold(mReturnValue, context, diag);
+        return nullptr;
+    }
+
+    std::optional<ConstantValue> ReturnStatement::evaluate(ConstantEvaluator& evaluator)
+    {
+        ConstantValue value;
+        if (mReturnValue)
+        {
+            std::optional<ConstantValue> returnValue = evaluator.evaluate(mReturnValue.get());
+            if (!returnValue) return std::nullopt;
+
+            value = std::move(*returnValue);
+        }
+
+        evaluator.setFlow(ConstantEvaluator::Flow::Return, std::move(value));
+        return ConstantValue{};
+    }
+
+    bool ReturnStatement::leavesBlock() const
+    {
+        return true;
+    }
+
+    void ReturnStatement::forEachChild(const std::function<void(ASTNode*)>& callback)
+    {
+        if (mReturnValue) callback(mReturnValue.get());
+    }
+}
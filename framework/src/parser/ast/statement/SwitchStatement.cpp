@@ -1,78 +1,401 @@
 #include "parser/ast/statement/SwitchStatement.h"
+#include "parser/ast/ConstantEvaluator.h"
 
 #include "parser/ast/statement/BreakStatement.h"
+#include "parser/ast/statement/CompoundStatement.h"
 #include "parser/ast/statement/ContinueStatement.h"
 #include "parser/ast/statement/ReturnStatement.h"
+#include "parser/ast/statement/VariableDeclaration.h"
+
+#include "parser/ast/expression/IntegerLiteral.h"
+
+#include "context/CompilerContext.h"
+
+#include "type/IntegerType.h"
 
 #include <vipir/IR/Instruction/BinaryInst.h>
 
+#include <algorithm>
+#include <cstdint>
+
 namespace parser
 {
-    SwitchStatement::SwitchStatement(ASTNodePtr&& value, std::vector<SwitchSection>&& sections)
+    // Below this many cases a chain of equality tests is as short as a compare tree
+    static constexpr int MinCompareTreeCases = 4;
+
+    // Either another compare in the dispatch code or the section it ends up in
+    struct SwitchTarget
+    {
+        bool isStep;
+        int index; // into the steps, or into the sections with -1 meaning no case matched
+    };
+
+    struct SwitchStep
+    {
+        enum class Compare
+        {
+            Equal,
+            Less
+        };
+
+        Compare compare;
+        vipir::Value* label;
+        ASTNode* labelNode; // emitted in the step's own block when label is null
+        SwitchTarget onTrue;
+        SwitchTarget onFalse;
+    };
+
+    struct SwitchCase
+    {
+        std::intmax_t value;
+        vipir::Value* label;
+        ASTNode* labelNode;
+        int section;
+    };
+
+    static SwitchTarget AddStep(std::vector<SwitchStep>& steps, SwitchStep step)
+    {
+        steps.push_back(step);
+        return { true, static_cast<int>(steps.size()) - 1 };
+    }
+
+    // Binary search over cases[first, last), which are sorted by value, for a
+    // value already known to lie in [low, high]. Once the compares above pin
+    // the value down to a single case, as they do inside a run of consecutive
+    // case values, it is reached without testing it for equality
+    static SwitchTarget BuildCompareTree(std::vector<SwitchStep>& steps, const std::vector<SwitchCase>& cases, std::size_t first, std::size_t last,
+                                         std::intmax_t low, std::intmax_t high)
+    {
+        if (last - first == 1)
+        {
+            const SwitchCase& switchCase = cases[first];
+            SwitchTarget target = { false, switchCase.section };
+            if (low == switchCase.value && high == switchCase.value)
+            {
+                return target;
+            }
+            return AddStep(steps, { SwitchStep::Compare::Equal, switchCase.label, nullptr, target, { false, -1 } });
+        }
+
+        std::size_t middle = first + (last - first) / 2;
+        const SwitchCase& pivot = cases[middle];
+
+        SwitchTarget left = BuildCompareTree(steps, cases, first, middle, low, pivot.value - 1);
+        SwitchTarget right = BuildCompareTree(steps, cases, middle, last, pivot.value, high);
+        return AddStep(steps, { SwitchStep::Compare::Less, pivot.label, nullptr, left, right });
+    }
+
+    static int CompareDepth(const std::vector<SwitchStep>& steps, SwitchTarget target)
+    {
+        if (!target.isStep)
+        {
+            return 0;
+        }
+        const SwitchStep& step = steps[target.index];
+        return 1 + std::max(CompareDepth(steps, step.onTrue), CompareDepth(steps, step.onFalse));
+    }
+
+
+    SwitchStatement::SwitchStatement(ASTNodePtr&& value, std::vector<SwitchSection>&& sections, Scope* scope, lexing::Token token)
         : mValue(std::move(value))
         , mSections(std::move(sections))
+        , mScope(scope)
     {
+        mPreferredDebugToken = std::move(token);
     }
 
-    void SwitchStatement::typeCheck(Scope* scope, diagnostic::Diagnostics& diag)
+    void SwitchStatement::typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
+        mValue->typeCheck(scope, context, diag);
+
+        scope = mScope.get();
         for (auto& section : mSections)
         {
             if (section.label)
-                section.label->typeCheck(scope, diag);
+                section.label->typeCheck(scope, context, diag);
             for (auto& node : section.body)
             {
-                node->typeCheck(scope, diag);
+                node->typeCheck(scope, context, diag);
+
+                // Jumping to a later section skips this declaration, so a
+                // value for it wouldn't be there for that section to read
+                if (auto declaration = dynamic_cast<VariableDeclaration*>(node.get()))
+                {
+                    declaration->getSymbol()->needsSlot = true;
+                }
             }
         }
     }
 
-    vipir::Value* SwitchStatement::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag)
+    vipir::Value* SwitchStatement::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
-        vipir::Value* value = mValue->emit(builder, module, scope, diag);
+        vipir::Value* value = mValue->emit(builder, module, scope, context, diag);
 
         if (mSections.empty())
             return nullptr;
 
-        std::vector<vipir::BasicBlock*> conditionBlocks;
-        std::vector<vipir::BasicBlock*> bodyBlocks;
+        scope = mScope.get();
 
+        // Labels are tested in order and a default section is taken as soon
+        // as the tests reach it, so cases after it can never be entered
+        int defaultSection = -1;
+        int labelCount = mSections.size();
+        for (int i = 0; i < mSections.size(); i++)
+        {
+            if (!mSections[i].label)
+            {
+                defaultSection = i;
+                labelCount = i;
+                break;
+            }
+        }
+
+        // Literal labels emit no code, so they can be emitted up front and
+        // tested in any order. Anything else is emitted in its own step, so
+        // it's only evaluated once the labels before it have failed to match
+        bool constantLabels = std::all_of(mSections.begin(), mSections.begin() + labelCount, [](const SwitchSection& section) {
+            return dynamic_cast<IntegerLiteral*>(section.label.get()) != nullptr;
+        });
+        std::vector<SwitchCase> cases;
+        bool ordered = true;
+
+        // The compare tree orders values with CmpLT, which treats them as
+        // signed, so an unsigned label with its top bit set would be out of order
+        Type* valueType = mValue->getType();
+        bool isUnsigned = valueType->isIntegerType() && !static_cast<IntegerType*>(valueType)->isSigned();
+        std::intmax_t signedLimit = valueType->getSize() < 64 ? std::intmax_t(1) << (valueType->getSize() - 1) : INTMAX_MAX;
+
+        for (int i = 0; i < labelCount; i++)
+        {
+            if (!constantLabels)
+            {
+                cases.push_back({ 0, nullptr, mSections[i].label.get(), i });
+                continue;
+            }
+
+            std::intmax_t labelValue = static_cast<IntegerLiteral*>(mSections[i].label.get())->getValue();
+            if (isUnsigned && (labelValue < 0 || labelValue >= signedLimit))
+            {
+                ordered = false;
+            }
+            vipir::Value* label = mSections[i].label->emit(builder, module, scope, context, diag);
+            cases.push_back({ labelValue, label, nullptr, i });
+        }
+
+        std::vector<SwitchStep> steps;
+        SwitchTarget root = { false, -1 };
+        if (constantLabels && ordered && cases.size() >= MinCompareTreeCases)
+        {
+            // A value that appears more than once goes to its first case
+            std::stable_sort(cases.begin(), cases.end(), [](const SwitchCase& lhs, const SwitchCase& rhs) {
+                return lhs.value < rhs.value;
+            });
+            cases.erase(std::unique(cases.begin(), cases.end(), [](const SwitchCase& lhs, const SwitchCase& rhs) {
+                return lhs.value == rhs.value;
+            }), cases.end());
+
+            root = BuildCompareTree(steps, cases, 0, cases.size(), INTMAX_MIN, INTMAX_MAX);
+
+            if (diag.remarksEnabled())
+            {
+                int equalityTests = std::count_if(steps.begin(), steps.end(), [](const SwitchStep& step) {
+                    return step.compare == SwitchStep::Compare::Equal;
+                });
+                diag.compilerRemark(mPreferredDebugToken.getStart(), std::format("switch over {} cases lowered to a compare tree "
+                    "of depth {}, {} cases reached without an equality test", cases.size(), CompareDepth(steps, root), cases.size() - equalityTests));
+            }
+        }
+        else
+        {
+            for (auto it = cases.rbegin(); it != cases.rend(); ++it)
+            {
+                root = AddStep(steps, { SwitchStep::Compare::Equal, it->label, it->labelNode, { false, it->section }, root });
+            }
+
+            if (diag.remarksEnabled())
+            {
+                std::string_view reason = !constantLabels ? "not every label is a literal"
+                                        : !ordered ? "labels don't fit a signed compare"
+                                        : "too few cases for a tree";
+                diag.compilerRemark(mPreferredDebugToken.getStart(), std::format("switch over {} cases lowered to a compare chain ({})", cases.size(), reason));
+            }
+        }
+
+        // The dispatch blocks come first so that a section without a break
+        // falls through into the next one, and the last into endBlock
+        vipir::Function* function = builder.getInsertPoint()->getParent();
+
+        std::vector<vipir::BasicBlock*> stepBlocks;
+        std::vector<vipir::BasicBlock*> bodyBlocks;
+        for (auto& step : steps)
+            stepBlocks.push_back(vipir::BasicBlock::Create("", function));
         for (auto& sec : mSections)
-            conditionBlocks.push_back(vipir::BasicBlock::Create("", builder.getInsertPoint()->getParent()));
-        for (auto& sec : mSections)
-            bodyBlocks.push_back(vipir::BasicBlock::Create("", builder.getInsertPoint()->getParent()));
+            bodyBlocks.push_back(vipir::BasicBlock::Create("", function));
 
-        vipir::BasicBlock* endBlock = vipir::BasicBlock::Create("", builder.getInsertPoint()->getParent());
+        vipir::BasicBlock* endBlock = vipir::BasicBlock::Create("", function);
         scope->breakTo = endBlock;
 
+        vipir::BasicBlock* noMatchBlock = defaultSection == -1 ? endBlock : bodyBlocks[defaultSection];
+        auto blockFor = [&](SwitchTarget target) {
+            if (target.isStep) return stepBlocks[target.index];
+            return target.index == -1 ? noMatchBlock : bodyBlocks[target.index];
+        };
+
+        builder.CreateBr(blockFor(root));
+        for (int i = 0; i < steps.size(); i++)
+        {
+            auto& step = steps[i];
+            builder.setInsertPoint(stepBlocks[i]);
+
+            vipir::Value* label = step.label ? step.label : step.labelNode->emit(builder, module, scope, context, diag);
+            vipir::Value* condition = nullptr;
+            switch (step.compare)
+            {
+                case SwitchStep::Compare::Equal:
+                    condition = builder.CreateCmpEQ(value, label);
+                    break;
+                case SwitchStep::Compare::Less:
+                    condition = builder.CreateCmpLT(value, label);
+                    break;
+            }
+            builder.CreateCondBr(condition, blockFor(step.onTrue), blockFor(step.onFalse));
+        }
+
         for (int i = 0; i < mSections.size(); i++)
         {
-            auto& sec = mSections[i];
-            auto conditionBlock = conditionBlocks[i];
-            auto bodyBlock = bodyBlocks[i];
-            
-            builder.setInsertPoint(conditionBlock);
-            if (sec.label)
+            builder.setInsertPoint(bodyBlocks[i]);
+            for (auto& node : mSections[i].body)
+                node->emit(builder, module, scope, context, diag);
+        }
+
+        builder.setInsertPoint(endBlock);
+
+        return nullptr;
+    }
+
+    ASTNodePtr SwitchStatement::fold(CompilerContext& context, diagnostic::Diagnostics& diag)
+    {
+        Fold(mValue, context, diag);
+        for (auto& section : mSections)
+        {
+            Fold(section.label, context, diag);
+            CompoundStatement::FoldBody(section.body, context, diag);
+        }
+
+        auto value = dynamic_cast<IntegerLiteral*>(mValue.get());
+        if (!value || !mValue->getType()->isIntegerType())
+        {
+            return nullptr;
+        }
+
+        // With the value and every label known there's only one section
+        // control can enter at: the first that matches, or a default reached
+        // before any does. The sections before it are dead, and it falls
+        // through into the rest, so they become a single default section
+        auto valueType = static_cast<IntegerType*>(mValue->getType());
+        int entry = -1;
+        int defaultSection = -1;
+        for (int i = 0; i < mSections.size() && entry == -1; i++)
+        {
+            if (!mSections[i].label)
+            {
+                defaultSection = i;
+                break;
+            }
+
+            auto label = dynamic_cast<IntegerLiteral*>(mSections[i].label.get());
+            if (!label)
             {
-                vipir::Value* secValue = sec.label->emit(builder, module, scope, diag);
-                vipir::Value* condition = builder.CreateCmpEQ(value, secValue);
-                vipir::BasicBlock* falseBlock = endBlock;
-                if (i < mSections.size() - 1)
-                    falseBlock = conditionBlocks[i + 1];
-                builder.CreateCondBr(condition, bodyBlock, falseBlock);
+                return nullptr;
             }
-            else // Default case
+            if (valueType->wrap(label->getValue()) == valueType->wrap(value->getValue()))
             {
-                builder.CreateBr(bodyBlock);
+                entry = i;
             }
+        }
 
-            builder.setInsertPoint(bodyBlock);
-            for (auto& node : sec.body)
-                node->emit(builder, module, scope, diag);
+        if (entry == -1)
+        {
+            entry = defaultSection;
+        }
+        if (entry == -1)
+        {
+            return context.astArena.create<CompoundStatement>(std::vector<ASTNodePtr>(), nullptr);
         }
 
-        builder.setInsertPoint(endBlock);
+        SwitchSection merged;
+        for (int i = entry; i < mSections.size(); i++)
+        {
+            for (auto& node : mSections[i].body)
+            {
+                if (!merged.body.empty() && merged.body.back()->leavesBlock())
+                {
+                    break;
+                }
+                merged.body.push_back(std::move(node));
+            }
+        }
+        mSections.clear();
+        mSections.push_back(std::move(merged));
 
         return nullptr;
     }
-}
\ No newline at end of file
+
+    std::optional<ConstantValue> SwitchStatement::evaluate(ConstantEvaluator& evaluator)
+    {
+        std::optional<ConstantValue> value = evaluator.evaluate(mValue.get());
+        if (!value) return std::nullopt;
+
+        // Labels are tested in order, and a default is taken as soon as it's reached
+        int first = -1;
+        for (int i = 0; i < mSections.size() && first == -1; i++)
+        {
+            if (!mSections[i].label)
+            {
+                first = i;
+                break;
+            }
+
+            std::optional<ConstantValue> label = evaluator.evaluate(mSections[i].label.get());
+            if (!label) return std::nullopt;
+
+            if (label->integer == value->integer) first = i;
+        }
+        if (first == -1)
+        {
+            return ConstantValue{};
+        }
+
+        // Sections fall through into the next until something leaves the switch
+        for (int i = first; i < mSections.size(); i++)
+        {
+            for (auto& node : mSections[i].body)
+            {
+                if (!evaluator.evaluate(node.get())) return std::nullopt;
+
+                if (evaluator.getFlow() != ConstantEvaluator::Flow::Normal)
+                {
+                    if (evaluator.getFlow() == ConstantEvaluator::Flow::Break)
+                    {
+                        evaluator.setFlow(ConstantEvaluator::Flow::Normal);
+                    }
+                    return ConstantValue{};
+                }
+            }
+        }
+        return ConstantValue{};
+    }
+
+    void SwitchStatement::forEachChild(const std::function<void(ASTNode*)>& callback)
+    {
+        callback(mValue.get());
+        for (auto& section : mSections)
+        {
+            if (section.label) callback(section.label.get());
+            for (auto& node : section.body)
+            {
+                callback(node.get());
+            }
+        }
+    }
+}
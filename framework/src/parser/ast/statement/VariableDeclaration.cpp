@@ -2,20 +2,28 @@
 
 #include "parser/ast/statement/VariableDeclaration.h"
 
+#include "parser/ast/ConstantEvaluator.h"
+
 #include <iostream>
 #include <vipir/IR/Instruction/AllocaInst.h>
 #include <vipir/IR/Instruction/StoreInst.h>
 
 namespace parser
 {
-    VariableDeclaration::VariableDeclaration(Type* type, std::string&& name, ASTNodePtr&& initialValue)
+    VariableDeclaration::VariableDeclaration(Type* type, std::string&& name, ASTNodePtr&& initialValue, LocalSymbol* symbol)
         : mName(std::move(name))
         , mInitialValue(std::move(initialValue))
+        , mSymbol(symbol)
     {
         mType = type;
     }
 
-    void VariableDeclaration::typeCheck(Scope* scope, diagnostic::Diagnostics& diag)
+    LocalSymbol* VariableDeclaration::getSymbol() const
+    {
+        return mSymbol;
+    }
+
+    void VariableDeclaration::typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
         if (mInitialValue)
         {
@@ -25,23 +33,55 @@ namespace parser
                     fmt::bold, mType->getName(), fmt::defaults,
                     fmt::bold, mInitialValue->getType()->getName(), fmt::defaults));
             }
-            mInitialValue->typeCheck(scope, diag);
+            mInitialValue->typeCheck(scope, context, diag);
+        }
+        else
+        {
+            mSymbol->needsSlot = true; // there's no value to keep until it's assigned one
         }
     }
 
-    vipir::Value* VariableDeclaration::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag)
+    vipir::Value* VariableDeclaration::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
-        vipir::AllocaInst* alloca = builder.CreateAlloca(mType->getVipirType());
+        if (mSymbol->inRegister())
+        {
+            mSymbol->alloca = mInitialValue->emit(builder, module, scope, context, diag);
+            return nullptr;
+        }
+
+        vipir::AllocaInst* alloca = scope->createAlloca(builder, mType->getVipirType());
 
         if (mInitialValue)
         {
-            vipir::Value* initalValue = mInitialValue->emit(builder, module, scope, diag);
+            vipir::Value* initalValue = mInitialValue->emit(builder, module, scope, context, diag);
             builder.CreateStore(alloca, initalValue);
         }
 
-        scope->locals[mName].alloca = alloca;
+        mSymbol->alloca = alloca;
+
+        return nullptr;
+    }
 
+    ASTNodePtr VariableDeclaration::fold(CompilerContext& context, diagnostic::Diagnostics& diag)
+    {
+        Fold(mInitialValue, context, diag);
         return nullptr;
     }
 
-}
\ No newline at end of file
+    std::optional<ConstantValue> VariableDeclaration::evaluate(ConstantEvaluator& evaluator)
+    {
+        ConstantValue* local = evaluator.getLocal(mSymbol);
+        if (!local) return std::nullopt;
+
+        std::optional<ConstantValue> value = mInitialValue ? evaluator.evaluate(mInitialValue.get()) : ConstantValue::Zero(mType);
+        if (!value) return std::nullopt;
+
+        *local = std::move(*value);
+        return ConstantValue{};
+    }
+
+    void VariableDeclaration::forEachChild(const std::function<void(ASTNode*)>& callback)
+    {
+        if (mInitialValue) callback(mInitialValue.get());
+    }
+}
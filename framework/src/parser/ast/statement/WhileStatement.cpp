@@ -1,8 +1,12 @@
 // Copyright 2024 solar-mist
 
 #include "parser/ast/statement/WhileStatement.h"
+#include "parser/ast/statement/CompoundStatement.h"
+#include "parser/ast/ConstantEvaluator.h"
 #include "parser/ast/expression/BooleanLiteral.h"
 
+#include "context/CompilerContext.h"
+
 #include <vipir/IR/Instruction/RetInst.h>
 
 #include <vipir/IR/BasicBlock.h>
@@ -16,18 +20,18 @@ namespace parser
     {
     }
 
-    void WhileStatement::typeCheck(Scope* scope, diagnostic::Diagnostics& diag)
+    void WhileStatement::typeCheck(Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
         if (!mCondition->getType()->isBooleanType())
         {
             diag.compilerError(mCondition->getDebugToken().getStart(), mCondition->getDebugToken().getEnd(), std::format("While-statement condition must have type '{}bool{}'",
                 fmt::bold, fmt::defaults));
         }
-        mCondition->typeCheck(scope, diag);
-        mBody->typeCheck(scope, diag);
+        mCondition->typeCheck(mScope.get(), context, diag);
+        mBody->typeCheck(mScope.get(), context, diag);
     }
 
-    vipir::Value* WhileStatement::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, diagnostic::Diagnostics& diag)
+    vipir::Value* WhileStatement::emit(vipir::IRBuilder& builder, vipir::Module& module, Scope* scope, CompilerContext& context, diagnostic::Diagnostics& diag)
     {
         vipir::BasicBlock* conditionBasicBlock = vipir::BasicBlock::Create("", builder.getInsertPoint()->getParent());
         vipir::BasicBlock* bodyBasicBlock = vipir::BasicBlock::Create("", builder.getInsertPoint()->getParent());
@@ -48,7 +52,7 @@ namespace parser
             {
                 builder.CreateBr(bodyBasicBlock);
                 builder.setInsertPoint(bodyBasicBlock);
-                mBody->emit(builder, module, scope, diag);
+                mBody->emit(builder, module, scope, context, diag);
                 builder.CreateBr(bodyBasicBlock);
             }
             else
@@ -61,15 +65,48 @@ namespace parser
 
         builder.CreateBr(conditionBasicBlock);
         builder.setInsertPoint(conditionBasicBlock);
-        vipir::Value* condition = mCondition->emit(builder, module, scope, diag);
+        vipir::Value* condition = mCondition->emit(builder, module, scope, context, diag);
         builder.CreateCondBr(condition, bodyBasicBlock, doneBasicBlock);
 
         builder.setInsertPoint(bodyBasicBlock);
-        mBody->emit(builder, module, scope, diag);
+        mBody->emit(builder, module, scope, context, diag);
         builder.CreateBr(conditionBasicBlock);
 
         builder.setInsertPoint(doneBasicBlock);
 
         return nullptr;
     }
-}
\ No newline at end of file
+
+    ASTNodePtr WhileStatement::fold(CompilerContext& context, diagnostic::Diagnostics& diag)
+    {
+        Fold(mCondition, context, diag);
+        Fold(mBody, context, diag);
+
+        auto boolean = dynamic_cast<BooleanLiteral*>(mCondition.get());
+        if (boolean && !boolean->getValue())
+        {
+            return context.astArena.create<CompoundStatement>(std::vector<ASTNodePtr>(), nullptr);
+        }
+        return nullptr;
+    }
+
+    std::optional<ConstantValue> WhileStatement::evaluate(ConstantEvaluator& evaluator)
+    {
+        while (true)
+        {
+            std::optional<ConstantValue> condition = evaluator.evaluate(mCondition.get());
+            if (!condition) return std::nullopt;
+            if (!condition->integer) break;
+
+            if (!evaluator.evaluate(mBody.get())) return std::nullopt;
+            if (evaluator.leaveLoop()) break;
+        }
+        return ConstantValue{};
+    }
+
+    void WhileStatement::forEachChild(const std::function<void(ASTNode*)>& callback)
+    {
+        callback(mCondition.get());
+        callback(mBody.get());
+    }
+}
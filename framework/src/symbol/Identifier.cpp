@@ -3,51 +3,63 @@
 
 #include "symbol/Identifier.h"
 
-#include <algorithm>
-#include <unordered_map>
+#include "context/CompilerContext.h"
+
+#include <string_view>
 
 namespace symbol
 {
-    struct Identifier
+    static void AppendQualifiedName(std::string& key, bool& first, const std::string& name)
     {
-        std::string mangledName;
-
-        std::vector<std::string> names;
-    };
-
-    std::vector<Identifier> identifiers;
+        if (!first)
+            key += "::";
+        key += name;
+        first = false;
+    }
 
-    void AddIdentifier(std::string mangledName, std::vector<std::string> names)
+    void AddIdentifier(CompilerContext& context, std::string mangledName, std::vector<std::string> names)
     {
-        if (std::find_if(identifiers.begin(), identifiers.end(), [&mangledName](const auto& ident){
-                return ident.mangledName == mangledName;
-            }) == identifiers.end())
+        if (!context.mangledNames.insert(mangledName).second)
+        {
+            return;
+        }
+
+        std::string key;
+        bool first = true;
+        for (auto& name : names)
         {
-            identifiers.push_back({std::move(mangledName), std::move(names)});
+            AppendQualifiedName(key, first, name);
         }
+        context.identifiers[std::move(key)].push_back(std::move(mangledName));
     }
 
-    std::vector<std::string> GetSymbol(std::vector<std::string> givenNames, std::vector<std::string> activeNames)
+    std::vector<std::string> GetSymbol(CompilerContext& context, const std::vector<std::string>& givenNames, const std::vector<std::string>& activeNames)
     {
         std::vector<std::string> ret;
 
-        while(true)
+        // Try the name as given, then qualified by each enclosing namespace
+        // from the innermost outwards
+        std::string key;
+        for (std::size_t prefix = activeNames.size() + 1; prefix-- > 0;)
         {
-            for (auto& ident : identifiers)
+            key.clear();
+            bool first = true;
+            for (std::size_t i = prefix; i < activeNames.size(); ++i)
             {
-                if (ident.names == givenNames)
-                {
-                    ret.push_back(ident.mangledName);
-                }
+                AppendQualifiedName(key, first, activeNames[i]);
             }
-            if (!activeNames.empty())
+            for (auto& name : givenNames)
+            {
+                AppendQualifiedName(key, first, name);
+            }
+
+            auto it = context.identifiers.find(std::string_view(key));
+            if (it != context.identifiers.end())
             {
-                givenNames.insert(givenNames.begin(), activeNames.back());
-                activeNames.pop_back();
+                ret.insert(ret.end(), it->second.begin(), it->second.end());
             }
-            else break;
         }
 
         return ret;
     }
-}
\ No newline at end of file
+}
@@ -9,12 +9,12 @@
 #include "parser/Parser.h"
 #include "parser/ImportParser.h"
 
-#include <fstream>
-
 namespace symbol
 {
-    ImportManager::ImportManager()
+    ImportManager::ImportManager(lexing::SourceManager& sourceManager, CompilerContext& context)
         : mSearchPaths{"./"}
+        , mSourceManager(sourceManager)
+        , mContext(context)
     {
     }
 
@@ -27,28 +27,27 @@ namespace symbol
     {
         path += ".vpr";
 
-        std::ifstream stream;
+        std::string_view text = "\n";
 
         for (auto searchPath : mSearchPaths)
         {
-            stream.open(searchPath / path);
-            if (stream.is_open()) break;
+            auto source = mSourceManager.load(searchPath / path);
+            if (source)
+            {
+                text = *source;
+                break;
+            }
         }
 
         diagnostic::Diagnostics importerDiag;
 
-        std::stringstream buf;
-        buf << stream.rdbuf();
-
         importerDiag.setErrorSender("viper");
         importerDiag.setFileName(path);
-        importerDiag.setText(buf.str());
+        importerDiag.setText(text);
         importerDiag.setImported(true);
 
-        lexing::Lexer lexer(buf.str(), importerDiag);
-        auto tokens = lexer.lex();
-
-        parser::ImportParser parser(tokens, importerDiag, *this);
+        lexing::Lexer lexer(text, importerDiag);
+        parser::ImportParser parser(lexer, importerDiag, *this, mContext);
         
         auto nodes = parser.parse();
         return {std::move(nodes), parser.getSymbols()};
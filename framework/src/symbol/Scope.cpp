@@ -5,15 +5,18 @@
 #include "symbol/NameMangling.h"
 #include "symbol/Identifier.h"
 
-#include <algorithm>
-
-std::unordered_map<std::string, FunctionSymbol> GlobalFunctions;
-std::unordered_map<std::string, GlobalSymbol>   GlobalVariables;
+#include "context/CompilerContext.h"
 
 LocalSymbol::LocalSymbol(vipir::AllocaInst* alloca, Type* type)
     : alloca{alloca}
     , type(type)
+    , slot(0)
+{
+}
+
+bool LocalSymbol::inRegister() const
 {
+    return !needsSlot && (type->isIntegerType() || type->isBooleanType() || type->isPointerType());
 }
 
 FunctionSymbol::FunctionSymbol(vipir::Function* function, Type* type, bool priv, bool mangle)
@@ -24,12 +27,14 @@ FunctionSymbol::FunctionSymbol(vipir::Function* function, Type* type, bool priv,
 {
 }
 
-void FunctionSymbol::Create(vipir::Function* function, std::string mangledName, std::vector<std::string> names, Type* type, bool priv, bool mangle)
+FunctionSymbol* FunctionSymbol::Create(CompilerContext& context, vipir::Function* function, std::string mangledName, std::vector<std::string> names, Type* type, bool priv, bool mangle)
 {
-    symbol::AddIdentifier(mangledName, names);
+    symbol::AddIdentifier(context, mangledName, names);
 
-    GlobalFunctions[mangledName] = FunctionSymbol(function, type, priv, mangle);
-    GlobalFunctions[mangledName].names = std::move(names);
+    FunctionSymbol& symbol = context.functions[mangledName];
+    symbol = FunctionSymbol(function, type, priv, mangle);
+    symbol.names = std::move(names);
+    return &symbol;
 }
 
 GlobalSymbol::GlobalSymbol(vipir::Value* global, Type* type)
@@ -38,108 +43,129 @@ GlobalSymbol::GlobalSymbol(vipir::Value* global, Type* type)
 {
 }
 
-FunctionSymbol* FindFunction(std::vector<std::string> givenNames, std::vector<std::string> activeNames, std::vector<Type*> arguments)
+FunctionSymbol* FindFunction(CompilerContext& context, std::vector<std::string> givenNames, std::vector<std::string> activeNames, std::vector<Type*> arguments)
 {
-    std::vector<std::string> mangledNames = symbol::GetSymbol(givenNames, activeNames);
+    std::vector<std::string> mangledNames = symbol::GetSymbol(context, givenNames, activeNames);
 
     for (auto name : mangledNames)
     {
-        if (GlobalFunctions.find(name) != GlobalFunctions.end())
+        if (context.functions.find(name) != context.functions.end())
         {
-            return &GlobalFunctions.at(name);
+            return &context.functions.at(name);
         }
     }
 
     return nullptr;
 }
 
-Scope::Scope(Scope* parent, StructType* owner)
+static const std::vector<std::string> NoNamespaces;
+
+static const std::vector<std::string>* InternNamespaces(CompilerContext& context, std::vector<std::string> names)
+{
+    return &*context.namespacePaths.insert(std::move(names)).first;
+}
+
+Scope::Scope(Scope* parent, StructType* owner, Kind kind)
     : parent(parent)
     , owner(owner)
+    , currentReturnType(nullptr)
     , breakTo(nullptr)
     , continueTo(nullptr)
+    , emitting(false)
+    , returnTo(nullptr)
+    , returnSlot(nullptr)
+    , allocaBlock(nullptr)
+    , function(nullptr)
+    , breakScope(nullptr)
+    , continueScope(nullptr)
 {
-}
-
-LocalSymbol* Scope::findVariable(const std::string& name)
-{
-    Scope* scope = this;
-    while (scope)
+    if (parent)
     {
-        if (scope->locals.find(name) != scope->locals.end())
-        {
-            return &scope->locals.at(name);
-        }
+        if (!owner) this->owner = parent->owner;
+        function = parent->function;
+        breakScope = parent->breakScope;
+        continueScope = parent->continueScope;
+        namespaces = parent->namespaces;
+    }
+    else
+    {
+        namespaces = &NoNamespaces;
+    }
 
-        scope = scope->parent;
+    switch (kind)
+    {
+        case Kind::Block:
+            break;
+        case Kind::Function:
+            function = this;
+            breakScope = nullptr;
+            continueScope = nullptr;
+            break;
+        case Kind::Loop:
+            breakScope = this;
+            continueScope = this;
+            break;
+        case Kind::Switch:
+            breakScope = this;
+            break;
     }
+}
 
-    return nullptr;
+Scope::Scope(CompilerContext& context, Scope* parent, std::string_view namespaceName)
+    : Scope(parent, nullptr)
+{
+    std::vector<std::string> names = *namespaces;
+    names.emplace_back(namespaceName);
+    namespaces = InternNamespaces(context, std::move(names));
 }
 
-vipir::BasicBlock* Scope::findBreakBB()
+LocalSymbol* Scope::addLocal(Type* type)
 {
-    Scope* scope = this;
-    while (scope)
-    {
-        if (scope->breakTo)
-        {
-            return scope->breakTo;
-        }
+    LocalSymbol& local = function->frame.emplace_back(nullptr, type);
+    local.slot = function->frame.size() - 1;
+    return &local;
+}
 
-        scope = scope->parent;
-    }
+vipir::AllocaInst* Scope::createAlloca(vipir::IRBuilder& builder, vipir::Type* type)
+{
+    vipir::BasicBlock* insertPoint = builder.getInsertPoint();
+    builder.setInsertPoint(function->allocaBlock);
+    vipir::AllocaInst* alloca = builder.CreateAlloca(type);
+    builder.setInsertPoint(insertPoint);
+    return alloca;
+}
 
-    return nullptr;
+vipir::BasicBlock* Scope::findBreakBB()
+{
+    return breakScope ? breakScope->breakTo : nullptr;
 }
 
 vipir::BasicBlock* Scope::findContinueBB()
 {
-    Scope* scope = this;
-    while (scope)
-    {
-        if (scope->continueTo)
-        {
-            return scope->continueTo;
-        }
-
-        scope = scope->parent;
-    }
+    return continueScope ? continueScope->continueTo : nullptr;
+}
 
-    return nullptr;
+vipir::BasicBlock* Scope::findReturnBB()
+{
+    return function ? function->returnTo : nullptr;
 }
 
 StructType* Scope::findOwner()
 {
-    Scope* scope = this;
-    while (scope)
-    {
-        if (scope->owner)
-        {
-            return scope->owner;
-        }
-
-        scope = scope->parent;
-    }
-
-    return nullptr;
+    return owner;
 }
 
-std::vector<std::string> Scope::getNamespaces()
+Type* Scope::findReturnType()
 {
-    std::vector<std::string> ret;
-
-    Scope* scope = this;
-    while (scope)
-    {
-        if (!scope->namespaceName.empty())
-        {
-            ret.push_back(scope->namespaceName);
-        }
+    return function ? function->currentReturnType : nullptr;
+}
 
-        scope = scope->parent;
-    }
+const std::vector<std::string>& Scope::getNamespaces()
+{
+    return *namespaces;
+}
 
-    std::reverse(ret.begin(), ret.end());
-    return ret;
-}
\ No newline at end of file
+const std::vector<std::string>& Scope::GetNamespaces(Scope* scope)
+{
+    return scope ? scope->getNamespaces() : NoNamespaces;
+}
@@ -0,0 +1,48 @@
+// Copyright 2024 solar-mist
+
+
+#include "symbol/SymbolTable.h"
+
+namespace symbol
+{
+    void SymbolTable::enterScope()
+    {
+        mScopeStarts.push_back(mUndoLog.size());
+    }
+
+    void SymbolTable::exitScope()
+    {
+        std::size_t start = mScopeStarts.back();
+        mScopeStarts.pop_back();
+
+        while (mUndoLog.size() > start)
+        {
+            Undo& undo = mUndoLog.back();
+            *undo.binding = undo.previous;
+            mUndoLog.pop_back();
+        }
+    }
+
+    void SymbolTable::declare(std::string_view name, LocalSymbol* local)
+    {
+        auto it = mBindings.find(name);
+        if (it == mBindings.end())
+        {
+            it = mBindings.emplace(name, nullptr).first;
+        }
+
+        // References to elements survive rehashing, so the log can point straight at the binding
+        mUndoLog.push_back({&it->second, it->second});
+        it->second = local;
+    }
+
+    LocalSymbol* SymbolTable::find(std::string_view name) const
+    {
+        auto it = mBindings.find(name);
+        if (it == mBindings.end())
+        {
+            return nullptr;
+        }
+        return it->second;
+    }
+}
@@ -3,14 +3,11 @@
 
 #include "type/ArrayType.h"
 
-#include <vector>
+#include "context/CompilerContext.h"
+
 #include <vipir/Type/ArrayType.h>
 
-#include <algorithm>
 #include <format>
-#include <unordered_map>
-
-extern std::unordered_map<std::string, std::unique_ptr<Type>> types;
 
 ArrayType::ArrayType(Type* base, int count)
     : Type(std::format("{}[{}]", base->getName(), count))
@@ -24,17 +21,27 @@ Type* ArrayType::getBaseType() const
     return mBase;
 }
 
-int ArrayType::getSize() const
+int ArrayType::getCount() const
+{
+    return mCount;
+}
+
+int ArrayType::computeSize() const
 {
     return mBase->getSize() * mCount;
 }
 
-vipir::Type* ArrayType::getVipirType() const
+int ArrayType::computeAlignment() const
+{
+    return mBase->getAlignment();
+}
+
+vipir::Type* ArrayType::computeVipirType() const
 {
     return vipir::Type::GetArrayType(mBase->getVipirType(), mCount);
 }
 
-std::string ArrayType::getMangleID() const
+std::string ArrayType::computeMangleID() const
 {
     return mBase->getMangleID() + std::to_string(mCount);
 }
@@ -44,19 +51,18 @@ bool ArrayType::isArrayType() const
     return true;
 }
 
-ArrayType* ArrayType::Create(Type* base, int count)
+bool ArrayType::hasFinalLayout() const
 {
-    static std::vector<std::unique_ptr<ArrayType> > arrayTypes;
-
-    auto it = std::find_if(arrayTypes.begin(), arrayTypes.end(), [base](const std::unique_ptr<ArrayType>& type){
-        return type->getBaseType() == base;
-    });
+    return mBase->hasFinalLayout();
+}
 
-    if (it != arrayTypes.end())
+ArrayType* ArrayType::Create(CompilerContext& context, Type* base, int count)
+{
+    // Keyed by base type and element count, so i32[4] and i32[8] stay distinct types
+    auto& type = context.arrayTypes[{base, count}];
+    if (!type)
     {
-        return it->get();
+        type = std::make_unique<ArrayType>(base, count);
     }
-
-    arrayTypes.push_back(std::make_unique<ArrayType>(base, count));
-    return arrayTypes.back().get();
+    return type.get();
 }
\ No newline at end of file
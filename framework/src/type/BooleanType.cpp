@@ -8,17 +8,17 @@ BooleanType::BooleanType()
 {
 }
 
-int BooleanType::getSize() const
+int BooleanType::computeSize() const
 {
     return 8;
 }
 
-vipir::Type* BooleanType::getVipirType() const
+vipir::Type* BooleanType::computeVipirType() const
 {
     return vipir::Type::GetBooleanType();
 }
 
-std::string BooleanType::getMangleID() const
+std::string BooleanType::computeMangleID() const
 {
     return "B";
 }
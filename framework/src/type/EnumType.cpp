@@ -3,8 +3,19 @@
 
 #include "type/EnumType.h"
 
-#include <algorithm>
-#include <unordered_map>
+#include "context/CompilerContext.h"
+
+static std::string MangleEnumName(const std::vector<std::string>& names)
+{
+    std::string ret = "_E";
+    for (auto& name : names)
+    {
+        ret += std::to_string(name.length());
+        ret += name;
+    }
+
+    return ret;
+}
 
 EnumType::EnumType(std::vector<std::string> names, bool generatedNames)
     : Type(names.back())
@@ -19,26 +30,19 @@ bool EnumType::hsGeneratedNames() const
 }
 
 
-int EnumType::getSize() const
+int EnumType::computeSize() const
 {
     return 32;
 }
 
-vipir::Type* EnumType::getVipirType() const
+vipir::Type* EnumType::computeVipirType() const
 {
     return vipir::Type::GetIntegerType(32);
 }
 
-std::string EnumType::getMangleID() const
+std::string EnumType::computeMangleID() const
 {
-    std::string ret = "_E";
-    for (auto& name : mNames)
-    {
-        ret += std::to_string(name.length());
-        ret += name;
-    }
-
-    return ret;
+    return MangleEnumName(mNames);
 }
 
 bool EnumType::isEnumType() const
@@ -46,23 +50,12 @@ bool EnumType::isEnumType() const
     return true;
 }
 
-extern std::unordered_map<std::string, std::unique_ptr<Type>> types;
-EnumType* EnumType::Create(std::vector<std::string> names, bool generatedNames)
+EnumType* EnumType::Create(CompilerContext& context, std::vector<std::string> names, bool generatedNames)
 {
-    auto it = std::find_if(types.begin(), types.end(), [&names](const auto& type){
-        if (EnumType* enumType = dynamic_cast<EnumType*>(type.second.get())) {
-            return enumType->mNames == names;
-        }
-        return false;
-    });
-
-    if (it != types.end()) {
-        return static_cast<EnumType*>(it->second.get());
+    auto& type = context.types[MangleEnumName(names)];
+    if (!type)
+    {
+        type = std::make_unique<EnumType>(std::move(names), generatedNames);
     }
-
-    std::unique_ptr<Type> type = std::make_unique<EnumType>(names, generatedNames);
-    std::string mangleID = type->getMangleID();
-    types[mangleID] = std::move(type);
-
-    return static_cast<EnumType*>(types[mangleID].get());
-}
\ No newline at end of file
+    return static_cast<EnumType*>(type.get());
+}
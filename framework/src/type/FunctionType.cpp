@@ -3,6 +3,8 @@
 
 #include "type/FunctionType.h"
 
+#include "context/CompilerContext.h"
+
 #include <vipir/Type/FunctionType.h>
 
 #include <algorithm>
@@ -37,12 +39,12 @@ const std::vector<Type*>& FunctionType::getArgumentTypes() const
     return mArguments;
 }
 
-int FunctionType::getSize() const
+int FunctionType::computeSize() const
 {
     return 0;
 }
 
-vipir::Type* FunctionType::getVipirType() const
+vipir::Type* FunctionType::computeVipirType() const
 {
     std::vector<vipir::Type*> arguments;
     for (auto argument : mArguments)
@@ -52,7 +54,7 @@ vipir::Type* FunctionType::getVipirType() const
     return vipir::FunctionType::Create(mReturnType->getVipirType(), std::move(arguments));
 }
 
-std::string FunctionType::getMangleID() const
+std::string FunctionType::computeMangleID() const
 {
     std::string ret = "F" + mReturnType->getMangleID();
     for (auto argument : mArguments)
@@ -67,18 +69,24 @@ bool FunctionType::isFunctionType() const
     return true;
 }
 
-FunctionType* FunctionType::Create(Type* returnType, std::vector<Type*> arguments)
+bool FunctionType::hasFinalLayout() const
 {
-    static std::vector<std::unique_ptr<FunctionType> > functionTypes;
-    auto it = std::find_if(functionTypes.begin(), functionTypes.end(), [returnType, &arguments](const auto& type){
-        return type->getReturnType() == returnType && type->getArgumentTypes() == arguments;
+    return mReturnType->hasFinalLayout() && std::all_of(mArguments.begin(), mArguments.end(), [](Type* argument) {
+        return argument->hasFinalLayout();
     });
+}
 
-    if (it != functionTypes.end())
+FunctionType* FunctionType::Create(CompilerContext& context, Type* returnType, std::vector<Type*> arguments)
+{
+    std::vector<Type*> signature;
+    signature.reserve(arguments.size() + 1);
+    signature.push_back(returnType);
+    signature.insert(signature.end(), arguments.begin(), arguments.end());
+
+    auto& type = context.functionTypes[std::move(signature)];
+    if (!type)
     {
-        return it->get();
+        type = std::make_unique<FunctionType>(returnType, std::move(arguments));
     }
-
-    functionTypes.push_back(std::make_unique<FunctionType>(returnType, std::move(arguments)));
-    return functionTypes.back().get();
+    return type.get();
 }
\ No newline at end of file
@@ -13,17 +13,17 @@ IntegerType::IntegerType(int bits, bool isSigned)
 {
 }
 
-int IntegerType::getSize() const
+int IntegerType::computeSize() const
 {
     return mBits;
 }
 
-vipir::Type* IntegerType::getVipirType() const
+vipir::Type* IntegerType::computeVipirType() const
 {
     return vipir::Type::GetIntegerType(mBits);
 }
 
-std::string IntegerType::getMangleID() const
+std::string IntegerType::computeMangleID() const
 {
     std::string ret;
     if (!mSigned) ret = "u";
@@ -57,4 +57,18 @@ bool IntegerType::isIntegerType() const
 bool IntegerType::isSigned() const
 {
     return mSigned;
+}
+
+std::intmax_t IntegerType::wrap(std::uintmax_t value) const
+{
+    if (mBits < 64)
+    {
+        std::uintmax_t mask = (std::uintmax_t(1) << mBits) - 1;
+        value &= mask;
+        if (mSigned && (value >> (mBits - 1)) & 1)
+        {
+            value |= ~mask;
+        }
+    }
+    return static_cast<std::intmax_t>(value);
 }
\ No newline at end of file
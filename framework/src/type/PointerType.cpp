@@ -3,14 +3,11 @@
 
 #include "type/PointerType.h"
 
-#include <vector>
+#include "context/CompilerContext.h"
+
 #include <vipir/Type/PointerType.h>
 
-#include <algorithm>
 #include <format>
-#include <unordered_map>
-
-extern std::unordered_map<std::string, std::unique_ptr<Type>> types;
 
 PointerType::PointerType(Type* base)
     : Type(std::format("{}*", base->getName()))
@@ -23,17 +20,17 @@ Type* PointerType::getBaseType() const
     return mBase;
 }
 
-int PointerType::getSize() const
+int PointerType::computeSize() const
 {
     return 64;
 }
 
-vipir::Type* PointerType::getVipirType() const
+vipir::Type* PointerType::computeVipirType() const
 {
     return vipir::Type::GetPointerType(mBase->getVipirType());
 }
 
-std::string PointerType::getMangleID() const
+std::string PointerType::computeMangleID() const
 {
     return mBase->getMangleID() + "P";
 }
@@ -43,19 +40,17 @@ bool PointerType::isPointerType() const
     return true;
 }
 
-PointerType* PointerType::Create(Type* base)
+bool PointerType::hasFinalLayout() const
 {
-    static std::vector<std::unique_ptr<PointerType> > pointerTypes;
-
-    auto it = std::find_if(pointerTypes.begin(), pointerTypes.end(), [base](const std::unique_ptr<PointerType>& type){
-        return type->getBaseType() == base;
-    });
+    return mBase->hasFinalLayout();
+}
 
-    if (it != pointerTypes.end())
+PointerType* PointerType::Create(CompilerContext& context, Type* base)
+{
+    auto& type = context.pointerTypes[base];
+    if (!type)
     {
-        return it->get();
+        type = std::make_unique<PointerType>(base);
     }
-
-    pointerTypes.push_back(std::make_unique<PointerType>(base));
-    return pointerTypes.back().get();
+    return type.get();
 }
\ No newline at end of file
@@ -4,21 +4,37 @@
 #include "type/StructType.h"
 #include "type/PointerType.h"
 
+#include "context/CompilerContext.h"
+
 #include "symbol/Identifier.h"
 
 #include <vipir/Type/StructType.h>
+#include <vipir/Type/ArrayType.h>
 #include <vipir/Type/PointerType.h>
 
 #include <algorithm>
-#include <map>
+#include <numeric>
 #include <vector>
 
+static std::string MangleStructName(const std::vector<std::string>& names)
+{
+    std::string ret = "S";
+    for (auto& name : names)
+    {
+        ret += std::to_string(name.length()) + name;
+    }
+    return ret;
+}
+
 StructType::StructType(std::vector<std::string> names, std::vector<Field> fields)
     : Type(names.back())
     , mNames(std::move(names))
     , mFields(std::move(fields))
+    , mExplicitAlignment(0)
+    , mReordered(false)
+    , mComplete(false)
+    , mCheckingLayout(false)
 {
-    symbol::AddIdentifier(getMangleID(), mNames);
 }
 
 std::string_view StructType::getName() const
@@ -31,11 +47,26 @@ std::vector<std::string> StructType::getNames() const
     return mNames;
 }
 
-std::vector<StructType::Field>& StructType::getFields()
+const std::vector<StructType::Field>& StructType::getFields() const
 {
     return mFields;
 }
 
+void StructType::addField(Field field)
+{
+    mFields.push_back(std::move(field));
+}
+
+void StructType::complete()
+{
+    mComplete = true;
+}
+
+bool StructType::isComplete() const
+{
+    return mComplete;
+}
+
 bool StructType::hasField(std::string_view fieldName)
 {
     return std::find_if(mFields.begin(), mFields.end(), [&fieldName](const Field& field){
@@ -53,27 +84,103 @@ StructType::Field* StructType::getField(std::string_view fieldName)
     return &*it;
 }
 
-int StructType::getFieldOffset(std::string fieldName)
+int StructType::getFieldIndex(std::string_view fieldName) const
 {
     return std::find_if(mFields.begin(), mFields.end(), [&fieldName](const Field& field){
         return fieldName == field.name;
     }) - mFields.begin();
 }
 
-int StructType::getSize() const
+const StructType::Layout& StructType::getLayout() const
+{
+    getSize(); // recomputes mLayout unless the size is cached
+    return mLayout;
+}
+
+int StructType::getFieldOffset(int index) const
+{
+    return getLayout().offsets[index];
+}
+
+int StructType::getFieldElement(int index) const
 {
-    int size = 0;
-    for (auto& field : mFields)
-        size += field.type->getSize();
-    
-    return size;
+    return getLayout().elementIndices[index];
 }
 
-vipir::Type* StructType::getVipirType() const
+void StructType::setAlignment(int alignment)
+{
+    mExplicitAlignment = alignment;
+}
+
+void StructType::setReordered(bool reordered)
+{
+    mReordered = reordered;
+}
+
+int StructType::computeSize() const
+{
+    std::vector<int> order(mFields.size());
+    std::iota(order.begin(), order.end(), 0);
+    if (mReordered)
+    {
+        // Stable, so fields that need the same alignment keep their declared order
+        std::stable_sort(order.begin(), order.end(), [this](int lhs, int rhs) {
+            return mFields[lhs].type->getAlignment() > mFields[rhs].type->getAlignment();
+        });
+    }
+
+    Layout layout;
+    layout.offsets.resize(mFields.size());
+    layout.elementIndices.resize(mFields.size());
+    layout.alignment = std::max(mExplicitAlignment, 8);
+
+    int offset = 0;
+    auto alignTo = [&layout, &offset](int alignment) {
+        int aligned = (offset + alignment - 1) / alignment * alignment;
+        if (aligned != offset)
+        {
+            layout.elements.push_back({-1, (aligned - offset) / 8});
+            offset = aligned;
+        }
+    };
+
+    for (int index : order)
+    {
+        Type* type = mFields[index].type;
+        int alignment = type->getAlignment();
+        alignTo(alignment);
+
+        layout.offsets[index] = offset;
+        layout.elementIndices[index] = layout.elements.size();
+        layout.elements.push_back({index, 0});
+
+        offset += type->getSize();
+        layout.alignment = std::max(layout.alignment, alignment);
+    }
+    alignTo(layout.alignment);
+
+    layout.size = offset;
+    mLayout = std::move(layout);
+    return mLayout.size;
+}
+
+int StructType::computeAlignment() const
+{
+    return getLayout().alignment;
+}
+
+vipir::Type* StructType::computeVipirType() const
 {
     std::vector<vipir::Type*> fieldTypes;
-    for (auto [_, _x, field] : mFields)
+    for (auto [index, padding] : getLayout().elements)
     {
+        if (index == -1)
+        {
+            fieldTypes.push_back(vipir::Type::GetArrayType(vipir::Type::GetIntegerType(8), padding));
+            continue;
+        }
+
+        Type* field = mFields[index].type;
         if (field->isPointerType())
         {
             // struct types with a pointer to themselves cannot be emitted normally
@@ -88,14 +195,9 @@ vipir::Type* StructType::getVipirType() const
     return vipir::Type::GetStructType(std::move(fieldTypes));
 }
 
-std::string StructType::getMangleID() const
+std::string StructType::computeMangleID() const
 {
-    std::string ret = "S";
-    for (auto name : mNames)
-    {
-        ret += std::to_string(name.length()) + name;
-    }
-    return ret;
+    return MangleStructName(mNames);
 }
 
 bool StructType::isStructType() const
@@ -103,38 +205,43 @@ bool StructType::isStructType() const
     return true;
 }
 
+bool StructType::hasFinalLayout() const
+{
+    if (!mComplete) return false;
 
-static std::vector<std::unique_ptr<StructType> > structTypes;
+    // A struct reached again through a pointer in its own fields is settled
+    // by whatever else those fields lead to
+    if (mCheckingLayout) return true;
 
-StructType* StructType::Get(std::string name)
-{
-    auto it = std::find_if(structTypes.begin(), structTypes.end(), [&name](const auto& type){
-        return type->getMangleID() == name;
+    mCheckingLayout = true;
+    bool final = std::all_of(mFields.begin(), mFields.end(), [](const Field& field) {
+        return field.type->hasFinalLayout();
     });
-    if (it == structTypes.end()) return nullptr;
-    return it->get();
+    mCheckingLayout = false;
+    return final;
 }
 
-StructType* StructType::Create(std::vector<std::string> names, std::vector<StructType::Field> fields)
+StructType* StructType::Get(CompilerContext& context, std::string_view mangleID)
 {
-    auto it = std::find_if(structTypes.begin(), structTypes.end(), [&names](const auto& type){
-        return type->mNames == names;
-    });
+    auto it = context.structTypes.find(mangleID);
+    if (it == context.structTypes.end()) return nullptr;
+    return it->second.get();
+}
 
-    if (it != structTypes.end())
+StructType* StructType::Create(CompilerContext& context, std::vector<std::string> names, std::vector<StructType::Field> fields)
+{
+    std::string mangleID = MangleStructName(names);
+    auto& type = context.structTypes[mangleID];
+    if (!type)
     {
-        return it->get();
+        symbol::AddIdentifier(context, std::move(mangleID), names);
+        type = std::make_unique<StructType>(std::move(names), std::move(fields));
     }
-
-    structTypes.push_back(std::make_unique<StructType>(names, std::move(fields)));
-    return structTypes.back().get();
+    return type.get();
 }
 
-void StructType::Erase(Type* type)
+void StructType::Erase(CompilerContext& context, Type* type)
 {
-    auto structType = static_cast<StructType*>(type);
-    
-    structTypes.erase(std::remove_if(structTypes.begin(), structTypes.end(), [structType](const auto& type){
-        return type.get() == structType;
-    }), structTypes.end());
-}
\ No newline at end of file
+    std::string mangleID = type->getMangleID(); // the key can't refer into the node being erased
+    context.structTypes.erase(mangleID);
+}
@@ -2,42 +2,71 @@
 
 
 #include "type/Type.h"
-#include "type/IntegerType.h"
-#include "type/VoidType.h"
-#include "type/BooleanType.h"
+
+#include "context/CompilerContext.h"
 
 #include "symbol/Identifier.h"
 
-#include <unordered_map>
+#include <algorithm>
+#include <bit>
+
+int Type::getSize() const
+{
+    if (mSize < 0)
+    {
+        int size = computeSize();
+        if (!hasFinalLayout()) return size;
+        mSize = size;
+    }
+    return mSize;
+}
+
+int Type::getAlignment() const
+{
+    if (mAlignment < 0)
+    {
+        int alignment = computeAlignment();
+        if (!hasFinalLayout()) return alignment;
+        mAlignment = alignment;
+    }
+    return mAlignment;
+}
 
-std::unordered_map<std::string, std::unique_ptr<Type>> types;
-std::unordered_map<std::string, Type*> aliases;
+vipir::Type* Type::getVipirType() const
+{
+    if (!mVipirType)
+    {
+        vipir::Type* vipirType = computeVipirType();
+        if (!hasFinalLayout()) return vipirType;
+        mVipirType = vipirType;
+    }
+    return mVipirType;
+}
 
-void Type::Init()
+const std::string& Type::getMangleID() const
 {
-    types["i8"]  = std::make_unique<IntegerType>(8, true);
-    types["i16"] = std::make_unique<IntegerType>(16, true);
-    types["i32"] = std::make_unique<IntegerType>(32, true);
-    types["i64"] = std::make_unique<IntegerType>(64, true);
-    types["u8"]  = std::make_unique<IntegerType>(8, false);
-    types["u16"] = std::make_unique<IntegerType>(16, false);
-    types["u32"] = std::make_unique<IntegerType>(32, false);
-    types["u64"] = std::make_unique<IntegerType>(64, false);
+    if (mMangleID.empty())
+    {
+        mMangleID = computeMangleID();
+    }
+    return mMangleID;
+}
 
-    types["void"] = std::make_unique<VoidType>();
-    types["bool"] = std::make_unique<BooleanType>();
+int Type::computeAlignment() const
+{
+    return std::max(getSize(), 8);
 }
 
-bool Type::Exists(const std::string& name)
+bool Type::Exists(CompilerContext& context, std::string_view name)
 {
-    auto type = types.find(name);
-    if (type != types.end()) return true;
+    auto type = context.types.find(name);
+    if (type != context.types.end()) return true;
 
-    auto alias = aliases.find(name);
-    return alias != aliases.end();
+    auto alias = context.aliases.find(name);
+    return alias != context.aliases.end();
 }
 
-void Type::AddAlias(std::vector<std::string> names, Type* type)
+void Type::AddAlias(CompilerContext& context, std::vector<std::string> names, Type* type)
 {
     std::string mangledName = "_U";
     for (auto name : names)
@@ -46,18 +75,33 @@ void Type::AddAlias(std::vector<std::string> names, Type* type)
         mangledName += name;
     }
     mangledName += type->getMangleID();
-    symbol::AddIdentifier(mangledName, names);
+    symbol::AddIdentifier(context, mangledName, names);
 
-    aliases[mangledName] = type;
+    context.aliases[mangledName] = type;
 }
 
-Type* Type::Get(const std::string& name)
+Type* Type::Get(CompilerContext& context, std::string_view name)
 {
-    auto type = types.find(name);
-    if (type != types.end()) return type->second.get();
+    auto type = context.types.find(name);
+    if (type != context.types.end()) return type->second.get();
 
-    auto alias =  aliases.find(name);
-    if (alias != aliases.end()) return alias->second;
+    auto alias =  context.aliases.find(name);
+    if (alias != context.aliases.end()) return alias->second;
 
     return nullptr;
+}
+
+Type* Type::GetIntegerType(CompilerContext& context, int bits, bool isSigned)
+{
+    return context.integerTypes[isSigned][std::countr_zero(static_cast<unsigned int>(bits)) - 3];
+}
+
+Type* Type::GetVoidType(CompilerContext& context)
+{
+    return context.voidType;
+}
+
+Type* Type::GetBooleanType(CompilerContext& context)
+{
+    return context.booleanType;
 }
\ No newline at end of file
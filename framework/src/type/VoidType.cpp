@@ -8,17 +8,17 @@ VoidType::VoidType()
 {
 }
 
-int VoidType::getSize() const
+int VoidType::computeSize() const
 {
     return 0;
 }
 
-vipir::Type* VoidType::getVipirType() const
+vipir::Type* VoidType::computeVipirType() const
 {
     return vipir::Type::GetVoidType();
 }
 
-std::string VoidType::getMangleID() const
+std::string VoidType::computeMangleID() const
 {
     return "V";
 }
@@ -0,0 +1,46 @@
+# Usage: cmake -DVIPER=<compiler> -DSOURCE=<file> -DWORK_DIR=<dir> -P CallGraph.cmake
+# Compiles SOURCE with --dump-call-graph, on its own and as the
+# whole program, and checks which functions are roots and which are dropped
+
+file(MAKE_DIRECTORY ${WORK_DIR})
+
+function(check_call_graph)
+    cmake_parse_arguments(PARSE_ARGV 0 ARG "" "" "FLAGS;LINES")
+
+    execute_process(COMMAND ${VIPER} --dump-call-graph ${ARG_FLAGS} -i ${SOURCE} -o ${WORK_DIR}/roots.i
+        RESULT_VARIABLE result OUTPUT_VARIABLE output)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "compiling ${SOURCE} failed: ${result}")
+    endif()
+
+    # Every expected line must appear as a whole line of the dump
+    foreach(line IN LISTS ARG_LINES)
+        string(FIND "\n${output}" "\n${line}\n" found)
+        if(found EQUAL -1)
+            message(FATAL_ERROR "call graph with '${ARG_FLAGS}' has no line '${line}':\n${output}")
+        endif()
+    endforeach()
+endfunction()
+
+check_call_graph(LINES
+    "dead (unreachable)"
+    "onlyCalledByDead (unreachable)"
+    "deadCaller (unreachable) -> onlyCalledByDead"
+    "helper"
+    "exported (root) -> helper"
+    "unmangled (root)"
+    "initial (root)"
+    "used"
+    "main (root) -> used"
+)
+
+# Nothing outside the program can call an exported function, so it's only
+# kept if something inside it does
+check_call_graph(FLAGS --whole-program LINES
+    "dead (unreachable)"
+    "helper (unreachable)"
+    "exported (unreachable) -> helper"
+    "unmangled (root)"
+    "initial (root)"
+    "main (root) -> used"
+)
@@ -0,0 +1,34 @@
+# Usage: cmake -DVIPER=<compiler> -DSOURCE_DIR=<dir> -DWORK_DIR=<dir> -P Jobs.cmake
+# Compiles every input in SOURCE_DIR as its own job with -j 2. invalid.vpr is
+# first, so it fails while the other jobs are still to start. They must all
+# still be compiled, and invalid.vpr must be left with no output, even a stale one
+
+set(inputs invalid first second third)
+
+file(REMOVE_RECURSE ${WORK_DIR})
+file(MAKE_DIRECTORY ${WORK_DIR})
+set(paths "")
+foreach(input IN LISTS inputs)
+    file(COPY ${SOURCE_DIR}/${input}.vpr DESTINATION ${WORK_DIR})
+    list(APPEND paths ${WORK_DIR}/${input}.vpr)
+endforeach()
+file(WRITE ${WORK_DIR}/invalid.vpr.i "left over from an earlier build")
+
+execute_process(COMMAND ${VIPER} -j 2 -i ${paths} RESULT_VARIABLE result ERROR_VARIABLE errors)
+if(result EQUAL 0)
+    message(FATAL_ERROR "compiling with invalid.vpr among the inputs succeeded")
+endif()
+if(NOT errors MATCHES "invalid.vpr")
+    message(FATAL_ERROR "no error reported for invalid.vpr:\n${errors}")
+endif()
+
+foreach(input IN LISTS inputs)
+    set(output ${WORK_DIR}/${input}.vpr.i)
+    if(input STREQUAL "invalid")
+        if(EXISTS ${output})
+            message(FATAL_ERROR "the failed job left ${output} behind")
+        endif()
+    elseif(NOT EXISTS ${output})
+        message(FATAL_ERROR "${input}.vpr wasn't compiled after invalid.vpr failed")
+    endif()
+endforeach()
@@ -0,0 +1,22 @@
+# Usage: cmake -DVIPER=<compiler> -DCC=<linker driver> -DSOURCE=<file> -DWORK_DIR=<dir> -P RunProgram.cmake
+# Compiles SOURCE, links it and runs it. The program reports a failed check with a non-zero exit code
+
+file(MAKE_DIRECTORY ${WORK_DIR})
+get_filename_component(name ${SOURCE} NAME_WE)
+set(object ${WORK_DIR}/${name}.o)
+set(program ${WORK_DIR}/${name})
+
+execute_process(COMMAND ${VIPER} ${SOURCE} -o ${object} RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "compiling ${SOURCE} failed: ${result}")
+endif()
+
+execute_process(COMMAND ${CC} ${object} -o ${program} RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "linking ${object} failed: ${result}")
+endif()
+
+execute_process(COMMAND ${program} RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "${name} exited with ${result}")
+endif()
@@ -0,0 +1,50 @@
+# Usage: cmake -DVIPER=<compiler> -DWORK_DIR=<dir> -P Scaling.cmake
+
+file(MAKE_DIRECTORY ${WORK_DIR})
+
+# Functions are spread over 100 namespaces, and each one reads a local and
+# calls a function declared earlier by its qualified name, so declaring and
+# resolving names are both exercised
+function(generate count path)
+    set(text "")
+    math(EXPR last "${count} - 1")
+    foreach(i RANGE ${last})
+        math(EXPR ns "${i} % 100")
+        if(i LESS 100)
+            string(APPEND text "namespace n${ns} { func @f${i}(x: i32) -> i32 { let y: i32 = x; return y; } }\n")
+        else()
+            math(EXPR prev "${i} - 100")
+            math(EXPR prevNs "${prev} % 100")
+            string(APPEND text "namespace n${ns} { func @f${i}(x: i32) -> i32 { let y: i32 = x; return n${prevNs}::f${prev}(y); } }\n")
+        endif()
+    endforeach()
+    string(APPEND text "func @main() -> i32 = n0::f0(0);\n")
+    file(WRITE ${path} "${text}")
+endfunction()
+
+function(time_compile count outVar)
+    set(input ${WORK_DIR}/scaling${count}.vpr)
+    if(NOT EXISTS ${input})
+        generate(${count} ${input})
+    endif()
+
+    string(TIMESTAMP start "%s%f" UTC)
+    execute_process(COMMAND ${VIPER} -i ${input} -o ${input}.i RESULT_VARIABLE result)
+    string(TIMESTAMP end "%s%f" UTC)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "compiling ${count} functions failed: ${result}")
+    endif()
+
+    math(EXPR elapsed "${end} - ${start}")
+    message(STATUS "${count} functions: ${elapsed}us")
+    set(${outVar} ${elapsed} PARENT_SCOPE)
+endfunction()
+
+time_compile(25000 small)
+time_compile(100000 large)
+
+# 4x the input should take about 4x as long; quadratic lookups would take 16x
+math(EXPR limit "${small} * 8")
+if(large GREATER limit)
+    message(FATAL_ERROR "100000 functions took ${large}us, more than 8x the ${small}us for 25000")
+endif()
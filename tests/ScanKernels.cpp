@@ -0,0 +1,130 @@
+// Checks every vectorized lexer scanner this CPU can run against the plain
+// loops. Runs of each class are cut off by every interesting byte at every
+// offset, so the stop lands in the first vector, across the 16 and 32 byte
+// boundaries and in the scalar tail, and runs that reach the end are covered too
+
+#include "lexer/Scan.h"
+
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using lexing::ScanKernels;
+
+namespace
+{
+    struct SkipCase
+    {
+        const char* name;
+        lexing::SkipFn ScanKernels::* scan;
+        std::string_view members; // cycled through to build a run
+    };
+
+    // Bytes just outside each class's ranges, plus bytes with the top bit set,
+    // which the signed vector compares must not mistake for members
+    constexpr std::string_view Stops = "\x08\x0e\x1f!/:@G[^`g{\x7f\x80\xa0\xff";
+
+    constexpr int MaxLength = 80;
+
+    std::string Escape(std::string_view text)
+    {
+        std::string result;
+        for (unsigned char c : text)
+        {
+            if (c >= 0x20 && c < 0x7f && c != '\\')
+            {
+                result += static_cast<char>(c);
+                continue;
+            }
+            char escaped[5];
+            std::snprintf(escaped, sizeof escaped, "\\x%02x", c);
+            result += escaped;
+        }
+        return result;
+    }
+
+    bool Report(const ScanKernels& kernels, const char* name, std::string_view text, std::size_t position, std::size_t expected, std::size_t actual)
+    {
+        if (expected == actual) return true;
+
+        std::fprintf(stderr, "%s %s at %zu of \"%s\": expected %zu, got %zu\n",
+            kernels.name, name, position, Escape(text).c_str(), expected, actual);
+        return false;
+    }
+
+    // text is copied to a few offsets in a buffer so the loads are checked
+    // at more than one alignment, with nothing readable past the end of the view
+    bool CheckText(const std::vector<ScanKernels>& kernels, const std::vector<SkipCase>& cases, std::string_view text)
+    {
+        bool passed = true;
+        std::string buffer;
+        for (std::size_t alignment : { 0, 1, 17 })
+        {
+            buffer.assign(alignment, '\0');
+            buffer += text;
+            std::string_view view = std::string_view(buffer).substr(alignment);
+
+            for (std::size_t position = 0; position <= view.size(); position++)
+            {
+                for (auto& skip : cases)
+                {
+                    std::size_t expected = (kernels.front().*skip.scan)(view, position);
+                    for (std::size_t i = 1; i < kernels.size(); i++)
+                    {
+                        passed &= Report(kernels[i], skip.name, view, position, expected, (kernels[i].*skip.scan)(view, position));
+                    }
+                }
+
+                for (char needle : { '"', '\n', '\x80' })
+                {
+                    std::size_t expected = kernels.front().findByte(view, position, needle);
+                    for (std::size_t i = 1; i < kernels.size(); i++)
+                    {
+                        passed &= Report(kernels[i], "FindByte", view, position, expected, kernels[i].findByte(view, position, needle));
+                    }
+                }
+            }
+        }
+        return passed;
+    }
+}
+
+int main()
+{
+    std::vector<ScanKernels> kernels = lexing::GetAvailableKernels();
+    for (auto& kernel : kernels)
+    {
+        std::printf("checking %s\n", kernel.name);
+    }
+
+    std::vector<SkipCase> cases = {
+        { "SkipWhitespace", &ScanKernels::skipWhitespace, " \t\n\v\f\r" },
+        { "SkipIdentifier", &ScanKernels::skipIdentifier, "azAZ_09mN" },
+        { "SkipDigits",     &ScanKernels::skipDigits,     "0123456789" },
+        { "SkipHexDigits",  &ScanKernels::skipHexDigits,  "09afAF3cD" },
+    };
+
+    bool passed = true;
+    for (auto& skip : cases)
+    {
+        for (int length = 0; length <= MaxLength; length++)
+        {
+            std::string run;
+            for (int i = 0; i < length; i++)
+            {
+                run += skip.members[i % skip.members.size()];
+            }
+
+            passed &= CheckText(kernels, cases, run);
+            for (char stop : Stops)
+            {
+                passed &= CheckText(kernels, cases, run + stop + run);
+            }
+        }
+    }
+
+    if (!passed) return 1;
+    std::printf("all scanners agree\n");
+    return 0;
+}